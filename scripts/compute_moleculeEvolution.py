@@ -9,6 +9,7 @@
 #
 # notes:
 # - dimensions: distances -> Angstroem
+# - topologies that are not found in the working directory are read from the archive (--archive, see simulation.archive)
 
 
 
@@ -17,27 +18,29 @@ import pandas as pd
 import argparse
 import os
 
+import rsmd_archive
+
 
 
 def make_read_topology(*, FILETYPE):
     if FILETYPE == 'gmx' or FILETYPE == 'GMX' or FILETYPE == 'gromacs':
         
-        def read_topology_gmx(cycle, file):
+        def read_topology_gmx(cycle, file, archive=None):
             df = pd.DataFrame(columns=['cycle'], index=[0])
-            with open(file, 'r') as FILE:
-                lines = [line.rstrip() for line in FILE]
-                directiveMolecules = False
-                for line in lines:
-                    if 'molecules' in line:
-                        directiveMolecules = True
-                        continue
-                    if ';' in line[:3] or '#' in line[:3]:
-                        continue
-                    if line == '':
-                        continue
-                    if directiveMolecules:
-                        content = line.split()
-                        df[content[0]] = int( content[1] )
+            content = rsmd_archive.read_text(os.path.dirname(file), os.path.basename(file), archive)
+            lines = [line.rstrip() for line in content.splitlines()]
+            directiveMolecules = False
+            for line in lines:
+                if 'molecules' in line:
+                    directiveMolecules = True
+                    continue
+                if ';' in line[:3] or '#' in line[:3]:
+                    continue
+                if line == '':
+                    continue
+                if directiveMolecules:
+                    content = line.split()
+                    df[content[0]] = int( content[1] )
             return df
 
         return read_topology_gmx
@@ -61,19 +64,21 @@ def make_get_filename(*, FILETYPE, PATH):
 
 
 
-def read_moleculeEvolution(*, path, nCycles, fileType='gmx'):
+def read_moleculeEvolution(*, path, nCycles, fileType='gmx', archive=None):
 
     ### read molecule types and numbers for all cycles ###
     moleculeData = pd.DataFrame(columns=['cycle'])
 
     get_filename = make_get_filename(FILETYPE=fileType, PATH=path)
     read_topology = make_read_topology(FILETYPE=fileType)
+    if archive is not None:
+        archive = rsmd_archive.Archive(archive)
 
     for cycle in np.arange(nCycles):
         filename = get_filename(cycle)
-        if not os.path.isfile( filename ):
+        if not os.path.isfile( filename ) and ( archive is None or os.path.basename(filename) not in archive ):
             continue
-        tmp = read_topology(cycle, filename)
+        tmp = read_topology(cycle, filename, archive)
         tmp['cycle'] = cycle
         moleculeData = moleculeData.append(tmp, ignore_index=True, sort=True)
 
@@ -93,6 +98,8 @@ if __name__ == "__main__":
                     help='# of cycles to read')
     parser.add_argument('--fileType', dest='fileType', type=str, required=False, 
                     help='which file type of topology to read (gmx)')
+    parser.add_argument('--archive', dest='archive', type=str, required=False,
+                    help='archive of per-cycle files (simulation.archive)')
     
     
     args = parser.parse_args()
@@ -108,7 +115,7 @@ if __name__ == "__main__":
         PATH = args.PATH
 
 
-    data = read_moleculeEvolution(path=PATH, nCycles=args.nCycles, fileType=fileType)
+    data = read_moleculeEvolution(path=PATH, nCycles=args.nCycles, fileType=fileType, archive=args.archive)
 
     data.to_csv(f'{PATH}/moleculeEvolution.data', sep='\t')
     print(f'saved data to {PATH}/moleculeEvolution.data')
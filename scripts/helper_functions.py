@@ -4,22 +4,23 @@ import MDAnalysis as mda
 import MDAnalysis.lib.distances as mdaDist # #distance_array
 import numpy as np
 
+import rsmd_archive
 
-def make_get_reactive_atoms(*, FILETYPE, PATH):
+
+def make_get_reactive_atoms(*, FILETYPE, PATH, ARCHIVE=None):
     if FILETYPE == 'gmx' or FILETYPE == 'GMX' or FILETYPE == 'gromacs':
+        archive = rsmd_archive.Archive(ARCHIVE) if ARCHIVE is not None else None   ## index files not found in PATH are read from the archive
        
         def get_indices(cycle):
             reactantIndices, productIndices = ([], [])
 
-            with open(PATH + f'/{cycle}.reactants.ndx', 'r') as FILE:
-                content = FILE.read()
-                content = content[content.find(']')+1:]
-                reactantIndices = [int(x)-1 for x in content.split()]   ## subtract -1 to get index instead of ID
+            content = rsmd_archive.read_text(PATH, f'{cycle}.reactants.ndx', archive)
+            content = content[content.find(']')+1:]
+            reactantIndices = [int(x)-1 for x in content.split()]   ## subtract -1 to get index instead of ID
         
-            with open(PATH + f'/{cycle}.products.ndx', 'r') as FILE:
-                content = FILE.read()
-                content = content[content.find(']')+1:]
-                productIndices = [int(x)-1 for x in content.split()]
+            content = rsmd_archive.read_text(PATH, f'{cycle}.products.ndx', archive)
+            content = content[content.find(']')+1:]
+            productIndices = [int(x)-1 for x in content.split()]
             return np.array(reactantIndices), np.array(productIndices)
         
         return get_indices
@@ -0,0 +1,167 @@
+#!/usr/bin/python3
+
+
+# python module / script to read archives of per-cycle files (simulation.archive)
+#
+# uses:
+# - zlib, struct (standard library)
+#
+# notes:
+# - format: see src/control/archive.hpp
+# - command line: rsmd_archive.py <archive> [list | cat <name>]
+
+
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+
+
+MAGIC = 'rsmd-archive'
+INDEX_MAGIC = 'rsmd-archive-index'
+TRAILER_MAGIC = 0x52534d49
+CODEC_RAW, CODEC_ZLIB, CODEC_TOP_DELTA = (0, 1, 2)
+
+
+
+class _XdrBuffer:
+    def __init__(self, data):
+        self.data = data
+        self.position = 0
+
+    def read_int(self):
+        value, = struct.unpack_from('>i', self.data, self.position)
+        self.position += 4
+        return value
+
+    def read_uint(self):
+        value, = struct.unpack_from('>I', self.data, self.position)
+        self.position += 4
+        return value
+
+    def read_int64(self):
+        value, = struct.unpack_from('>q', self.data, self.position)
+        self.position += 8
+        return value
+
+    def read_bytes(self):
+        self.read_int()     # size + 1 (as written by gromacs' xdr strings)
+        n = self.read_uint()
+        value = self.data[self.position:self.position+n]
+        self.position += (n + 3) // 4 * 4
+        return value
+
+    def read_string(self):
+        return self.read_bytes().decode()
+
+
+
+def topology_prefix_length(content):
+    begin = 0
+    while begin < len(content):
+        end = content.find(b'\n', begin)
+        end = len(content) if end < 0 else end + 1
+        line = content[begin:end]
+        if b'[' in line and b'molecules' in line:
+            return end
+        begin = end
+    return 0
+
+
+
+class Archive:
+    def __init__(self, filename):
+        self.filename = filename
+        with open(filename, 'rb') as FILE:
+            self.data = FILE.read()
+        self.index = {}
+
+        header, size = self._block(0)
+        if header is None or header.read_string() != MAGIC:
+            raise RuntimeError(f"'{filename}' is not a rs@md archive")
+        end = 4 + size
+
+        # index via trailer, respectively read all block headers
+        if len(self.data) >= end + 12:
+            offset, magic = struct.unpack_from('>qI', self.data, len(self.data) - 12)
+            if magic == TRAILER_MAGIC and offset >= end:
+                block, _ = self._block(offset, len(self.data) - 12)
+                if block is not None and block.read_string() == INDEX_MAGIC:
+                    for _ in range(block.read_uint()):
+                        name = block.read_string()
+                        self.index[name] = block.read_int64()
+        if not self.index:
+            position = end
+            while True:
+                block, size = self._block(position)
+                if block is None:
+                    break
+                name = block.read_string()
+                if name == INDEX_MAGIC:
+                    break
+                self.index[name] = position
+                position += 4 + size
+
+    def _block(self, position, end=None):
+        end = len(self.data) if end is None else end
+        if position + 4 > end:
+            return None, 0
+        size, = struct.unpack_from('>I', self.data, position)
+        if position + 4 + size > end:
+            return None, 0
+        return _XdrBuffer(self.data[position+4:position+4+size]), size
+
+    def names(self):
+        return list(self.index.keys())
+
+    def __contains__(self, name):
+        return name in self.index
+
+    def read(self, name):
+        block, _ = self._block(self.index[name])
+        block.read_string()
+        codec = block.read_int()
+        size = block.read_uint()
+        payload = block.read_bytes()
+        if codec == CODEC_ZLIB:
+            payload = zlib.decompress(payload)
+        elif codec == CODEC_TOP_DELTA:
+            base = self.read('0.top')
+            payload = base[:topology_prefix_length(base)] + payload
+        if len(payload) != size:
+            raise RuntimeError(f"corrupt archived file '{name}' in '{self.filename}'")
+        return payload
+
+
+
+def read_text(path, name, archive=None):
+    """content of the file path/name, respectively of the archived file name if it does not exist"""
+    filename = os.path.join(path, name)
+    if os.path.isfile(filename) or archive is None:
+        with open(filename, 'r') as FILE:
+            return FILE.read()
+    if isinstance(archive, str):
+        archive = Archive(archive)
+    return archive.read(name).decode()
+
+
+
+
+if __name__ == "__main__":
+
+    parser = argparse.ArgumentParser(description='a python script to read archives of per-cycle files of a rs@md simulation.')
+    parser.add_argument('archive', type=str, help='archive file')
+    parser.add_argument('command', type=str, nargs='?', default='list', choices=['list', 'cat'])
+    parser.add_argument('name', type=str, nargs='?', help='name of the archived file (cat)')
+
+    args = parser.parse_args()
+
+    archive = Archive(args.archive)
+    if args.command == 'list':
+        for name in archive.names():
+            print(name)
+    else:
+        sys.stdout.write(archive.read(args.name).decode())
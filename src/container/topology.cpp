@@ -10,7 +10,10 @@
 */
 
 #include "container/topology.hpp"
+#include "enhance/math_utility.hpp"
 #include <iostream>
+#include <unordered_set>
+#include <array>
 #include <math.h>      
 using namespace std;
 
@@ -19,9 +22,9 @@ using namespace std;
 //
 const std::size_t& Topology::getReactionRecordMolecule(const std::size_t& oldmolid) 
 {
-    auto it = std::find_if(reactedMoleculeRecords.begin(), reactedMoleculeRecords.end(), [&oldmolid](const auto& rec){ return rec.first == oldmolid; });
-    if( it == reactedMoleculeRecords.end() ) rsmdCRITICAL("couldn't find record for reacted molecule in topology: " << oldmolid);
-    return it->second;
+    auto it = reactedMoleculeIndex.find(oldmolid);
+    if( it == reactedMoleculeIndex.end() ) rsmdCRITICAL("couldn't find record for reacted molecule in topology: " << oldmolid);
+    return reactedMoleculeRecords[it->second].second;
 }
 
 //
@@ -46,7 +49,6 @@ std::vector<std::reference_wrapper<Molecule>> Topology::getMolecules(std::string
     return molReferences;
 }
 
-
 int Topology::heaviside(int i )
 {
    if (i>0) 
@@ -124,6 +126,79 @@ std::tuple<std::vector<std::vector<std::reference_wrapper<Molecule>>>, std::vect
 }
 
 
+//
+// flags of all molecules within the given distance of the given atoms:
+// the given atoms are sorted into a cell list (cells >= distance, periodic),
+// then every atom only has to be checked against the atoms in its own and the 26 neighbouring cells
+//
+std::vector<bool> Topology::getNeighbourhood(const std::vector<std::size_t>& atomIDs, REAL radius) const
+{
+    std::vector<bool> selected ( size(), false );
+    if( atomIDs.empty() )   return selected;
+
+    std::array<int, 3> nCells {1, 1, 1};
+    for( std::size_t d=0; d<3; ++d )
+    {
+        if( radius > 0 && dimensions[d] > 0 )   nCells[d] = std::max( 1, static_cast<int>(std::floor(dimensions[d] / radius)) );
+    }
+    auto cellOf = [&](const REALVEC& position, std::size_t d)
+    {
+        if( dimensions[d] <= 0 )    return 0;
+        const REAL fraction = position[d] / dimensions[d] - std::floor(position[d] / dimensions[d]);
+        return std::min( nCells[d] - 1, static_cast<int>(fraction * nCells[d]) );
+    };
+    auto cellIndex = [&](int x, int y, int z){ return x + nCells[0] * (y + nCells[1] * z); };
+
+    // cell list of the given atoms (their molecules are always selected)
+    const std::unordered_set<std::size_t> centreIDs ( atomIDs.begin(), atomIDs.end() );
+    std::vector<std::vector<REALVEC>> cells ( nCells[0] * nCells[1] * nCells[2] );
+    std::size_t i {0};
+    for( const auto& molecule: *this )
+    {
+        for( const auto& atom: molecule )
+        {
+            if( centreIDs.count(atom.id) == 0 )     continue;
+            cells[ cellIndex(cellOf(atom.position, 0), cellOf(atom.position, 1), cellOf(atom.position, 2)) ].push_back( atom.position );
+            selected[i] = true;
+        }
+        ++ i;
+    }
+
+    // (neighbouring cells, without duplicates if there are less than three cells in a dimension)
+    auto neighbours = [&](int n, std::size_t d)
+    {
+        std::vector<int> indices {n};
+        if( nCells[d] > 1 )     indices.push_back( (n + 1) % nCells[d] );
+        if( nCells[d] > 2 )     indices.push_back( (n - 1 + nCells[d]) % nCells[d] );
+        return indices;
+    };
+
+    i = 0;
+    for( const auto& molecule: *this )
+    {
+        for( auto atom = molecule.begin(); atom != molecule.end() && ! selected[i]; ++atom )
+        {
+            for( auto n_x: neighbours(cellOf(atom->position, 0), 0) )
+            {
+                for( auto n_y: neighbours(cellOf(atom->position, 1), 1) )
+                {
+                    for( auto n_z: neighbours(cellOf(atom->position, 2), 2) )
+                    {
+                        for( const auto& centre: cells[cellIndex(n_x, n_y, n_z)] )
+                        {
+                            if( enhance::distance(atom->position, centre, dimensions) <= radius )   selected[i] = true;
+                        }
+                    }
+                }
+            }
+        }
+        ++ i;
+    }
+    return selected;
+}
+
+
+
 //
 // get specific molecule and add it if not existing yet
 //
@@ -142,17 +217,99 @@ Molecule& Topology::getAddMolecule(std::size_t molid, std::string molname)
 
 
 
+//
+// keep track of the # molecules per moleculetype when a molecule is removed
+//
+void Topology::removed(const std::string& name)
+{
+    auto count = moleculetypeCounts.find(name);
+    if( count == moleculetypeCounts.end() )     return;
+    if( -- count->second == 0 )     moleculetypeCounts.erase(count);
+}
+
+
 //
 // remove specific molecule
 //
 void Topology::removeMolecule(Molecule& mol)
 {
-    data.erase( std::remove_if( begin(), end(), [&](auto& m){ return ( mol.getID() == m.getID() && mol.getName() == m.getName() ); } ), end() );
+    auto isRemoved = [&](auto& m){ return ( mol.getID() == m.getID() && mol.getName() == m.getName() ); };
+    auto it = std::find_if( begin(), end(), isRemoved );
+    if( it == end() )   return;
+    firstDirty = std::min( firstDirty, static_cast<std::size_t>(std::distance(begin(), it)) );
+    std::for_each( it, end(), [&](auto& m){ if( isRemoved(m) ) removed(m.getName()); } );
+    data.erase( std::remove_if( it, end(), isRemoved ), end() );
 }
 
 void Topology::removeMolecule(std::size_t molid)
 {
-    data.erase( std::remove_if( begin(), end(), [&](auto& m){ return molid == m.getID(); } ), end() );
+    auto isRemoved = [&](auto& m){ return molid == m.getID(); };
+    auto it = std::find_if( begin(), end(), isRemoved );
+    if( it == end() )   return;
+    firstDirty = std::min( firstDirty, static_cast<std::size_t>(std::distance(begin(), it)) );
+    std::for_each( it, end(), [&](auto& m){ if( isRemoved(m) ) removed(m.getName()); } );
+    data.erase( std::remove_if( it, end(), isRemoved ), end() );
+}
+
+
+//
+// apply a batch of changes in a single pass:
+// skip removed molecules and insert new molecules at the end of the range of their moleculetype
+// (if the topology is not ordered anyway, new molecules are simply appended)
+// then add the reaction records of the new molecules
+//
+void Topology::commit(Batch& batch)
+{
+    std::vector<bool> flagged ( nextMolID, false );
+    for( const auto& molid: batch.removals )
+    {
+        if( molid < flagged.size() )    flagged[molid] = true;
+    }
+    auto isRemoved = [&flagged](const auto& m){ return m.getID() < flagged.size() && flagged[m.getID()]; };
+    for( const auto& m: batch.insertions )  ++ moleculetypeCounts[m.getName()];
+
+    if( ordered )
+    {
+        std::stable_sort( batch.insertions.begin(), batch.insertions.end(), [](auto& lhs, auto& rhs){ return lhs.getName() < rhs.getName(); });
+
+        std::vector<Molecule> merged {};
+        merged.reserve( data.size() + batch.insertions.size() );
+        auto insertion = batch.insertions.begin();
+        for( auto& m: data )
+        {
+            if( isRemoved(m) )
+            {
+                firstDirty = std::min( firstDirty, merged.size() );
+                removed( m.getName() );
+                continue;
+            }
+            while( insertion != batch.insertions.end() && insertion->getName() < m.getName() )
+            {
+                firstDirty = std::min( firstDirty, merged.size() );
+                merged.push_back( std::move(*insertion++) );
+            }
+            merged.push_back( std::move(m) );
+        }
+        if( insertion != batch.insertions.end() )   firstDirty = std::min( firstDirty, merged.size() );
+        for( ; insertion != batch.insertions.end(); ++insertion )     merged.push_back( std::move(*insertion) );
+        data.swap( merged );
+    }
+    else
+    {
+        auto first = std::find_if( begin(), end(), isRemoved );
+        firstDirty = std::min( firstDirty, static_cast<std::size_t>(std::distance(begin(), first)) );
+        std::for_each( first, end(), [&](auto& m){ if( isRemoved(m) ) removed(m.getName()); } );
+        data.erase( std::remove_if( first, end(), isRemoved ), end() );
+        data.reserve( data.size() + batch.insertions.size() );
+        for( auto& m: batch.insertions )    data.push_back( std::move(m) );
+    }
+
+    for( const auto& molid: batch.records )     addReactionRecord( molid );
+    nextMolID = std::max( nextMolID, batch.nextMolID );
+
+    batch.removals.clear();
+    batch.insertions.clear();
+    batch.records.clear();
 }
 
 //
@@ -191,51 +348,67 @@ bool Topology::containsMolecule(const std::size_t& molid) const
 std::vector<std::string> Topology::getMoleculetypes() const
 {
     std::vector<std::string> moleculetypes;
-    for( const auto& m: data )
-    {
-        auto it = std::find_if( moleculetypes.begin(), moleculetypes.end(), [&m](auto mt){ return mt == m.getName(); } );
-        if( it == moleculetypes.end() )    moleculetypes.push_back( m.getName() );
-    }
+    moleculetypes.reserve( moleculetypeCounts.size() );
+    for( const auto& count: moleculetypeCounts )    moleculetypes.push_back( count.first );
     return moleculetypes;
-
 }
 
 //
 // sort topology, i.e. rearrange and renumber everything (molecules + atoms)
 //
+// if the molecules are still ordered (by name), only the molecules from the first changed
+// position onwards are renumbered, otherwise everything is sorted and renumbered
+//
 void Topology::sort()
 {
     // clear atomic reaction records
     reactedAtomRecords.clear();
 
-    // sort (according to name) and renumber molecules
-    // then renumber atoms accordingly
+    // sort (according to name)
     // note:  use stable_sort instead of sort to retain order of equal elements!
-    std::stable_sort( begin(), end(), [](auto& lhs, auto& rhs){ return lhs.getName() < rhs.getName(); });
+    if( ! ordered )
+    {
+        std::stable_sort( begin(), end(), [](auto& lhs, auto& rhs){ return lhs.getName() < rhs.getName(); });
+        ordered = true;
+        firstDirty = 0;
+    }
     
-    std::size_t counterMolecules = 0;
+    // renumber molecules from the first changed position onwards,
+    // then renumber atoms accordingly
+    std::size_t counterMolecules = std::min( firstDirty, data.size() );
     std::size_t counterAtoms = 0;
+    for( auto it = data.begin() + counterMolecules; it != data.begin(); )
+    {
+        --it;
+        if( ! it->empty() )
+        {
+            counterAtoms = it->back().id;
+            break;
+        }
+    }
     
-    for( auto& m: data )
+    for( auto m = data.begin() + counterMolecules; m != data.end(); ++m )
     {   
-        //cout<<"aaah" << m << endl;
         // renumber molecules
         ++ counterMolecules;
         // check if this is a newly reacted molecule
         bool isReactedMolecule = false;
-        auto search = std::find_if(std::begin(reactedMoleculeRecords), std::end(reactedMoleculeRecords), [&m](const auto& record){return m.getID() == record.first; });
-        if( search != std::end(reactedMoleculeRecords) )
+        if( ! reactedMoleculeIndex.empty() )
         {
-            isReactedMolecule = true;
-            search->second = counterMolecules;
+            auto search = reactedMoleculeIndex.find( m->getID() );
+            if( search != reactedMoleculeIndex.end() )
+            {
+                isReactedMolecule = true;
+                reactedMoleculeRecords[search->second].second = counterMolecules;
+            }
         }
         // reset ID
         #ifndef NDEBUG
-        if( m.getID() != counterMolecules ){ rsmdDEBUG("note: resetting ID of " << m << " to " << counterMolecules); }
+        if( m->getID() != counterMolecules ){ rsmdDEBUG("note: resetting ID of " << *m << " to " << counterMolecules); }
         #endif
-        m.setID(counterMolecules);
+        m->setID(counterMolecules);
         // renumber atoms in molecule
-        for( auto& a: m )
+        for( auto& a: *m )
         {
             ++ counterAtoms;
             // record ID changes if reactedMolecule
@@ -247,6 +420,8 @@ void Topology::sort()
             a.id = counterAtoms;
         }
     }
+    firstDirty = data.size();
+    nextMolID = counterMolecules + 1;
 }
 
 //
@@ -15,6 +15,8 @@
 #include "container/molecule.hpp"
 
 #include <vector>
+#include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <numeric>
 #include <math.h>
@@ -27,6 +29,10 @@ using namespace std;
 // contains molecules and all kind of useful methods that work with/on these molecules
 //          + box dimensions
 //
+// molecules are kept in ranges per moleculetype (sorted by name) as long as possible:
+// batches insert new molecules at the end of their moleculetype's range, so that sort()
+// only has to renumber molecules/atoms from the first changed position onwards
+//
 
 class Topology
     : public ContainerBase< std::vector<Molecule> >
@@ -34,9 +40,57 @@ class Topology
     REALVEC dimensions {0, 0, 0};
     std::vector<int> CellNumbers {0, 0, 0};
     std::vector<std::pair<std::size_t, std::size_t>> reactedMoleculeRecords {};
+    std::unordered_map<std::size_t, std::size_t> reactedMoleculeIndex {};  // old molecule ID -> index in reactedMoleculeRecords
+    std::map<std::string, std::size_t> moleculetypeCounts {};     // # molecules per moleculetype (tracked incrementally)
     std::vector<std::pair<std::size_t, std::size_t>> reactedAtomRecords {};
+    std::size_t nextMolID {1};      // next free molecule ID (tracked incrementally)
+    bool        ordered {true};     // molecules are sorted by name
+    std::size_t firstDirty {0};     // molecules before this position are numbered consecutively
+
+    //
+    // keep track of order / numbering when molecules are appended
+    //
+    inline void appended(const std::string& name)
+    {
+        if( ordered && ! data.empty() && name < data.back().getName() )  ordered = false;
+        firstDirty = std::min( firstDirty, data.size() );
+        ++ moleculetypeCounts[name];
+    }
+    void removed(const std::string&);
     
   public:
+    //
+    // a batch of changes (removal / insertion of molecules) that is applied in a single pass,
+    // e.g. for many reactions at once:
+    //      auto batch = topology.beginBatch();
+    //      batch.remove(molid); ...
+    //      auto newMolID = batch.add(molecule, true); ...
+    //      topology.commit(batch);
+    // (only one batch per topology at a time, since the batch hands out molecule IDs)
+    //
+    class Batch
+    {
+        friend class Topology;
+        std::vector<std::size_t> removals {};
+        std::vector<Molecule>    insertions {};
+        std::vector<std::size_t> records {};    // IDs of inserted molecules that get a reaction record
+        std::size_t nextMolID {1};
+
+      public:
+        inline void remove(std::size_t molid) { removals.push_back(molid); }
+        inline std::size_t add(const Molecule& m, bool addReactionRecord)
+        {
+            insertions.push_back(m);
+            insertions.back().setID(nextMolID);
+            if( addReactionRecord )     records.push_back(nextMolID);
+            return nextMolID++;
+        }
+        inline bool empty() const { return removals.empty() && insertions.empty(); }
+    };
+
+    inline Batch beginBatch() const { Batch batch; batch.nextMolID = nextMolID; return batch; }
+    void commit(Batch&);
+
     //
     // getter/setter for dimensions
     //
@@ -49,6 +103,7 @@ class Topology
     //
     inline void        addReactionRecord(const std::size_t& molid) 
     { 
+        reactedMoleculeIndex[molid] = reactedMoleculeRecords.size();
         reactedMoleculeRecords.emplace_back(std::make_pair(molid, 0)); 
     }
     inline const auto& getReactionRecordsAtoms()     { return reactedAtomRecords; }
@@ -60,10 +115,14 @@ class Topology
     //
     inline auto addMolecule(Molecule m)    
     { 
+        nextMolID = std::max(nextMolID, m.getID() + 1);
+        appended(m.getName());
         return data.emplace(end(), m); 
     }
     inline auto addMolecule(std::size_t id, std::string name) 
     { 
+        nextMolID = std::max(nextMolID, id + 1);
+        appended(name);
         auto it = data.emplace(end()); 
         it->setID(id); 
         it->setName(name); 
@@ -92,11 +151,18 @@ class Topology
     //
     const Molecule& getMolecule(std::size_t) const;
     std::vector<std::reference_wrapper<Molecule>> getMolecules(std::string);
+    inline std::size_t getNextMoleculeID() const { return nextMolID; }
     
     //
     //std::vector<std::reference_wrapper<Molecule>> Cell();
     //std::vector<Topology> getCellList();   
     std::tuple<std::vector<std::vector<std::reference_wrapper<Molecule>>>, std::vector<std::vector<int>>> getCellList();
+
+    //
+    // flags (per molecule, in order) of all molecules with at least one atom within the given distance
+    // of one of the given atoms (by atom id), using a cell list of the given atoms with cells >= distance
+    //
+    std::vector<bool> getNeighbourhood(const std::vector<std::size_t>&, REAL) const;
     int heaviside(int);
     int right(int);
     int left(int);
@@ -109,9 +175,10 @@ class Topology
     Molecule& getAddMolecule(std::size_t, std::string);
 
     //
-    // get moleculetypes
+    // get moleculetypes (sorted by name) / # molecules per moleculetype
     //
     std::vector<std::string> getMoleculetypes() const;
+    inline const auto& getMoleculetypeCounts() const { return moleculetypeCounts; }
 
     //
     // get # of atoms
@@ -123,6 +190,7 @@ class Topology
 
     //
     // sort topology, i.e. rearrange and renumber everything
+    // (only renumbers from the first changed position if the molecules are still in order)
     //
     void sort();
     //void grid();
@@ -147,13 +215,19 @@ class Topology
     inline void clear() 
     { 
         data.clear(); 
+        nextMolID = 1;
+        ordered = true;
+        firstDirty = 0;
+        moleculetypeCounts.clear();
         dimensions.setZero(); 
         reactedAtomRecords.clear(); 
         reactedMoleculeRecords.clear();
+        reactedMoleculeIndex.clear();
     }
     inline void clearReactionRecords() 
     { 
         reactedMoleculeRecords.clear(); 
+        reactedMoleculeIndex.clear();
         reactedAtomRecords.clear(); 
     }
     
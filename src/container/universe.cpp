@@ -11,7 +11,9 @@
 
 #include "container/universe.hpp"
 #include "container/topology.hpp"
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <cmath>
 #include <math.h>
 using namespace std;
@@ -23,6 +25,7 @@ void Universe::setup(const Parameters& parameters)
     switch( parameters.getEngineType() )
     {
         case ENGINE::GROMACS:   
+        case ENGINE::MOCK:      // uses the gromacs file formats
             topologyParser = std::make_unique<TopologyParserGMX>();
             assert(topologyParser);
 
@@ -36,6 +39,8 @@ void Universe::setup(const Parameters& parameters)
             break;
     }
 
+    topologyParser->setup(parameters);
+
     // read reaction templates from files
     auto reactionFiles = parameters.getOption("reaction.file").as<std::vector<std::string>>();
     rsmdLOG("... reading reaction templates ... ");
@@ -64,13 +69,123 @@ void Universe::setup(const Parameters& parameters)
                 if( reaction.getRate().size() == 0 )
                     rsmdWARNING( "    no reaction rate input, are you sure that is correct?" );
                 break;
+
+            case SIMALGORITHM::KMC:
+                // --> the rates are the only input of the event selection
+                if( reaction.getRate().size() == 0 )
+                    rsmdCRITICAL( "    no reaction rate input, required for kinetic Monte Carlo (reaction.kmc)" );
+                break;
         }
         // check for consistency within reactants/products/criterions
         reaction.consistencyCheck();
         rsmdLOG( "... consistency check done. everything seems fine.");
+
+        // tabulate the (distance-dependent) rate for fast lookup
+        reaction.setupRate();
+        if( reaction.getRateTable() && reaction.getRateTable()->distanceDependent() )
+        {
+            rsmdLOG( "... resampled rate onto " << reaction.getRateTable()->size() << " grid points (spacing " << reaction.getRateTable()->getSpacing() << ")" );
+        }
         
         reactionTemplates.emplace_back(reaction);
     }
+
+    // group the reaction templates for the candidate search
+    planSearch();
+}
+
+
+
+//
+// search plan: group reaction templates by the types of their first two reactants
+//
+void Universe::planSearch()
+{
+    searchPlan.clear();
+    for( std::size_t t=0; t<reactionTemplates.size(); ++t )
+    {
+        const auto& reactants = reactionTemplates[t].getReactants();
+        if( reactants.size() < 2 || reactants.size() > 4 )
+        {
+            rsmdWARNING( "... reaction '" << reactionTemplates[t].getName() << "' has " << reactants.size() << " reactants, the candidate search supports 2 - 4: skipping it" );
+            continue;
+        }
+        auto group = std::find_if( searchPlan.begin(), searchPlan.end(), [&reactants](const auto& g){
+            return g.reactant1 == reactants[0].getName() && g.reactant2 == reactants[1].getName(); });
+        if( group == searchPlan.end() )
+        {
+            searchPlan.push_back( {reactants[0].getName(), reactants[1].getName(), {}} );
+            group = std::prev( searchPlan.end() );
+        }
+        group->templates.push_back( t );
+    }
+    rsmdLOG( "... candidate search: " << reactionTemplates.size() << " reaction templates in " << searchPlan.size() << " group(s) of reactant types" );
+    for( const auto& group: searchPlan )
+    {
+        rsmdVERBOSE( "    " << group.reactant1 << " + " << group.reactant2 << ": " << group.templates.size() << " template(s)" );
+    }
+
+    // reactants with intramolecular criterions
+    moleculeFilters.clear();
+    moleculeFilterBits.assign( reactionTemplates.size(), {} );
+    std::size_t nFilters = 0;
+    for( std::size_t t=0; t<reactionTemplates.size(); ++t )
+    {
+        const auto& reactants = reactionTemplates[t].getReactants();
+        moleculeFilterBits[t].assign( reactants.size(), -1 );
+        for( std::size_t r=0; r<reactants.size(); ++r )
+        {
+            if( ! reactionTemplates[t].hasMoleculeCriterions(r) )  continue;
+            auto& filters = moleculeFilters[ reactants[r].getName() ];
+            if( filters.size() == 64 )
+            {
+                rsmdCRITICAL( "more than 64 reactants of type " << reactants[r].getName() << " with intramolecular criterions" );
+            }
+            moleculeFilterBits[t][r] = filters.size();
+            filters.push_back( {t, r} );
+            ++ nFilters;
+        }
+    }
+    if( nFilters > 0 )
+    {
+        rsmdLOG( "... " << nFilters << " reactant(s) with intramolecular criterions, evaluated once per molecule" );
+    }
+}
+
+
+
+//
+// evaluate all intramolecular criterions once for every molecule of a filtered type
+//
+void Universe::evaluateMoleculeCriterions()
+{
+    if( moleculeFilters.empty() )   return;
+
+    std::size_t highestMolID = 0;
+    for( const auto& molecule: topologyOld )    highestMolID = std::max( highestMolID, molecule.getID() );
+    moleculeMasks.assign( highestMolID + 1, 0 );
+
+    std::unordered_map<std::string, std::vector<ReactionCandidate>> working {};
+    for( const auto& [type, filters]: moleculeFilters )
+    {
+        auto& candidates = working[type];
+        for( const auto& filter: filters )  candidates.emplace_back( reactionTemplates[filter.reactionTemplate] );
+    }
+
+    const auto& dimensions = topologyOld.getDimensions();
+    for( const auto& molecule: topologyOld )
+    {
+        auto filters = moleculeFilters.find( molecule.getName() );
+        if( filters == moleculeFilters.end() )  continue;
+        auto& candidates = working[molecule.getName()];
+        for( std::size_t bit=0; bit<filters->second.size(); ++bit )
+        {
+            const auto& filter = filters->second[bit];
+            candidates[bit].getReactants()[filter.reactant] = reactionTemplates[filter.reactionTemplate].getReactants()[filter.reactant];
+            candidates[bit].updateReactant( filter.reactant, molecule );
+            if( candidates[bit].validMolecule(dimensions, filter.reactant) )     moleculeMasks[molecule.getID()] |= (std::uint64_t(1) << bit);
+        }
+    }
 }
 
 
@@ -79,6 +194,7 @@ void Universe::setup(const Parameters& parameters)
 //
 void Universe::update(const std::size_t& cycle) 
 {
+    enhance::ScopedTimer timer ("update");
     topologyOld.clear();
     topologyNew.clear();
     topologyRelaxed.clear();
@@ -93,6 +209,7 @@ void Universe::update(const std::size_t& cycle)
 //
 void Universe::write(const std::size_t& cycle)
 {
+    enhance::ScopedTimer timer ("write");
     topologyNew.sort();
     topologyParser->write(topologyNew, cycle);
 }
@@ -103,6 +220,7 @@ void Universe::write(const std::size_t& cycle)
 //
 void Universe::readRelaxed(const std::size_t& cycle)
 {
+    enhance::ScopedTimer timer ("readRelaxed");
     topologyRelaxed.clear();
     topologyParser->readRelaxed(topologyRelaxed, cycle);
 }
@@ -175,7 +293,7 @@ bool Universe::isAvailable( const ReactionCandidate& candidate )
 
 void Universe::makeMoleculeWhole(Molecule& molecule, const REALVEC& dimensions)
 {
-    rsmdLOG( "... repairing molecule in case it is broken across periodic boundaries: " << molecule );
+    rsmdVERBOSE( "... repairing molecule in case it is broken across periodic boundaries: " << molecule );
     Atom& referenceAtom = molecule.front();
     for(auto& atom: molecule)
     {   
@@ -190,8 +308,8 @@ void Universe::makeMoleculeWhole(Molecule& molecule, const REALVEC& dimensions)
         REALVEC after = atom.position;
         if( moved )
         {
-            rsmdLOG( "    before: " << before );
-            rsmdLOG( "    after: " << after );
+            rsmdVERBOSE( "    before: " << before );
+            rsmdVERBOSE( "    after: " << after );
         }
     }
 }
@@ -202,32 +320,48 @@ void Universe::makeMoleculeWhole(Molecule& molecule, const REALVEC& dimensions)
 //
 void Universe::react(ReactionCandidate& candidate)
 {
-    rsmdDEBUG( "performing reaction for candidate " << candidate.shortInfo() );
-   
-    // reactant --> product translation 
-    candidate.applyTransitions();
-    // make products whole
-    for(auto& product: candidate.getProducts())
+    std::vector<std::reference_wrapper<ReactionCandidate>> candidates { candidate };
+    react(candidates);
+}
+
+//
+// react a batch of candidates that do not share any molecules
+// (all reactants are removed from / all products are added to the topology in a single pass)
+//
+void Universe::react(std::vector<std::reference_wrapper<ReactionCandidate>>& candidates)
+{
+    enhance::ScopedTimer timer ("react");
+    if( candidates.empty() )    return;
+
+    auto batch = topologyNew.beginBatch();
+    for( ReactionCandidate& candidate: candidates )
     {
-        makeMoleculeWhole(product, topologyNew.getDimensions());
+        rsmdDEBUG( "performing reaction for candidate " << candidate.shortInfo() );
+       
+        // reactant --> product translation 
+        candidate.applyTransitions();
+        // make products whole
+        for(auto& product: candidate.getProducts())
+        {
+            makeMoleculeWhole(product, topologyNew.getDimensions());
+        }
+        // apply translational movements of product atoms
+        candidate.applyTranslations();
+
+        // collect changes to topology
+        for( const auto& reactant: candidate.getReactants() )
+        {
+            batch.remove( reactant.getID() );
+        }
+        for( auto& product: candidate.getProducts() )
+        {
+            product.setID( batch.add(product, true) );
+            rsmdDEBUG( "new molecule " << product.getName() << " got ID " << product.getID() );
+        }
     }
-    // apply translational movements of product atoms
-    candidate.applyTranslations();
 
     // apply changes to topology
-    auto highestMolID = std::max_element( std::begin(topologyNew), std::end(topologyNew), [](const auto& mol1, const auto& mol2){ return mol1.getID() < mol2.getID(); } )->getID(); 
-    for( const auto& reactant: candidate.getReactants() )
-    {
-        topologyNew.removeMolecule( reactant.getID() );    
-    }
-    for( auto& product: candidate.getProducts() )
-    {
-        product.setID( ++highestMolID );
-        auto molecule __attribute__((unused)) = topologyNew.addMolecule( product );
-        topologyNew.addReactionRecord( highestMolID );
-        // topologyNew.repairMoleculePBC( *molecule );
-        rsmdDEBUG( "new molecule " << molecule->getName() << " got ID " << molecule->getID() );
-    }
+    topologyNew.commit( batch );
 }
 
 //cell list 
@@ -235,7 +369,6 @@ std::tuple<std::vector<std::reference_wrapper<Molecule>>, std::vector<int>> Univ
 {   
     std::vector<std::reference_wrapper<Molecule>> molReferences {};
     std::vector<int> molCells {};
-    Molecule molecule;    
     int i, j, Index;
 
     for (i= 0 ; i < CellNeighbourIndices[CellIndex].size(); i++)
@@ -243,8 +376,7 @@ std::tuple<std::vector<std::reference_wrapper<Molecule>>, std::vector<int>> Univ
       Index = CellNeighbourIndices[CellIndex][i];
       for(j = 0 ; j < CellList[Index].size(); j++)
       {
-        molecule = CellList[Index][j];
-        if( molecule.getName() == molname )  
+        if( CellList[Index][j].get().getName() == molname )  
         {
             molReferences.emplace_back( CellList[Index][j] );
             molCells.emplace_back( Index );
@@ -257,25 +389,25 @@ std::tuple<std::vector<std::reference_wrapper<Molecule>>, std::vector<int>> Univ
 std::vector<std::reference_wrapper<Molecule>> Universe::Cell(int CellIndex , std::string molname)
 {   
     std::vector<std::reference_wrapper<Molecule>> molReferences {};
-    Molecule molecule;   
     int j;
     
     for(j = 0 ; j < CellList[CellIndex].size(); j++)
     {
-        molecule = CellList[CellIndex][j];
-        if( molecule.getName() == molname )  molReferences.emplace_back( CellList[CellIndex][j] );
+        if( CellList[CellIndex][j].get().getName() == molname )  molReferences.emplace_back( CellList[CellIndex][j] );
     }
     return molReferences;
 }
 
 std::vector<ReactionCandidate> Universe::CellSearchReactionCandidates()
 {
+    enhance::ScopedTimer timer ("search");
     int i, CellIndex;
     std::vector<ReactionCandidate> reactionCandidates {};
     std::vector<double> reactionRates {};
     auto [x, y] = topologyOld.getCellList();
     CellList = x;
     CellNeighbourIndices = y;
+    evaluateMoleculeCriterions();
     for(CellIndex = 0; CellIndex < CellList.size();CellIndex++)
     {
         for( auto& candidate: CellReactionCandidates ( CellIndex ))
@@ -295,190 +427,110 @@ std::vector<ReactionCandidate> Universe::CellSearchReactionCandidates()
 std::vector<ReactionCandidate> Universe::CellReactionCandidates(int CellIndex)
 {
     // search for possible reaction candidates and return them if they match all criteria
-    std::vector<ReactionCandidate> reactionCandidates {};
-    std::vector<std::reference_wrapper<Molecule>> reactants1;
-    std::vector<std::reference_wrapper<Molecule>> reactants2;
-    std::vector<std::reference_wrapper<Molecule>> reactants3;
-    std::vector<std::reference_wrapper<Molecule>> reactants4;
-    std::vector<int> CellIndex2, CellIndex3, CellIndex4;
-    Molecule reactant1;
-    Molecule reactant2;
-    Molecule reactant3;
-    Molecule reactant4;
-    int i, j, k, l, cellindex1, cellindex2, cellindex3, cellindex4;
-    
-    for( auto& reactionTemplate: reactionTemplates )
+    // (one pass over the molecule pairs per group of templates,
+    //  the candidates are collected per template to keep them in template order)
+    std::vector<std::vector<ReactionCandidate>> templateCandidates ( reactionTemplates.size() );
+    std::vector<int> cellIndices ( 4, CellIndex );
+    const auto& dimensions = topologyOld.getDimensions();
+
+    for( const auto& group: searchPlan )
     {
-        if( reactionTemplate.getReactants().size() == 2 )
-        {            
-            reactants1 = Cell(CellIndex, reactionTemplate.getReactants()[0].getName() );
-            for(i = 0 ; i < reactants1.size();i++)
-            {
-              reactant1 = reactants1[i];
-              reactionCandidates.push_back( reactionTemplate );
-              reactionCandidates.back().updateReactant( 0, reactant1 );
-              rsmdDEBUG( "checking reaction candidate: " << reactant1.getName() << ", " << reactant1.getID() );
-              if( reactionCandidates.back().valid(topologyOld.getDimensions(), 0) )
-              {
-                  reactionCandidates.pop_back();
-                  auto [reactants2, CellIndex2] = CellNeighbours(CellIndex, reactionTemplate.getReactants()[1].getName() );
-                  for(j = 0 ; j < reactants2.size();j++)
-                  {
-                      reactant2 = reactants2[j];
-                      if( reactant1.getID() == reactant2.getID() ) continue;
-                      if( reactant1.getName() == reactant2.getName() && reactant1.getID() > reactant2.getID() ) continue;
-                      rsmdDEBUG( "checking reaction candidate: " << reactant2.getName() << ", " << reactant2.getID() );
-                      reactionCandidates.push_back( reactionTemplate );
-                      reactionCandidates.back().updateReactant( 0, reactant1 );
-                      reactionCandidates.back().updateReactant( 1, reactant2 );
-                      if( ! reactionCandidates.back().valid(topologyOld.getDimensions(), 1) ) reactionCandidates.pop_back();
-                  }
-              }
-              else
-              {
-                reactionCandidates.pop_back();  
-              }
-            }
-        }         
-        else if( reactionTemplate.getReactants().size() == 3 )
+        auto reactants1 = Cell(CellIndex, group.reactant1);
+        if( reactants1.empty() )    continue;
+        auto [reactants2, CellIndex2] = CellNeighbours(CellIndex, group.reactant2);
+
+        // one working candidate per template, reused for all molecules
+        // (reactants are reset from the template before updating, since updateReactant() replaces the template's atom indices)
+        std::vector<ReactionCandidate> working {};
+        for( const auto t: group.templates )    working.emplace_back( reactionTemplates[t] );
+        std::vector<char> valid1 ( group.templates.size(), 0 );
+
+        for( const Molecule& reactant1: reactants1 )
         {
-            reactants1 = Cell(CellIndex, reactionTemplate.getReactants()[0].getName() );
-            for(i = 0 ; i < reactants1.size();i++)
+            bool anyValid = false;
+            for( std::size_t g=0; g<group.templates.size(); ++g )
             {
-              reactant1 = reactants1[i];
-              reactionCandidates.push_back( reactionTemplate );
-              reactionCandidates.back().updateReactant( 0, reactant1 );
-              rsmdDEBUG( "checking reaction candidate: " << reactant1.getName() << ", " << reactant1.getID() );
-              if ( reactionCandidates.back().valid(topologyOld.getDimensions(), 0))
-              {
-                  reactionCandidates.pop_back();
-                  auto [reactants2, CellIndex2] = CellNeighbours(CellIndex, reactionTemplate.getReactants()[1].getName() );
-                  for(j = 0 ; j < reactants2.size();j++)
-                  {
-                      reactant2 = reactants2[j];
-                      if( reactant1.getID() == reactant2.getID() ) continue;
-                      if( reactant1.getName() == reactant2.getName() && reactant1.getID() > reactant2.getID() ) continue;
-                      rsmdDEBUG( "checking reaction candidate: " << reactant2.getName() << ", " << reactant2.getID() );
-                      reactionCandidates.push_back( reactionTemplate );
-                      reactionCandidates.back().updateReactant( 0, reactant1 );
-                      reactionCandidates.back().updateReactant( 1, reactant2 );
-                      if( reactionCandidates.back().valid(topologyOld.getDimensions(), 1) )
-                      {
-                          reactionCandidates.pop_back();
-                          auto [reactants3, CellIndex3] = CellNeighbours(CellIndex, reactionTemplate.getReactants()[2].getName() );
-                          for(k = 0 ; k < reactants3.size();j++)
-                          {
-                             reactant3 = reactants3[k]
-                             if( reactant1.getID() == reactant3.getID() | reactant2.getID() == reactant3.getID() ) continue;
-                             if( reactant1.getName() == reactant3.getName() && reactant1.getID() > reactant3.getID() ) continue;
-                             if( reactant2.getName() == reactant3.getName() && reactant2.getID() > reactant3.getID() ) continue;
-                             reactionCandidates.push_back( reactionTemplate );
-                             reactionCandidates.back().updateReactant( 0, reactant1 );
-                             reactionCandidates.back().updateReactant( 1, reactant2 );                                             
-                             reactionCandidates.back().updateReactant( 2, reactant3 );
-                             if( ! reactionCandidates.back().valid(topologyOld.getDimensions(), 2) ) reactionCandidates.pop_back();
-                          }
-                       }
-                       else
-                       {
-                         reactionCandidates.pop_back();
-                       }                               
-                  }
-              }
-              else
-              {
-                  reactionCandidates.pop_back();
-              }
+                valid1[g] = passesMoleculeCriterions( group.templates[g], 0, reactant1 );
+                if( ! valid1[g] )   continue;
+                working[g].getReactants()[0] = reactionTemplates[group.templates[g]].getReactants()[0];
+                working[g].updateReactant( 0, reactant1 );
+                rsmdDEBUG( "checking reaction candidate: " << reactant1.getName() << ", " << reactant1.getID() );
+                valid1[g] = working[g].valid(dimensions, 0);
+                anyValid = anyValid || valid1[g];
             }
-         }        
-        if( reactionTemplate.getReactants().size() == 4 )
-        {
-            reactants1 = Cell(CellIndex, reactionTemplate.getReactants()[0].getName() );
-            for(i = 0 ; i < reactants1.size();i++)
+            if( ! anyValid )    continue;
+
+            for( std::size_t j=0; j<reactants2.size(); ++j )
             {
-              reactant1 = reactants1[i];
-              cellindex1 = CellIndex;
-              reactionCandidates.push_back( reactionTemplate );
-              reactionCandidates.back().updateReactant( 0, reactant1 );
-              rsmdDEBUG( "checking reaction candidate: " << reactant1.getName() << ", " << reactant1.getID() );
-              if ( reactionCandidates.back().valid(topologyOld.getDimensions(), 0))
-              {
-                  reactionCandidates.pop_back();
-                  auto [reactants2, CellIndex2] = CellNeighbours(CellIndex, reactionTemplate.getReactants()[1].getName() );
-                  for(j = 0 ; j < reactants2.size();j++)
-                  {
-                      reactant2 = reactants2[j];
-                      cellindex2 = CellIndex2[j];
-                      if( reactant1.getID() == reactant2.getID() ) continue;
-                      if( reactant1.getName() == reactant2.getName() && reactant1.getID() > reactant2.getID() ) continue;   
-                      if( reactant1.getName() == reactant2.getName() && cellindex1 > cellindex2 ) continue;
-                      rsmdDEBUG( "checking reaction candidate: " << reactant2.getName() << ", " << reactant2.getID() );
-                      reactionCandidates.push_back( reactionTemplate );
-                      reactionCandidates.back().updateReactant( 0, reactant1 );
-                      reactionCandidates.back().updateReactant( 1, reactant2 );
-                      if( reactionCandidates.back().valid(topologyOld.getDimensions(), 1) )
-                      {
-                          reactionCandidates.pop_back();
-                          auto [reactants3, CellIndex3] = CellNeighbours(CellIndex, reactionTemplate.getReactants()[2].getName() );
-                          for (k = 0 ; k < reactants3.size();k++)
-                          {
-                              reactant3 = reactants3[k];
-                              cellindex3 = CellIndex3[k];
-                              if( reactant1.getID() == reactant3.getID() || reactant2.getID() == reactant3.getID() )  continue;
-                              if( reactant1.getName() == reactant3.getName() && reactant1.getID() > reactant3.getID() ) continue;
-                              if( reactant1.getName() == reactant3.getName() && cellindex1 > cellindex3 ) continue;
-                              if( reactant2.getName() == reactant3.getName() && reactant2.getID() > reactant3.getID() ) continue;
-                              if( reactant2.getName() == reactant3.getName() && cellindex2 > cellindex3 ) continue;
-                              rsmdDEBUG( "checking reaction candidate: " << reactant3.getName() << ", " << reactant3.getID() );
-                              reactionCandidates.push_back( reactionTemplate );
-                              reactionCandidates.back().updateReactant( 0, reactant1 );
-                              reactionCandidates.back().updateReactant( 1, reactant2 );                                             
-                              reactionCandidates.back().updateReactant( 2, reactant3 );
-                              if( reactionCandidates.back().valid(topologyOld.getDimensions(), 2) )
-                              {
-                                  reactionCandidates.pop_back(); 
-                                  auto [reactants4, CellIndex4] = CellNeighbours(CellIndex, reactionTemplate.getReactants()[3].getName() );
-                                  for (l = 0 ; l < reactants4.size();l++)
-                                  {
-                                      reactant4 = reactants4[l];
-                                      cellindex4 = CellIndex4[l];
-                                      if( reactant1.getID() == reactant4.getID() || reactant2.getID() == reactant4.getID() || reactant3.getID() == reactant4.getID() )  continue;
-                                      if( reactant1.getName() == reactant4.getName() && reactant1.getID() > reactant4.getID() ) continue;
-                                      if( reactant1.getName() == reactant4.getName() && cellindex1 > cellindex4 ) continue;
-                                      if( reactant2.getName() == reactant4.getName() && reactant2.getID() > reactant4.getID() ) continue;
-                                      if( reactant2.getName() == reactant4.getName() && cellindex2 > cellindex4 ) continue;
-                                      if( reactant3.getName() == reactant4.getName() && reactant3.getID() > reactant4.getID() ) continue;
-                                      if( reactant3.getName() == reactant4.getName() && cellindex3 > cellindex4 ) continue;
-                                      rsmdDEBUG( "checking reaction candidate: " << reactant4.getName() << ", " << reactant4.getID() );
-                                      reactionCandidates.push_back( reactionTemplate );
-                                      reactionCandidates.back().updateReactant( 0, reactant1 );
-                                      reactionCandidates.back().updateReactant( 1, reactant2 );
-                                      reactionCandidates.back().updateReactant( 2, reactant3 );
-                                      reactionCandidates.back().updateReactant( 3, reactant4 );
-                                      if( ! reactionCandidates.back().valid(topologyOld.getDimensions(), 3) ) reactionCandidates.pop_back();
-                                  }
-                              }
-                              else
-                              {
-                                  reactionCandidates.pop_back();
-                              }
-                          }    
-                      }
-                      else
-                      {
-                          reactionCandidates.pop_back();
-                      }
-                  }
-              }
-              else
-              {
-                  reactionCandidates.pop_back();
-              }
+                const Molecule& reactant2 = reactants2[j];
+                if( reactant1.getID() == reactant2.getID() ) continue;
+                if( reactant1.getName() == reactant2.getName() && reactant1.getID() > reactant2.getID() ) continue;
+                cellIndices[1] = CellIndex2[j];
+                for( std::size_t g=0; g<group.templates.size(); ++g )
+                {
+                    if( ! valid1[g] )   continue;
+                    const auto& reactionTemplate = reactionTemplates[group.templates[g]];
+                    if( reactionTemplate.getReactants().size() == 4 && reactant1.getName() == reactant2.getName() && CellIndex > CellIndex2[j] ) continue;
+                    if( ! passesMoleculeCriterions( group.templates[g], 1, reactant2 ) )  continue;
+                    rsmdDEBUG( "checking reaction candidate: " << reactant2.getName() << ", " << reactant2.getID() );
+                    working[g].getReactants()[1] = reactionTemplate.getReactants()[1];
+                    working[g].updateReactant( 1, reactant2 );
+                    if( working[g].valid(dimensions, 1) )
+                    {
+                        CellExtendCandidate( CellIndex, 2, group.templates[g], working[g], cellIndices, templateCandidates[group.templates[g]] );
+                    }
+                }
             }
-        }       
+        }
+    }
+
+    std::vector<ReactionCandidate> reactionCandidates {};
+    for( auto& candidates: templateCandidates )
+    {
+        std::move( candidates.begin(), candidates.end(), std::back_inserter(reactionCandidates) );
     }
-    
     return reactionCandidates;
 }
 
+
+//
+// extend a candidate (valid up to reactant step - 1) by the remaining reactants,
+// complete valid candidates are copied to the given vector
+//
+void Universe::CellExtendCandidate(int CellIndex, std::size_t step, std::size_t t, ReactionCandidate& candidate, std::vector<int>& cellIndices, std::vector<ReactionCandidate>& reactionCandidates)
+{
+    const auto& templateReactants = reactionTemplates[t].getReactants();
+    if( step == templateReactants.size() )
+    {
+        reactionCandidates.push_back( candidate );
+        return;
+    }
+
+    // (only the search for 4 reactants additionally orders identical molecule types by cell)
+    const bool orderCells = ( templateReactants.size() == 4 );
+    auto [reactants, CellIndexN] = CellNeighbours(CellIndex, templateReactants[step].getName() );
+    for( std::size_t k=0; k<reactants.size(); ++k )
+    {
+        const Molecule& reactant = reactants[k];
+        bool skip = false;
+        for( std::size_t p=0; p<step && ! skip; ++p )
+        {
+            const auto& previous = candidate.getReactants()[p];
+            if( previous.getID() == reactant.getID() )  skip = true;
+            else if( previous.getName() == reactant.getName() && previous.getID() > reactant.getID() ) skip = true;
+            else if( orderCells && previous.getName() == reactant.getName() && cellIndices[p] > CellIndexN[k] ) skip = true;
+        }
+        if( skip || ! passesMoleculeCriterions(t, step, reactant) )  continue;
+
+        rsmdDEBUG( "checking reaction candidate: " << reactant.getName() << ", " << reactant.getID() );
+        candidate.getReactants()[step] = templateReactants[step];
+        candidate.updateReactant( step, reactant );
+        cellIndices[step] = CellIndexN[k];
+        if( candidate.valid(topologyOld.getDimensions(), step) )
+        {
+            CellExtendCandidate( CellIndex, step + 1, t, candidate, cellIndices, reactionCandidates );
+        }
+    }
+}
+
     
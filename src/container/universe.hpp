@@ -13,11 +13,15 @@
 
 #include "unitSystem.hpp"
 #include "enhance/random.hpp"
+#include "enhance/timing.hpp"
 #include "container/topology.hpp"
 #include "reaction/reactionCandidate.hpp"
 #include "parser/topologyParserGMX.hpp"
 #include "parser/reactionParser.hpp"
 
+#include <cstdint>
+#include <unordered_map>
+
 //
 // universe class
 //
@@ -48,6 +52,45 @@ class Universe
     std::tuple<std::vector<std::reference_wrapper<Molecule>>, std::vector<int>> CellNeighbours(int , std::string);
     std::vector<std::reference_wrapper<Molecule>> Cell(int, std::string);    
 
+    //
+    // search plan: reaction templates grouped by the types of their first two reactants,
+    // each pair of molecules is visited once per group and
+    // only the criterions are checked per template
+    //
+    struct SearchGroup
+    {
+        std::string reactant1 {};
+        std::string reactant2 {};
+        std::vector<std::size_t> templates {};
+    };
+    std::vector<SearchGroup> searchPlan {};
+    void planSearch();
+
+    //
+    // intramolecular criterions: evaluated once per molecule and search,
+    // a molecule's mask holds one bit per (template, reactant) of its type
+    // with criterions within that reactant (set if they are all valid)
+    //
+    struct MoleculeFilter
+    {
+        std::size_t reactionTemplate {0};
+        std::size_t reactant {0};
+    };
+    std::unordered_map<std::string, std::vector<MoleculeFilter>> moleculeFilters {};
+    std::vector<std::vector<int>> moleculeFilterBits {};    // bit per template and reactant, -1 if not filtered
+    std::vector<std::uint64_t> moleculeMasks {};           // per molecule ID
+    void evaluateMoleculeCriterions();
+    inline bool passesMoleculeCriterions(const std::size_t& t, const std::size_t& reactantix, const Molecule& molecule) const
+    {
+        const int bit = moleculeFilterBits[t][reactantix];
+        return bit < 0 || ( (moleculeMasks[molecule.getID()] >> bit) & 1 );
+    }
+
+    //
+    // extend a candidate of the given template by the reactants >= the given step (cell search, reactants 3 and 4)
+    //
+    void CellExtendCandidate(int, std::size_t, std::size_t, ReactionCandidate&, std::vector<int>&, std::vector<ReactionCandidate>&);
+
     //
     // repair a molecule in case it is broken across periodic boundaries
     //
@@ -87,9 +130,10 @@ class Universe
     bool isAvailable(const ReactionCandidate&);
 
     //
-    // react a given candidate
+    // react a given candidate / a batch of candidates that do not share any molecules
     //
     void react(ReactionCandidate&);
+    void react(std::vector<std::reference_wrapper<ReactionCandidate>>&);
 
     //
     // check a given candidate for for 'physical meaningfulness'
@@ -100,5 +144,6 @@ class Universe
     // some getters
     //
     const auto& getReactionTemplates() const { return reactionTemplates; }
+    const auto& getReactionRecordsAtoms() { return topologyNew.getReactionRecordsAtoms(); }
     
 };
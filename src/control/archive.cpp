@@ -0,0 +1,366 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "control/archive.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef RSMD_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+    const std::string MAGIC {"rsmd-archive"};
+    const std::string INDEX_MAGIC {"rsmd-archive-index"};
+    constexpr int VERSION {1};
+    constexpr unsigned int TRAILER_MAGIC {0x52534d49};
+    constexpr std::size_t TRAILER_SIZE {12};
+
+    std::uint32_t decodeSize(const unsigned char* bytes)
+    {
+        return (std::uint32_t(bytes[0]) << 24) | (std::uint32_t(bytes[1]) << 16) | (std::uint32_t(bytes[2]) << 8) | std::uint32_t(bytes[3]);
+    }
+
+    //
+    // read (the first n bytes of) the size-prefixed block at the given position,
+    // returns false if the block is truncated
+    //
+    bool readBlock(std::ifstream& FILE, std::uint64_t position, std::uint64_t fileSize, std::vector<char>& block, std::uint32_t& size, std::size_t n = std::string::npos)
+    {
+        if( position + 4 > fileSize )   return false;
+        unsigned char bytes[4];
+        FILE.clear();
+        FILE.seekg( position );
+        if( ! FILE.read(reinterpret_cast<char*>(bytes), 4) )  return false;
+        size = decodeSize(bytes);
+        if( position + 4 + size > fileSize )    return false;
+        block.resize( std::min<std::size_t>(size, n) );
+        return static_cast<bool>( FILE.read(block.data(), block.size()) );
+    }
+
+    void writeBlock(std::ofstream& FILE, const XdrWriter& writer)
+    {
+        XdrWriter size {};
+        size.writeUInt( static_cast<unsigned int>(writer.size()) );
+        FILE.write( size.data().data(), size.size() );
+        FILE.write( writer.data().data(), writer.size() );
+    }
+
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream FILE( path, std::ios::binary );
+        if( ! FILE )    throw std::runtime_error("could not read file '" + path + "'");
+        std::ostringstream content {};
+        content << FILE.rdbuf();
+        return content.str();
+    }
+
+    bool compress(const std::string& content, std::string& compressed)
+    {
+#ifdef RSMD_ZLIB
+        uLongf size = compressBound( content.size() );
+        compressed.resize( size );
+        if( compress2( reinterpret_cast<Bytef*>(compressed.data()), &size, reinterpret_cast<const Bytef*>(content.data()), content.size(), Z_BEST_SPEED ) != Z_OK )
+            return false;
+        compressed.resize( size );
+        return true;
+#else
+        (void) content;
+        (void) compressed;
+        return false;
+#endif
+    }
+
+    std::string decompress(const std::string& compressed, std::size_t size, const std::string& name)
+    {
+#ifdef RSMD_ZLIB
+        std::string content ( size, '\0' );
+        uLongf length = size;
+        if( uncompress( reinterpret_cast<Bytef*>(content.data()), &length, reinterpret_cast<const Bytef*>(compressed.data()), compressed.size() ) != Z_OK || length != size )
+            throw std::runtime_error("corrupt archived file '" + name + "'");
+        return content;
+#else
+        (void) compressed;
+        (void) size;
+        throw std::runtime_error("archived file '" + name + "' is compressed, but rs@md was built without zlib");
+#endif
+    }
+}
+
+
+
+//
+// length of the part of a .top file up to (and including) the [ molecules ] directive
+//
+std::size_t archive::topologyPrefixLength(const std::string& content)
+{
+    std::size_t begin {0};
+    while( begin < content.size() )
+    {
+        auto end = content.find('\n', begin);
+        end = ( end == std::string::npos ? content.size() : end + 1 );
+        const auto line = std::string_view(content).substr(begin, end - begin);
+        if( line.find('[') != std::string_view::npos && line.find("molecules") != std::string_view::npos )  return end;
+        begin = end;
+    }
+    return 0;
+}
+
+
+bool archive::compressionAvailable()
+{
+#ifdef RSMD_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+
+//
+// open the archive, create a new one or append to an existing one
+//
+void ArchiveWriter::open(const std::string& name, bool append)
+{
+    filename = name;
+    index.clear();
+    topologyPrefix.clear();
+
+    if( append && std::filesystem::exists(filename) && std::filesystem::file_size(filename) > 0 )
+    {
+        try
+        {
+            ArchiveReader existing (filename);
+            index = existing.getIndex();
+            if( existing.contains("0.top") )
+            {
+                const auto base = existing.extract("0.top");
+                topologyPrefix = base.substr( 0, archive::topologyPrefixLength(base) );
+            }
+            position = existing.getEnd();
+        }
+        catch(const std::exception& e)
+        {
+            rsmdCRITICAL( "could not read the archive " << filename << ": " << e.what() );
+        }
+        // remove the index (rewritten on close) respectively a truncated block at the end
+        if( position < std::filesystem::file_size(filename) )   std::filesystem::resize_file( filename, position );
+        FILE.open( filename, std::ios::binary | std::ios::app );
+    }
+    else
+    {
+        FILE.open( filename, std::ios::binary | std::ios::trunc );
+        XdrWriter writer {};
+        writer.writeString( MAGIC );
+        writer.writeInt( VERSION );
+        writeBlock( FILE, writer );
+        position = 4 + writer.size();
+    }
+
+    if( ! FILE )
+    {
+        rsmdCRITICAL( "opening file " << filename << " failed." );
+    }
+    FILE.flush();
+}
+
+
+
+//
+// add a file (given name, path to its content) to the archive
+//
+void ArchiveWriter::add(const std::string& name, const std::string& path)
+{
+    const auto content = readFile( path );
+
+    ARCHIVE_CODEC codec {ARCHIVE_CODEC::RAW};
+    std::string payload {};
+    const bool isTopology = ( std::filesystem::path(name).extension() == ".top" );
+    if( name == "0.top" )
+    {
+        topologyPrefix = content.substr( 0, archive::topologyPrefixLength(content) );
+    }
+    else if( isTopology && ! topologyPrefix.empty() && content.compare(0, topologyPrefix.size(), topologyPrefix) == 0 )
+    {
+        codec = ARCHIVE_CODEC::TOP_DELTA;
+        payload = content.substr( topologyPrefix.size() );
+    }
+    if( codec != ARCHIVE_CODEC::TOP_DELTA )
+    {
+        if( compress(content, payload) )    codec = ARCHIVE_CODEC::ZLIB;
+        else                                payload = content;
+    }
+
+    XdrWriter writer {};
+    writer.reserve( payload.size() + name.size() + 32 );
+    writer.writeString( name );
+    writer.writeInt( static_cast<int>(codec) );
+    writer.writeUInt( static_cast<unsigned int>(content.size()) );
+    writer.writeString( payload );
+    writeBlock( FILE, writer );
+    FILE.flush();
+    if( ! FILE )    throw std::runtime_error("could not write to archive '" + filename + "'");
+
+    index.emplace_back( name, position );
+    position += 4 + writer.size();
+}
+
+
+
+//
+// write the index and close the archive
+//
+void ArchiveWriter::close()
+{
+    if( ! FILE.is_open() )  return;
+
+    XdrWriter writer {};
+    writer.writeString( INDEX_MAGIC );
+    writer.writeUInt( static_cast<unsigned int>(index.size()) );
+    for( const auto& entry: index )
+    {
+        writer.writeString( entry.first );
+        writer.writeInt64( static_cast<std::int64_t>(entry.second) );
+    }
+    writeBlock( FILE, writer );
+
+    XdrWriter trailer {};
+    trailer.writeInt64( static_cast<std::int64_t>(position) );
+    trailer.writeUInt( TRAILER_MAGIC );
+    FILE.write( trailer.data().data(), trailer.size() );
+    FILE.close();
+}
+
+
+
+//
+// open an archive and read its index
+// (respectively rebuild it from the block headers if there is none)
+//
+ArchiveReader::ArchiveReader(const std::string& name)
+    : filename(name)
+    , FILE(name, std::ios::binary)
+{
+    if( ! FILE )    throw std::runtime_error("could not open file '" + filename + "'");
+    const std::uint64_t fileSize = std::filesystem::file_size(filename);
+
+    std::vector<char> block {};
+    std::uint32_t size {0};
+    if( ! readBlock(FILE, 0, fileSize, block, size) )   throw std::runtime_error("missing header in file '" + filename + "'");
+    XdrFile reader {};
+    reader.assign( filename, std::move(block) );
+    if( reader.readString() != MAGIC )  throw std::runtime_error("'" + filename + "' is not a rs@md archive");
+    if( reader.readInt() != VERSION )   throw std::runtime_error("unsupported version of archive '" + filename + "'");
+    end = 4 + size;
+
+    // index via trailer
+    if( fileSize >= end + TRAILER_SIZE )
+    {
+        std::vector<char> trailer (TRAILER_SIZE);
+        FILE.seekg( fileSize - TRAILER_SIZE );
+        FILE.read( trailer.data(), trailer.size() );
+        reader.assign( filename, std::move(trailer) );
+        const auto offset = static_cast<std::uint64_t>( reader.readInt64() );
+        if( reader.readUInt() == TRAILER_MAGIC && offset >= end && readBlock(FILE, offset, fileSize - TRAILER_SIZE, block, size) )
+        {
+            reader.assign( filename, std::move(block) );
+            if( reader.readString() == INDEX_MAGIC )
+            {
+                index.resize( reader.readUInt() );
+                for( auto& entry: index )
+                {
+                    entry.first = reader.readString();
+                    entry.second = static_cast<std::uint64_t>( reader.readInt64() );
+                }
+                end = offset;
+            }
+        }
+    }
+
+    // no (valid) index: read all block headers
+    if( index.empty() )
+    {
+        std::uint64_t position = end;
+        while( readBlock(FILE, position, fileSize, block, size, 1024) )
+        {
+            reader.assign( filename, std::move(block) );
+            const auto entry = reader.readString();
+            if( entry == INDEX_MAGIC )  break;
+            index.emplace_back( entry, position );
+            position += 4 + size;
+        }
+        end = position;
+    }
+
+    for( std::size_t i=0; i<index.size(); ++i )     positions[index[i].first] = i;
+}
+
+
+
+std::vector<std::string> ArchiveReader::getNames() const
+{
+    std::vector<std::string> names {};
+    names.reserve( index.size() );
+    for( const auto& entry: index )     names.push_back( entry.first );
+    return names;
+}
+
+
+
+//
+// read (and decompress) the stored content of an archived file
+//
+std::string ArchiveReader::read(const std::string& name, ARCHIVE_CODEC& codec)
+{
+    auto it = positions.find( name );
+    if( it == positions.end() )     throw std::runtime_error("no file '" + name + "' in archive '" + filename + "'");
+
+    std::vector<char> block {};
+    std::uint32_t size {0};
+    if( ! readBlock(FILE, index[it->second].second, end, block, size) )     throw std::runtime_error("truncated file '" + name + "' in archive '" + filename + "'");
+    XdrFile reader {};
+    reader.assign( filename, std::move(block) );
+    reader.readString();
+    codec = static_cast<ARCHIVE_CODEC>( reader.readInt() );
+    const std::size_t originalSize = reader.readUInt();
+    auto payload = reader.readString();
+
+    switch( codec )
+    {
+        case ARCHIVE_CODEC::RAW:        return payload;
+        case ARCHIVE_CODEC::ZLIB:       return decompress( payload, originalSize, name );
+        case ARCHIVE_CODEC::TOP_DELTA:  return payload;
+    }
+    throw std::runtime_error("unknown codec of file '" + name + "' in archive '" + filename + "'");
+}
+
+
+
+//
+// content of an archived file
+//
+std::string ArchiveReader::extract(const std::string& name)
+{
+    ARCHIVE_CODEC codec {ARCHIVE_CODEC::RAW};
+    auto content = read( name, codec );
+    if( codec == ARCHIVE_CODEC::TOP_DELTA )
+    {
+        const auto base = extract( "0.top" );
+        content.insert( 0, base, 0, archive::topologyPrefixLength(base) );
+    }
+    return content;
+}
@@ -0,0 +1,122 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "parser/xdrFile.hpp"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <unordered_map>
+
+//
+// archive of per-cycle files (simulation.archive)
+//
+// a single append-only file in XDR format (big endian) of size-prefixed blocks (uint: # bytes of the block),
+// starting with a header
+//   string   "rsmd-archive"
+//   int      format version
+// followed by one block per archived file
+//   string   file name, e.g. "12.top", "12-rs.gro"
+//   int      codec (see ARCHIVE_CODEC)
+//   uint     size of the original file
+//   opaque   (compressed) content
+// and, if the archive was closed properly, an index block + trailer
+//   string   "rsmd-archive-index"
+//   uint n   + n times: string file name, int64 offset of its block
+//   int64    offset of the index block (trailer, not size-prefixed)
+//   uint     0x52534d49 ("RSMI")
+//
+// .top files are stored as the part after the [ molecules ] directive (codec TOP_DELTA) if everything
+// before it is identical to 0.top, all other files are compressed with zlib (if available)
+//
+// without a valid trailer (e.g. after a killed run) the index is rebuilt by reading all block headers,
+// a truncated block at the end is removed before appending to the archive
+//
+
+enum class ARCHIVE_CODEC : int { RAW, ZLIB, TOP_DELTA };
+
+
+class ArchiveWriter
+{
+  private:
+    std::string   filename {};
+    std::ofstream FILE {};
+    std::uint64_t position {0};
+    std::vector<std::pair<std::string, std::uint64_t>> index {};
+    std::string   topologyPrefix {};    // of 0.top
+
+  public:
+    //
+    // open the archive, create a new one or append to an existing one
+    //
+    void open(const std::string&, bool);
+
+    //
+    // add a file to the archive
+    //
+    void add(const std::string&, const std::string&);
+
+    //
+    // write the index and close the archive
+    //
+    void close();
+
+    inline bool isOpen() const { return FILE.is_open(); }
+};
+
+
+
+class ArchiveReader
+{
+  private:
+    std::string   filename {};
+    std::ifstream FILE {};
+    std::vector<std::pair<std::string, std::uint64_t>> index {};
+    std::unordered_map<std::string, std::size_t>       positions {};
+    std::uint64_t end {0};      // position after the last complete file block
+
+    std::string read(const std::string&, ARCHIVE_CODEC&);
+
+  public:
+    explicit ArchiveReader(const std::string&);
+
+    //
+    // names of all archived files (in the order they were added)
+    //
+    std::vector<std::string> getNames() const;
+    inline bool contains(const std::string& name) const { return positions.count(name) > 0; }
+    inline std::uint64_t getEnd() const { return end; }
+    inline const auto& getIndex() const { return index; }
+
+    //
+    // content of an archived file
+    //
+    std::string extract(const std::string&);
+};
+
+
+
+namespace archive
+{
+    //
+    // length of the part of a .top file up to (and including) the [ molecules ] directive,
+    // 0 if there is no such directive
+    //
+    std::size_t topologyPrefixLength(const std::string&);
+
+    //
+    // whether the content of archived files is compressed with zlib
+    //
+    bool compressionAvailable();
+}
@@ -41,6 +41,7 @@ void Controller::signal( int SIG )
     else if( gotCalled == 3 )
     {
         rsmdLOG( "Received signal " << SIG << " ... IMMEDIATE SHUTDOWN!" );
+        enhance::Log.flush();
         std::exit( SIG );
     }
 
@@ -58,6 +59,21 @@ void Controller::setup( int argc, char* argv[] )
     start_time = std::chrono::system_clock::now();
     std::time_t t1 = std::chrono::system_clock::to_time_t(start_time);
     parameters = std::make_unique<Parameters>(argc, argv);
+
+    // setup logging
+    if( ! parameters->getOption("log.level").as<std::string>().empty() )
+    {
+        enhance::Log.setLevel( parameters->getOption("log.level").as<std::string>() );
+    }
+    for( std::size_t i=0; i<enhance::LOGSUBSYSTEM_NAMES.size(); ++i )
+    {
+        const auto& level = parameters->getOption("log." + std::string(enhance::LOGSUBSYSTEM_NAMES[i])).as<std::string>();
+        if( ! level.empty() )   enhance::Log.setLevel( static_cast<enhance::LOGSUBSYSTEM>(i), level );
+    }
+    if( parameters->getOption("log.async").as<bool>() )
+    {
+        enhance::Log.startAsync( parameters->getOption("log.buffer").as<std::size_t>() );
+    }
     
     // log program options
     std::cout << "  [LOG]  " << "entering program rs@md, " << std::put_time( std::localtime(&t1), "%F %T" ) << '\n';
@@ -75,6 +91,11 @@ void Controller::setup( int argc, char* argv[] )
             simulator = std::make_unique<SimulatorRate>();
             assert(simulator);
             break;
+
+        case SIMALGORITHM::KMC:
+            simulator = std::make_unique<SimulatorKMC>();
+            assert(simulator);
+            break;
     }
     simulator->setup(*parameters);
 
@@ -98,6 +119,11 @@ void Controller::start()
 //
 void Controller::stop()
 {
+    enhance::Log.flush();
+
+    // move everything from the scratch directory to the persistent directory
+    simulator->flush();
+
     // cleanup if required, write restart files if execution has been interrupted in a civilised manner (via SIGUSR1) etc. 
     if( CIVILISED_SHUTDOWN.load() )
     {
@@ -112,6 +138,9 @@ void Controller::stop()
     
     // finish up
     simulator->finish();
+    simulator->printTimings();
+    simulator->printRelaxationLengths();
+    enhance::Log.stopAsync();
 
     // compute total run time
     end_time = std::chrono::system_clock::now();
@@ -21,6 +21,7 @@
 #include "definitions.hpp"
 #include "control/simulatorMetropolis.hpp"
 #include "control/simulatorRate.hpp"
+#include "control/simulatorKMC.hpp"
 
 #include <csignal>
 
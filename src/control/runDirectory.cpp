@@ -0,0 +1,279 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "control/runDirectory.hpp"
+
+#include <unistd.h>
+#include <cctype>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+
+
+//
+// stop archiver thread
+//
+RunDirectory::~RunDirectory()
+{
+    if( archiver.joinable() )
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopArchiver = true;
+        }
+        condition.notify_all();
+        archiver.join();
+    }
+}
+
+
+
+//
+// create scratch directory in given base directory, open the archive and start archiver thread
+//
+void RunDirectory::setup(const std::string& scratchBase, const std::string& archiveName, bool append)
+{
+    persistentPath = std::filesystem::current_path();
+
+    if( ! archiveName.empty() )
+    {
+        useArchive = true;
+        archiveWriter.open( (persistentPath / archiveName).string(), append );
+        rsmdLOG( "... adding per-cycle .top/.gro/.ndx files to archive " << persistentPath / archiveName 
+                 << ( archive::compressionAvailable() ? "" : " (uncompressed, built without zlib)" ) );
+    }
+
+    if( ! scratchBase.empty() )
+    {
+        useScratch = true;
+        scratchPath = std::filesystem::absolute(scratchBase) / ("rsmd-" + std::to_string(getpid()));
+        std::filesystem::create_directories(scratchPath);
+        rsmdLOG( "... using scratch directory " << scratchPath );
+    }
+
+    if( useScratch || useArchive )  archiver = std::thread( &RunDirectory::archiverLoop, this );
+}
+
+
+
+//
+// copy the files of the given cycle to the scratch directory,
+// link all other files and change the working directory to the scratch directory
+//
+void RunDirectory::enter(const std::size_t& cycle)
+{
+    if( ! useScratch )  return;
+
+    const std::string scratch = scratchPath.string();
+    for( const auto& entry: std::filesystem::directory_iterator(persistentPath) )
+    {
+        const std::string name = entry.path().filename().string();
+
+        // skip the scratch directory itself (or any of its parents)
+        if( scratch.compare(0, entry.path().string().size()+1, entry.path().string()+"/") == 0 )   continue;
+
+        std::size_t key {0};
+        if( cycleKey(name, key) )
+        {
+            // per-cycle files of other cycles are not required (and must not be overwritten via a link)
+            if( key != cycle )  continue;
+            rsmdDEBUG( "... copying " << entry.path() << " to scratch directory" );
+            std::filesystem::copy_file( entry.path(), scratchPath/name, std::filesystem::copy_options::overwrite_existing );
+        }
+        else if( ! std::filesystem::exists(scratchPath/name) )
+        {
+            // e.g. included .itp files and force field directories
+            std::filesystem::create_symlink( entry.path(), scratchPath/name );
+        }
+    }
+
+    std::filesystem::current_path(scratchPath);
+}
+
+
+
+//
+// schedule archival of all files from cycles before the given cycle
+// and of saved files from rejected reactive steps
+//
+void RunDirectory::archive(const std::size_t& cycle)
+{
+    if( ! useScratch && ! useArchive )  return;
+
+    enqueue( [this, cycle]()
+    {
+        moveFiles( [cycle](const std::filesystem::directory_entry& entry)
+        {
+            const std::string name = entry.path().filename().string();
+            std::size_t key {0};
+            return ( cycleKey(name, key) && key < cycle ) || name.rfind("rejected-", 0) == 0;
+        }, cycle );
+    } );
+}
+
+
+
+//
+// archive everything synchronously, change the working directory back
+// to the persistent directory and remove the scratch directory
+//
+void RunDirectory::flush()
+{
+    if( ! useScratch && ! useArchive )  return;
+
+    if( useScratch )
+    {
+        rsmdLOG( "... moving all files from scratch directory " << scratchPath << " to " << persistentPath );
+        enqueue( [this]()
+        {
+            moveFiles( [](const std::filesystem::directory_entry&){ return true; }, 0 );
+        } );
+    }
+    wait();
+
+    if( useArchive )
+    {
+        archiveWriter.close();
+        useArchive = false;
+    }
+    if( ! useScratch )  return;
+
+    std::filesystem::current_path(persistentPath);
+    std::error_code error {};
+    std::filesystem::remove_all(scratchPath, error);
+    if( error ) rsmdWARNING( "   could not remove scratch directory " << scratchPath << ": " << error.message() );
+    useScratch = false;
+}
+
+
+
+//
+// get numeric key of a per-cycle file, i.e. 'N.xxx' or 'N-xxx'
+//
+bool RunDirectory::cycleKey(const std::string& name, std::size_t& key)
+{
+    std::size_t pos = 0;
+    while( pos < name.size() && std::isdigit(static_cast<unsigned char>(name[pos])) ) ++pos;
+    if( pos == 0 || pos == name.size() || (name[pos] != '.' && name[pos] != '-') )  return false;
+
+    key = std::stoul( name.substr(0, pos) );
+    return true;
+}
+
+
+
+//
+// move all regular files in the working directory that match the predicate to the persistent directory
+// (rename if possible, else copy + remove, e.g. between different filesystems),
+// respectively add .top/.gro/.ndx files of cycles before the given cycle to the archive
+//
+void RunDirectory::moveFiles(const std::function<bool(const std::filesystem::directory_entry&)>& predicate, const std::size_t& cycle)
+{
+    std::vector<std::filesystem::path> files {};
+    for( const auto& entry: std::filesystem::directory_iterator(getWorkingPath()) )
+    {
+        if( entry.is_symlink() || ! entry.is_regular_file() )   continue;
+        if( predicate(entry) )  files.emplace_back( entry.path() );
+    }
+    // (in order of the cycles, such that 0.top is archived first)
+    std::sort( files.begin(), files.end(), [](const auto& lhs, const auto& rhs)
+    {
+        std::size_t keyLhs {0}, keyRhs {0};
+        const bool hasLhs = cycleKey( lhs.filename().string(), keyLhs );
+        const bool hasRhs = cycleKey( rhs.filename().string(), keyRhs );
+        return std::make_tuple( ! hasLhs, keyLhs, lhs.filename() ) < std::make_tuple( ! hasRhs, keyRhs, rhs.filename() );
+    } );
+
+    for( const auto& file: files )
+    {
+        const std::string name = file.filename().string();
+        const auto extension = file.extension();
+        std::size_t key {0};
+        if( useArchive && cycleKey(name, key) && key < cycle && (extension == ".top" || extension == ".gro" || extension == ".ndx") )
+        {
+            try
+            {
+                archiveWriter.add( name, file.string() );
+                std::filesystem::remove( file );
+            }
+            catch(const std::exception& e)
+            {
+                rsmdWARNING( "   caught exception while trying to add " << file << " to the archive: " << e.what() );
+            }
+            continue;
+        }
+        if( ! useScratch )  continue;
+
+        const auto target = persistentPath / file.filename();
+        try
+        {
+            std::error_code error {};
+            std::filesystem::rename( file, target, error );
+            if( error )
+            {
+                std::filesystem::copy_file( file, target, std::filesystem::copy_options::overwrite_existing );
+                std::filesystem::remove( file );
+            }
+        }
+        catch(const std::exception& e)
+        {
+            rsmdWARNING( "   caught exception while trying to archive " << file << ": " << e.what() );
+        }
+    }
+}
+
+
+
+//
+// the archiver thread: run jobs until asked to stop
+//
+void RunDirectory::archiverLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while( true )
+    {
+        condition.wait( lock, [this](){ return stopArchiver || ! jobs.empty(); } );
+        if( jobs.empty() && stopArchiver ) break;
+
+        auto job = std::move( jobs.front() );
+        jobs.pop_front();
+        busy = true;
+        lock.unlock();
+
+        job();
+
+        lock.lock();
+        busy = false;
+        condition.notify_all();
+    }
+}
+
+
+
+void RunDirectory::enqueue(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.emplace_back( std::move(job) );
+    }
+    condition.notify_all();
+}
+
+
+
+//
+// wait until all scheduled jobs are done
+//
+void RunDirectory::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait( lock, [this](){ return jobs.empty() && ! busy; } );
+}
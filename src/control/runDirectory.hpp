@@ -0,0 +1,102 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+#include "control/archive.hpp"
+
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <filesystem>
+
+//
+// the run directory of a simulation
+//
+// optionally, all per-cycle files are written to a (fast, local) scratch directory,
+// files that are not required anymore are then moved to the persistent directory
+// asynchronously by a background archiver thread
+//
+// per-cycle files are recognised by their numeric key, i.e. 'N.top', 'N-md.xtc', 'N.reactants.ndx' etc.,
+// files from rejected reactive steps that are saved are named 'rejected-N...'
+//
+// optionally (simulation.archive), .top/.gro/.ndx files that are not required anymore are added to
+// a single archive file in the persistent directory by the archiver thread and removed
+// (see archive.hpp, extract with rsmd-archive)
+//
+
+class RunDirectory
+{
+  private:
+    std::filesystem::path persistentPath {};
+    std::filesystem::path scratchPath {};
+    bool useScratch {false};
+    bool useArchive {false};
+    ArchiveWriter archiveWriter {};
+
+    // background archiver
+    std::thread                       archiver {};
+    std::mutex                        mutex {};
+    std::condition_variable           condition {};
+    std::deque<std::function<void()>> jobs {};
+    bool                              busy {false};
+    bool                              stopArchiver {false};
+
+    void archiverLoop();
+    void enqueue(std::function<void()>);
+    void wait();
+    void moveFiles(const std::function<bool(const std::filesystem::directory_entry&)>&, const std::size_t&);
+    inline const auto& getWorkingPath() const { return useScratch ? scratchPath : persistentPath; }
+
+  public:
+    RunDirectory() = default;
+    ~RunDirectory();
+
+    RunDirectory(const RunDirectory&) = delete;
+    RunDirectory& operator=(const RunDirectory&) = delete;
+
+    //
+    // create scratch directory in given base directory, open the archive and start archiver thread
+    // (an empty base directory means: work in the persistent directory, an empty archive name: no archive)
+    //
+    void setup(const std::string&, const std::string&, bool);
+
+    //
+    // copy the files of the given cycle to the scratch directory,
+    // link all other files and change the working directory to the scratch directory
+    //
+    void enter(const std::size_t&);
+
+    //
+    // schedule archival of all files from cycles before the given cycle
+    // and of saved files from rejected reactive steps
+    // (i.e. moving them to the persistent directory and/or adding them to the archive)
+    //
+    void archive(const std::size_t&);
+
+    //
+    // archive everything synchronously, change the working directory back
+    // to the persistent directory and remove the scratch directory, close the archive
+    //
+    void flush();
+
+    //
+    // get numeric key of a per-cycle file, returns false if the file has none
+    //
+    static bool cycleKey(const std::string&, std::size_t&);
+
+    inline const auto& getPersistentPath() const { return persistentPath; }
+    inline const auto& getScratchPath()    const { return scratchPath; }
+};
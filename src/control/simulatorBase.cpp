@@ -29,6 +29,12 @@ void SimulatorBase::setup(const Parameters& parameters)
         rsmdLOG( "... using (true) random seed " << enhance::RandomEngine.getSeed() );
     }
 
+    // ... of the timing instrumentation
+    timing = parameters.getOption("simulation.timing").as<bool>();
+    adaptiveRelaxation = ( parameters.getEngineType() == ENGINE::GROMACS && parameters.getOption("gromacs.relaxationExtensions").as<std::size_t>() > 0 );
+    enhance::Timings.enable( timing );
+    if( parameters.getOption("reaction.delayedAcceptance").as<bool>() )     timedPhases.push_back( "prescreening" );
+
     // ... of the mdEngine and energyParser
     switch( parameters.getEngineType() )
     {
@@ -39,12 +45,29 @@ void SimulatorBase::setup(const Parameters& parameters)
             assert(energyParser);
             mdEngine->setup(parameters);
             energyParser->setup(parameters);
+            mdEngine->setEnergyCache(energyCache);
+            energyParser->setEnergyCache(energyCache);
 
             unitSystem = std::make_unique<UnitSystem>("nm", "ps", "kJ/mol", "K");
             assert(unitSystem);
             
             break;
 
+        case ENGINE::MOCK:
+            mdEngine = std::make_unique<EngineMock>();
+            energyParser = std::make_unique<EnergyParserGMX>();
+            assert(mdEngine);
+            assert(energyParser);
+            mdEngine->setup(parameters);
+            energyParser->setup(parameters);
+            mdEngine->setEnergyCache(energyCache);
+            energyParser->setEnergyCache(energyCache);
+
+            unitSystem = std::make_unique<UnitSystem>("nm", "ps", "kJ/mol", "K");
+            assert(unitSystem);
+
+            break;
+
         case ENGINE::NONE:
             rsmdCRITICAL( "md engine is set to none" );
             break;
@@ -59,29 +82,42 @@ void SimulatorBase::setup(const Parameters& parameters)
     {
         case SIMMODE::NEW:
             rsmdLOG( "... will start a new simulation from cycle = 0" );
-            // ... statistics file
-            if( parameters.getOption("statistics").as<std::string>() != "" )
-            {
-                STATISTICS_FILE.open( parameters.getOption("statistics").as<std::string>() );
-                if( ! STATISTICS_FILE )
-                {   // safety check
-                    rsmdCRITICAL( "opening file " << parameters.getOption("statistics").as<std::string>() << " failed.")
-                } 
-            }
             break;
         
         case SIMMODE::RESTART:
             lastReactiveCycle = parameters.getOption("simulation.restartCycleFiles").as<std::size_t>();
             currentCycle = parameters.getOption("simulation.restartCycle").as<std::size_t>();
             rsmdLOG( "... will restart simulation from cycle = " << currentCycle );
-            // ... statistics file
-            STATISTICS_FILE.open( parameters.getOption("statistics").as<std::string>(), std::ostream::app );
-            if( ! STATISTICS_FILE )
-            {   // safety check
-                rsmdCRITICAL( "opening file " << parameters.getOption("statistics").as<std::string>() << " failed.")
-            } 
             break;
     }
+
+    // ... statistics file (appended to if restarting)
+    for( const auto& reaction: universe.getReactionTemplates() )
+    {
+        if( reactionIndices.try_emplace( reaction.getName(), static_cast<int>(reactionNames.size()) ).second )
+            reactionNames.push_back( reaction.getName() );
+    }
+    const auto& statisticsFilename = parameters.getOption("statistics").as<std::string>();
+    const bool append = ( parameters.getSimulationMode() == SIMMODE::RESTART );
+    writeStatistics = ! statisticsFilename.empty();
+    binaryStatistics = ( parameters.getOption("statisticsFormat").as<std::string>() == "binary" );
+    if( writeStatistics && binaryStatistics )
+    {
+        STATISTICS_BINARY.open( statisticsFilename, reactionNames, ( timing ? timedPhases : std::vector<std::string>{} ), append );
+    }
+    else if( writeStatistics )
+    {
+        STATISTICS_FILE.open( statisticsFilename, ( append ? std::ostream::app : std::ostream::trunc ) );
+        if( ! STATISTICS_FILE )
+        {   // safety check
+            rsmdCRITICAL( "opening file " << statisticsFilename << " failed.")
+        } 
+    }
+
+    // ... of the run directory
+    // (from here on, all per-cycle files are written to the scratch directory if requested)
+    runDirectory.setup( parameters.getOption("simulation.scratch").as<std::string>(), parameters.getOption("simulation.archive").as<std::string>(), append );
+    runDirectory.enter( lastReactiveCycle );
 }
 
 
@@ -95,8 +131,10 @@ void SimulatorBase::run()
     if( currentCycle == 1 )
     {
         rsmdLOG("@ cycle 0 (initial md sequence)");
+        enhance::ScopedTimer timer ("md");
         mdEngine->runMDInitial();
     }
+    enhance::Timings.nextCycle();
 
     while( currentCycle <= nCycles )
     {
@@ -110,11 +148,20 @@ void SimulatorBase::run()
         reactiveStep();
         
         // check for signals
-        if( Controller::SIGNAL.load() != 0 && ! Controller::CIVILISED_SHUTDOWN.load() ) break;
+        if( Controller::SIGNAL.load() != 0 && ! Controller::CIVILISED_SHUTDOWN.load() )
+        {
+            endStatisticsLine();
+            break;
+        }
 
         // do md sequence
         mdSequence();
 
+        // archive files that are not required anymore
+        runDirectory.archive( lastReactiveCycle );
+
+        endStatisticsLine();
+
         ++ currentCycle;
         ++ nCyclesCompleted;
         
@@ -129,6 +176,7 @@ void SimulatorBase::run()
 //
 void SimulatorBase::mdSequence()
 {
+    enhance::ScopedTimer timer ("md");
     if( lastReactiveCycle == currentCycle )
     {
         mdEngine->runMD(currentCycle);
@@ -141,6 +189,126 @@ void SimulatorBase::mdSequence()
 
 
 
+//
+// relaxation of the current cycle
+// (keeps track of the length of adapted relaxations for the statistics)
+//
+bool SimulatorBase::relax()
+{
+    const bool status = mdEngine->runRelaxation(currentCycle);
+    statisticsRecord.relaxationLength = mdEngine->getRelaxationLength();
+    if( status && ! std::isnan(statisticsRecord.relaxationLength) )     ++ relaxationLengths[statisticsRecord.relaxationLength];
+    return status;
+}
+
+
+
+//
+// write the header of the statistics file
+// (text only, the binary header is written when opening the file)
+//
+void SimulatorBase::writeStatisticsHeader()
+{
+    if( ! writeStatistics || binaryStatistics )     return;
+
+    writeStatisticsHeaderText();
+    if( adaptiveRelaxation )    STATISTICS_FILE << std::setw(16) << "relaxation/ps";
+    if( timing )
+    {
+        for( const auto& phase: timedPhases )   STATISTICS_FILE << std::setw(24) << ("t_" + phase + "/ms");
+    }
+    STATISTICS_FILE << '\n' << std::flush;
+}
+
+
+
+//
+// start a new line of the statistics file
+// (count candidates per reaction template)
+//
+void SimulatorBase::beginStatisticsLine(const std::vector<ReactionCandidate>& candidates)
+{
+    statisticsRecord.reset( static_cast<std::int64_t>(currentCycle), reactionNames.size() );
+    statisticsRecord.nCandidates = candidates.size();
+    for( const auto& candidate: candidates )    ++ statisticsRecord.candidates[ reactionIndex(candidate) ];
+}
+
+
+
+//
+// finish the line of the statistics file
+// (with the time spent in each phase if requested)
+//
+void SimulatorBase::endStatisticsLine()
+{
+    if( timing )
+    {
+        for( const auto& phase: timedPhases )   statisticsRecord.timings.push_back( 1000 * enhance::Timings.getCycleTotal(phase) );
+        enhance::Timings.nextCycle();
+    }
+    if( ! writeStatistics )     return;
+
+    if( binaryStatistics )
+    {
+        STATISTICS_BINARY.write( statisticsRecord );
+    }
+    else
+    {
+        writeStatisticsLineText();
+        STATISTICS_FILE << std::fixed << std::setprecision(3);
+        if( adaptiveRelaxation )    STATISTICS_FILE << std::setw(16) << statisticsRecord.relaxationLength;
+        for( const auto& value: statisticsRecord.timings )  STATISTICS_FILE << std::setw(24) << value;
+        STATISTICS_FILE << std::defaultfloat;
+        STATISTICS_FILE << '\n' << std::flush;
+    }
+}
+
+
+
+//
+// print a summary of the timings
+//
+void SimulatorBase::printTimings() const
+{
+    if( ! timing )  return;
+    rsmdLOG( "time spent per phase:" );
+    std::stringstream summary ( enhance::Timings.summary() );
+    std::string line {};
+    while( std::getline(summary, line) )    rsmdLOG( "   " << line );
+}
+
+
+
+//
+// print the distribution of the lengths of adapted relaxations
+//
+void SimulatorBase::printRelaxationLengths() const
+{
+    if( relaxationLengths.empty() )     return;
+    std::size_t n {0};
+    double total {0};
+    for( const auto& [length, count]: relaxationLengths )
+    {
+        n += count;
+        total += length * count;
+    }
+    rsmdLOG( "relaxation lengths (" << n << " relaxations, mean " << total / n << " ps):" );
+    for( const auto& [length, count]: relaxationLengths )   rsmdLOG( "   " << std::setw(10) << length << " ps: " << count );
+}
+
+
+
+//
+// let the md engine clean up and move all files to the persistent directory
+//
+void SimulatorBase::flush()
+{
+    if( mdEngine )  mdEngine->finish();
+    runDirectory.flush();
+}
+
+
+
 //
 // write a restart file
 //
@@ -155,6 +323,11 @@ void SimulatorBase::writeRestartFile(const Parameters& parameters) const
         rsmdLOG( "... writing program options for restarting to " << parameters.getOption("output").as<std::string>() );
     } 
 
+    // general options
+    FILE << "statistics  = " << parameters.getOption("statistics").as<std::string>() << '\n';
+    FILE << "statisticsFormat = " << parameters.getOption("statisticsFormat").as<std::string>() << '\n';
+    FILE << '\n';
+
     // [simulation]
     FILE << "[simulation]\n";
     FILE << "engine      = " << parameters.getOption("simulation.engine").as<std::string>() << '\n';
@@ -162,6 +335,14 @@ void SimulatorBase::writeRestartFile(const Parameters& parameters) const
     FILE << "restart     = " << "on" << '\n';
     FILE << "restartCycle = " << currentCycle << '\n';
     FILE << "restartCycleFiles = " << lastReactiveCycle << '\n';
+    if( ! parameters.getOption("simulation.scratch").as<std::string>().empty() )
+        FILE << "scratch     = " << parameters.getOption("simulation.scratch").as<std::string>() << '\n';
+    if( ! parameters.getOption("simulation.archive").as<std::string>().empty() )
+        FILE << "archive     = " << parameters.getOption("simulation.archive").as<std::string>() << '\n';
+    if( parameters.getOption("simulation.timing").as<bool>() )
+        FILE << "timing      = on" << '\n';
+    if( ! parameters.getOption("simulation.worker").as<std::string>().empty() )
+        FILE << "worker      = " << parameters.getOption("simulation.worker").as<std::string>() << '\n';
     FILE << '\n';
 
     // [reaction]
@@ -170,16 +351,18 @@ void SimulatorBase::writeRestartFile(const Parameters& parameters) const
         FILE << "file        = " << filename << '\n';
     FILE << "mc          = " << (parameters.getOption("reaction.mc").as<bool>() ? "on" : "off") << '\n';
     FILE << "rate        = " << (parameters.getOption("reaction.rate").as<bool>() ? "on" : "off") << '\n';
+    FILE << "kmc         = " << (parameters.getOption("reaction.kmc").as<bool>() ? "on" : "off") << '\n';
     if( parameters.getOption("reaction.rate").as<bool>() )
     {
         FILE << "frequency   = " << parameters.getOption("reaction.frequency").as<REAL>() << '\n';
     }
-    else
+    else if( parameters.getOption("reaction.mc").as<bool>() )
     {
         FILE << "temperature = " << parameters.getOption("reaction.temperature").as<REAL>() << '\n';
         FILE << "averagePotentialEnergy = " << parameters.getOption("reaction.averagePotentialEnergy").as<REAL>() << '\n';
         FILE << "computeLocalPotentialEnergy = " << (parameters.getOption("reaction.computeLocalPotentialEnergy").as<bool>() ? "on" : "off" ) << '\n';
         FILE << "computeSolvationPotentialEnergy = " << (parameters.getOption("reaction.computeSolvationPotentialEnergy").as<bool>() ? "on" : "off" ) << '\n';
+        FILE << "delayedAcceptance = " << (parameters.getOption("reaction.delayedAcceptance").as<bool>() ? "on" : "off" ) << '\n';
     }
     FILE << "saveRejected = " << (parameters.getOption("reaction.saveRejected").as<bool>() ? "on" : "off") << '\n';
     FILE << '\n';
@@ -199,11 +382,48 @@ void SimulatorBase::writeRestartFile(const Parameters& parameters) const
             FILE << "nt           = " << parameters.getOption("gromacs.nt").as<int>() << '\n';
             FILE << "ntmpi        = " << parameters.getOption("gromacs.ntmpi").as<int>() << '\n';
             FILE << "ntomp        = " << parameters.getOption("gromacs.ntomp").as<int>() << '\n';
+            FILE << "edr          = " << (parameters.getOption("gromacs.edr").as<bool>() ? "on" : "off") << '\n';
+            FILE << "trr          = " << (parameters.getOption("gromacs.trr").as<bool>() ? "on" : "off") << '\n';
+            FILE << "nativeSubsets = " << (parameters.getOption("gromacs.nativeSubsets").as<bool>() ? "on" : "off") << '\n';
+            FILE << "pipeline     = " << (parameters.getOption("gromacs.pipeline").as<bool>() ? "on" : "off") << '\n';
+            FILE << "gromppCache  = " << parameters.getOption("gromacs.gromppCache").as<std::size_t>() << '\n';
+            FILE << "relaxationRadius = " << parameters.getOption("gromacs.relaxationRadius").as<REAL>() << '\n';
+            FILE << "relaxationExtensions = " << parameters.getOption("gromacs.relaxationExtensions").as<std::size_t>() << '\n';
+            FILE << "relaxationTolerance = " << parameters.getOption("gromacs.relaxationTolerance").as<REAL>() << '\n';
+            break;
+
+        case ENGINE::MOCK:
+            FILE << "[gromacs]\n";
+            FILE << "topology     = " << std::to_string(lastReactiveCycle) + ".top" << '\n'; 
+            FILE << "coordinates  = " << std::to_string(lastReactiveCycle) + "-md.gro" << '\n';
+            FILE << "edr          = " << (parameters.getOption("gromacs.edr").as<bool>() ? "on" : "off") << '\n';
+            FILE << "trr          = " << (parameters.getOption("gromacs.trr").as<bool>() ? "on" : "off") << '\n';
+            FILE << "relaxationRadius = " << parameters.getOption("gromacs.relaxationRadius").as<REAL>() << '\n';
+            FILE << '\n';
+            FILE << "[mock]\n";
+            FILE << "latency      = " << parameters.getOption("mock.latency").as<REAL>() << '\n';
+            FILE << "displacement = " << parameters.getOption("mock.displacement").as<REAL>() << '\n';
+            FILE << "noise        = " << parameters.getOption("mock.noise").as<REAL>() << '\n';
             break;
 
         case ENGINE::NONE:
             break;
     }
 
+    // [log]
+    std::stringstream logSection {};
+    if( ! parameters.getOption("log.level").as<std::string>().empty() )
+        logSection << "level        = " << parameters.getOption("log.level").as<std::string>() << '\n';
+    for( const auto& subsystem: enhance::LOGSUBSYSTEM_NAMES )
+    {
+        const auto& level = parameters.getOption("log." + std::string(subsystem)).as<std::string>();
+        if( ! level.empty() )   logSection << std::setw(13) << std::left << subsystem << "= " << level << '\n';
+    }
+    if( parameters.getOption("log.async").as<bool>() )
+        logSection << "async        = on" << '\n'
+                   << "buffer       = " << parameters.getOption("log.buffer").as<std::size_t>() << '\n';
+    if( ! logSection.str().empty() )
+        FILE << '\n' << "[log]\n" << logSection.str();
+
     FILE.close();
 }
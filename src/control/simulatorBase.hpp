@@ -15,9 +15,15 @@
 #include "unitSystem.hpp"
 #include "parameters/parameters.hpp"
 #include "container/universe.hpp"
+#include "control/runDirectory.hpp"
+#include "control/statistics.hpp"
 #include "engine/engineGMX.hpp"
+#include "engine/engineMock.hpp"
 #include "parser/energyParserGMX.hpp"
 
+#include <unordered_map>
+#include <map>
+
 //
 // SimulatorBase class
 // 
@@ -29,25 +35,49 @@ class SimulatorBase
 {
   protected:
     Universe                          universe {};
+    RunDirectory                      runDirectory {};
     std::unique_ptr<EngineBase>       mdEngine      {nullptr};
     std::unique_ptr<EnergyParserBase> energyParser  {nullptr};
+    std::shared_ptr<EnergyCache>      energyCache   {std::make_shared<EnergyCache>()};     // shared by mdEngine and energyParser
     
     std::size_t currentCycle {1};
     std::size_t lastReactiveCycle {0};
     std::size_t nCycles {0};
     std::size_t nCyclesCompleted {0};
 
-    bool          writeStatistics {false};
-    std::ofstream STATISTICS_FILE {};
+    bool             writeStatistics {false};
+    bool             binaryStatistics {false};
+    std::ofstream    STATISTICS_FILE {};
+    StatisticsWriter STATISTICS_BINARY {};
+    StatisticsRecord statisticsRecord {};
+    std::vector<std::string>             reactionNames {};     // reaction templates as numbered in the statistics
+    std::unordered_map<std::string, int> reactionIndices {};
+
+    // phases whose time per cycle is written to the statistics file (see simulation.timing),
+    // + "prescreening" if reaction.delayedAcceptance is set
+    bool timing {false};
+    std::vector<std::string> timedPhases { "update", "search", "react", "write", "relaxation", "energyComputation", 
+                                                 "energyParsing", "readRelaxed", "cleanup", "md" };
+
+    // lengths of adapted relaxations (see gromacs.relaxationExtensions): length (ps) -> # relaxations
+    bool adaptiveRelaxation {false};
+    std::map<double, std::size_t> relaxationLengths {};
 
     std::unique_ptr<UnitSystem>  unitSystem {nullptr}; 
 
     // some generally usable functions:
     void mdSequence();
+    bool relax();
+    void writeStatisticsHeader();
+    void beginStatisticsLine(const std::vector<ReactionCandidate>&);
+    void endStatisticsLine();
+    inline int reactionIndex(const ReactionCandidate& candidate) const { return reactionIndices.at(candidate.getName()); }
 
     // some functions that need to be implemented in derived:
     virtual void reactiveStep() = 0;
     virtual bool acceptance(const ReactionCandidate&) = 0;
+    virtual void writeStatisticsHeaderText() = 0;
+    virtual void writeStatisticsLineText() = 0;
 
     // make constructor protected to make the class purely virtual
     SimulatorBase() = default;
@@ -58,6 +88,9 @@ class SimulatorBase
     // some generally usable functions:
     void run();
     void writeRestartFile(const Parameters&) const;
+    void printTimings() const;
+    void printRelaxationLengths() const;
+    void flush();
 
     // some functions that need to be implemented in derived:
     virtual void setup(const Parameters&);
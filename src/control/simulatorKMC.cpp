@@ -0,0 +1,195 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "control/simulatorKMC.hpp"
+
+#include <cmath>
+#include <csignal>
+
+//
+// setup stuff specific to hybrid kinetic MC/MD simulation
+//
+void SimulatorKMC::setup(const Parameters& parameters)
+{
+    rsmdLOG( "setting up the simulation world ..." );
+
+    // setup general stuff
+    SimulatorBase::setup(parameters);
+
+    // setup specific stuff
+    mdLength = mdEngine->getMDLength();
+    if( ! (mdLength > 0) )
+    {
+        rsmdCRITICAL( "kinetic Monte Carlo requires md sequences of a positive length, got " << mdLength << " ps" );
+    }
+    rsmdLOG( "... every reactive step covers the " << mdLength << " ps of one md sequence" );
+
+    // check statistics file and write header
+    writeStatisticsHeader();
+
+    rsmdLOG( "... setup done, time to start the simulation!" );
+    rsmdLOG( std::flush << std::setprecision(3) );
+}
+
+
+
+//
+// do reactive step
+//
+void SimulatorKMC::reactiveStep()
+{
+    eventTime = 0;
+    totalRate = 0;
+
+    // search for candidates
+    universe.update(lastReactiveCycle);
+    auto candidates = universe.CellSearchReactionCandidates();
+    beginStatisticsLine(candidates);
+    if( candidates.empty() )
+    {
+        rsmdLOG( "...found no candidates" );
+        ++ nCyclesNoReaction;
+        return;
+    }
+
+    // rates of all candidates and candidates per reactant molecule
+    std::vector<double> candidateRates ( candidates.size(), 0 );
+    std::size_t highestMolID = 0;
+    for( std::size_t i=0; i<candidates.size(); ++i )
+    {
+        candidateRates[i] = candidates[i].getCurrentReactionRateValue();
+        for( const auto& reactant: candidates[i].getReactants() )   highestMolID = std::max( highestMolID, reactant.getID() );
+    }
+    std::vector<std::vector<std::size_t>> candidatesOfMolecule ( highestMolID + 1 );
+    for( std::size_t i=0; i<candidates.size(); ++i )
+    {
+        for( const auto& reactant: candidates[i].getReactants() )   candidatesOfMolecule[reactant.getID()].push_back( i );
+    }
+    rates.assign( candidateRates );
+    totalRate = rates.total();
+    rsmdLOG( "... found " << candidates.size() << " potential reaction candidates, total rate = " << totalRate << " 1/ps" );
+
+    // select events until the next one would happen after this reactive step
+    // (waiting times are memoryless, so the rest of the time span is simply discarded)
+    std::vector<std::reference_wrapper<ReactionCandidate>> acceptedCandidates {};
+    double time = 0;
+    for( double rate = totalRate; rate > 0; rate = rates.total() )
+    {
+        time -= std::log( 1.0 - enhance::random(0.0, 1.0) ) / rate;
+        if( time >= mdLength )  break;
+
+        const auto i = rates.find( enhance::random(0.0, 1.0) * rate );
+        auto& candidate = candidates[i];
+        eventTime = time;
+        acceptedCandidates.push_back( candidate );
+        ++ statisticsRecord.attempted[ reactionIndex(candidate) ];
+        ++ statisticsRecord.accepted[ reactionIndex(candidate) ];
+        statisticsRecord.entries.emplace_back();
+        statisticsRecord.entries.back().reaction = reactionIndex(candidate);
+        statisticsRecord.entries.back().accepted = true;
+        statisticsRecord.entries.back().criterion = rates.weight(i);
+        // (the reactive step of cycle c starts after c md sequences, i.e. at t = c * mdLength)
+        rsmdLOG( "... event at t = " << currentCycle * mdLength + time << " ps (rate " << rates.weight(i) << " 1/ps): " << candidate.shortInfo() );
+
+        // candidates that share a reactant with the reacted one are not available anymore
+        for( const auto& reactant: candidate.getReactants() )
+        {
+            for( const auto j: candidatesOfMolecule[reactant.getID()] )     rates.update( j, 0 );
+        }
+    }
+    nEvents += acceptedCandidates.size();
+    statisticsRecord.outcome = ( acceptedCandidates.empty() ? STATISTICS_OUTCOME::REJECTED : STATISTICS_OUTCOME::ACCEPTED );
+
+    if( acceptedCandidates.empty() )
+    {
+        rsmdLOG( "... no event within " << mdLength << " ps" );
+        ++ nCyclesNoReaction;
+        return;
+    }
+
+    // perform all reactions at once and relax
+    universe.react(acceptedCandidates);
+    universe.write(currentCycle);
+    rsmdLOG( "... reacted " << acceptedCandidates.size() << " candidates (out of " << candidates.size() << " candidates)" );
+    if( relax() )
+    {
+        rsmdLOG( "... relaxation succeeded!" );
+        lastReactiveCycle = currentCycle;
+        ++ nCyclesReaction;
+        // read configuration after relaxation and check if sensible
+        universe.readRelaxed(currentCycle);
+        for( auto& accepted: acceptedCandidates )
+        {
+            universe.checkMovement(accepted);
+        }
+    }
+    else
+    {
+        rsmdWARNING( "... relaxation failed, stepping out!" );
+        statisticsRecord.outcome = STATISTICS_OUTCOME::REJECTED_RELAXATION;
+        raise(SIGABRT);
+    }
+}
+
+
+
+//
+// columns of the (text) statistics file:
+// total rate, time of the last event within the reactive step and # events per reaction template
+//
+void SimulatorKMC::writeStatisticsHeaderText()
+{
+    STATISTICS_FILE << std::setw(10) << "# cycle"
+                    << std::setw(15) << "# candidates"
+                    << std::setw(20) << "total_rate/ps^-1"
+                    << std::setw(15) << "t_event/ps"
+                    << std::setw(50) << "# events";
+}
+
+void SimulatorKMC::writeStatisticsLineText()
+{
+    STATISTICS_FILE << std::setw(10) << statisticsRecord.cycle << std::setw(15) << statisticsRecord.nCandidates
+                    << std::setw(20) << totalRate << std::setw(15) << eventTime;
+    if( statisticsRecord.nCandidates > 0 )
+    {
+        std::stringstream accepted_string;
+        std::copy(statisticsRecord.accepted.begin(), statisticsRecord.accepted.end(), std::ostream_iterator<unsigned int>(accepted_string, " "));
+        STATISTICS_FILE << std::setw(50) << accepted_string.str();
+    }
+}
+
+
+
+//
+// rejection-free: every selected event is accepted
+//
+bool SimulatorKMC::acceptance(const ReactionCandidate&)
+{
+    return true;
+}
+
+
+
+//
+// finish & clean up
+//
+void SimulatorKMC::finish()
+{
+    STATISTICS_FILE.close();
+    STATISTICS_BINARY.close();
+
+    rsmdLOG( "" );
+    rsmdLOG( "finished rs@md simulation" );
+    rsmdLOG( "total " << (nCyclesReaction + nCyclesNoReaction) << " cycles have been performed:" );
+    rsmdLOG( "      " << nCyclesReaction << " with reactions (" << nEvents << " events)" );
+    rsmdLOG( "      " << nCyclesNoReaction << " without reaction" );
+    rsmdLOG( "" << std::flush );
+}
@@ -0,0 +1,59 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "control/simulatorBase.hpp"
+#include "enhance/fenwickTree.hpp"
+
+//
+// SimulatorKMC class
+//
+// inherits interface from SimulatorBase;
+// implements reactiveStep() for a
+// hybrid kinetic MC/MD simulation (rejection-free, BKL / Gillespie):
+//
+// every reactive step covers the time span of one md sequence,
+// within which events (= reactions of candidates) are selected with probability rate / total rate
+// and the physical time is advanced by exponentially distributed waiting times (mean 1 / total rate),
+// until the next waiting time exceeds the time span;
+// a reacted candidate removes only the rates of the candidates that share a reactant with it
+//
+
+class SimulatorKMC : public SimulatorBase
+{
+  private:
+    std::size_t nCyclesReaction {0};
+    std::size_t nCyclesNoReaction {0};
+    std::size_t nEvents {0};
+
+    double mdLength {0};        // time span of one reactive step (ps)
+    double eventTime {0};       // time of the last event within the current reactive step (ps)
+    double totalRate {0};       // total rate at the beginning of the current reactive step (1/ps)
+
+    // rates of all candidates
+    enhance::FenwickTree rates {};
+
+    // some functions that need to be implemented in derived:
+    void reactiveStep();
+    bool acceptance(const ReactionCandidate&);
+    void writeStatisticsHeaderText();
+    void writeStatisticsLineText();
+
+  public:
+    SimulatorKMC() = default;
+    ~SimulatorKMC() = default;
+
+    // some functions that need to be implemented in derived:
+    void finish();
+    void setup(const Parameters&);
+
+};
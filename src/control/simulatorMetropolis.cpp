@@ -24,6 +24,7 @@ void SimulatorMetropolis::setup(const Parameters& parameters)
 
     // setup specific stuff
     temperature = parameters.getOption("reaction.temperature").as<REAL>();
+    delayedAcceptance = parameters.getOption("reaction.delayedAcceptance").as<bool>();
 
     // setup map for counting failed relaxations:
     for( const auto& reaction: universe.getReactionTemplates() )
@@ -32,10 +33,7 @@ void SimulatorMetropolis::setup(const Parameters& parameters)
     }
 
     // check statistics file and write header
-    STATISTICS_FILE << "#" << std::setw(9) << "cycle"
-                    << std::setw(15) << "# candidates";
-    STATISTICS_FILE << std::setw(30) << "chosen_reaction"
-                    << std::setw(10) << "acc/rej" << '\n';
+    writeStatisticsHeader();
 
     rsmdLOG( "... setup done, time to start the simulation!" );
     rsmdLOG( std::flush << std::setprecision(3) );
@@ -50,16 +48,9 @@ void SimulatorMetropolis::reactiveStep()
     // search for candidates
     universe.update(lastReactiveCycle);
     auto candidates = universe.CellSearchReactionCandidates(); //searchReactionCandidates(); // returns shuffled vector of reaction candidates
-    STATISTICS_FILE << std::setw(10) << currentCycle << std::setw(15) << candidates.size();
+    beginStatisticsLine(candidates);
     if( candidates.size() > 0 )
     {
-        // count candidates per reaction type
-        std::map<std::string, int> counts {};
-        for( const auto& rType: universe.getReactionTemplates() )
-        {
-            auto count = std::accumulate(candidates.begin(), candidates.end(), 0, [&rType](int a, auto b){ return a + (b.getName() == rType.getName() ? 1 : 0); });
-            counts[rType.getName()] =  count;
-        }
         // compute weights
         std::vector<REAL> weights {}; 
         std::transform(candidates.begin(), candidates.end(), std::back_inserter(weights),
@@ -68,12 +59,22 @@ void SimulatorMetropolis::reactiveStep()
         auto& candidate = *enhance::random_weighted_choice(candidates.begin(), weights.begin(), weights.end());
         rsmdLOG( "testing reaction candidate ");
         rsmdLOG( candidate.shortInfo() );
-        STATISTICS_FILE << std::setw(30) << candidate.getName();
+        statisticsRecord.entries.emplace_back();
+        statisticsRecord.entries.back().reaction = reactionIndex(candidate);
+        ++ statisticsRecord.attempted[ reactionIndex(candidate) ];
         universe.react(candidate);
 
         // relaxation
         universe.write(currentCycle);
-        if( mdEngine->runRelaxation(currentCycle) )
+        mdEngine->setReactionRecords( universe.getReactionRecordsAtoms() );
+        if( delayedAcceptance && ! prescreening(candidate) )
+        {
+            rsmdLOG( "... reactive step rejected! (in the pre-screening, without relaxation)" );
+            mdEngine->cleanup(currentCycle);
+            ++ nCyclesRejectedPrescreening;
+            statisticsRecord.outcome = STATISTICS_OUTCOME::REJECTED_PRESCREENING;
+        }
+        else if( relax() )
         {
             // check acceptance / reverse if rejected
             mdEngine->runEnergyComputation(currentCycle, lastReactiveCycle);
@@ -81,7 +82,9 @@ void SimulatorMetropolis::reactiveStep()
             {
                 lastReactiveCycle = currentCycle;
                 ++ nCyclesAccepted;
-                STATISTICS_FILE << std::setw(10) << "acc";
+                statisticsRecord.outcome = STATISTICS_OUTCOME::ACCEPTED;
+                statisticsRecord.entries.back().accepted = true;
+                ++ statisticsRecord.accepted[ reactionIndex(candidate) ];
                 // read configuration after relaxation and check if sensible
                 universe.readRelaxed(currentCycle);
                 universe.checkMovement(candidate);
@@ -93,7 +96,7 @@ void SimulatorMetropolis::reactiveStep()
                 universe.checkMovement(candidate);
                 mdEngine->cleanup(currentCycle);
                 ++ nCyclesRejected;
-                STATISTICS_FILE << std::setw(10) << "rej";
+                statisticsRecord.outcome = STATISTICS_OUTCOME::REJECTED;
             }
         }
         else
@@ -102,15 +105,45 @@ void SimulatorMetropolis::reactiveStep()
             mdEngine->cleanup(currentCycle);
             ++ nCyclesRejectedFailedRelaxation;
             ++ nCyclesFailedRelaxation_reactions[candidate.getName()];
-            STATISTICS_FILE << std::setw(10) << "rej_relax";
+            statisticsRecord.outcome = STATISTICS_OUTCOME::REJECTED_RELAXATION;
         }
     }
     else
     {
         rsmdLOG( "... no reaction candidates available.")
-        STATISTICS_FILE << std::setw(30) << "none" << std::setw(10) << "none" << std::setw(10) << "none";
     }
-    STATISTICS_FILE << '\n' << std::flush;
+}
+
+
+
+//
+// columns of the (text) statistics file
+//
+void SimulatorMetropolis::writeStatisticsHeaderText()
+{
+    STATISTICS_FILE << "#" << std::setw(9) << "cycle"
+                    << std::setw(15) << "# candidates";
+    STATISTICS_FILE << std::setw(30) << "chosen_reaction"
+                    << std::setw(10) << "acc/rej";
+}
+
+void SimulatorMetropolis::writeStatisticsLineText()
+{
+    STATISTICS_FILE << std::setw(10) << statisticsRecord.cycle << std::setw(15) << statisticsRecord.nCandidates;
+    if( statisticsRecord.outcome == STATISTICS_OUTCOME::NONE )
+    {
+        STATISTICS_FILE << std::setw(30) << "none" << std::setw(10) << "none";
+        return;
+    }
+    STATISTICS_FILE << std::setw(30) << reactionNames[ statisticsRecord.entries.back().reaction ];
+    switch( statisticsRecord.outcome )
+    {
+        case STATISTICS_OUTCOME::ACCEPTED:              STATISTICS_FILE << std::setw(10) << "acc";          break;
+        case STATISTICS_OUTCOME::REJECTED:              STATISTICS_FILE << std::setw(10) << "rej";          break;
+        case STATISTICS_OUTCOME::REJECTED_RELAXATION:   STATISTICS_FILE << std::setw(10) << "rej_relax";    break;
+        case STATISTICS_OUTCOME::REJECTED_PRESCREENING: STATISTICS_FILE << std::setw(10) << "rej_pre";      break;
+        case STATISTICS_OUTCOME::NONE:                  break;
+    }
 }
 
 
@@ -126,7 +159,18 @@ bool SimulatorMetropolis::acceptance(const ReactionCandidate& candidate)
                                          << " = " << energyDifference + candidate.getReactionEnergy() << ' ' << unitSystem->energy );
     energyDifference += candidate.getReactionEnergy();
     
-    REAL condition = std::exp( -1.0 * energyDifference / (unitSystem->getR() * temperature) );
+    // delayed acceptance: the pre-screening already accepted with min(1, exp(-dE_pre/RT)),
+    // accepting with min(1, exp(-(dE - dE_pre)/RT)) keeps detailed balance w.r.t. the relaxed energies
+    REAL exponent = ( delayedAcceptance ? energyDifference - prescreeningEnergyDifference : energyDifference );
+    if( delayedAcceptance )
+    {
+        rsmdLOG( "... relative to the pre-screening: " << energyDifference << " - " << prescreeningEnergyDifference
+                                         << " = " << exponent << ' ' << unitSystem->energy );
+    }
+
+    REAL condition = std::exp( -1.0 * exponent / (unitSystem->getR() * temperature) );
+    statisticsRecord.entries.back().criterion = condition;
+    statisticsRecord.entries.back().energyDifference = energyDifference;
 
     if( random < condition )
     {
@@ -142,19 +186,56 @@ bool SimulatorMetropolis::acceptance(const ReactionCandidate& candidate)
 
 
 
+//
+// stage one of the delayed acceptance: single-point energy of the unrelaxed products,
+// reject early with the Metropolis criterion of that energy difference
+//
+bool SimulatorMetropolis::prescreening(const ReactionCandidate& candidate)
+{
+    mdEngine->runPrescreening(currentCycle, lastReactiveCycle);
+
+    REAL random = enhance::random(0.0, 1.0);
+
+    prescreeningEnergyDifference = energyParser->readPrescreeningEnergyDifference(currentCycle, lastReactiveCycle) + candidate.getReactionEnergy();
+    rsmdLOG( "... pre-screening energy difference (unrelaxed) = " << prescreeningEnergyDifference << ' ' << unitSystem->energy );
+
+    REAL condition = std::exp( -1.0 * prescreeningEnergyDifference / (unitSystem->getR() * temperature) );
+    statisticsRecord.entries.back().criterion = condition;
+    statisticsRecord.entries.back().energyDifference = prescreeningEnergyDifference;
+
+    if( random < condition )
+    {
+        rsmdLOG( "... candidate passed the pre-screening: " << random << " < " << condition );
+        return true;
+    }
+    else
+    {
+        rsmdLOG( "... candidate rejected in the pre-screening: " << random << " !< " << condition );
+        return false;
+    }
+}
+
+
+
 //
 // finish & clean up
 //
 void SimulatorMetropolis::finish() 
 {
     STATISTICS_FILE.close();
+    STATISTICS_BINARY.close();
 
     rsmdLOG( "" );
     rsmdLOG( "finished rs@md simulation" );
-    rsmdLOG( "total " << (nCyclesAccepted + nCyclesRejected + nCyclesRejectedFailedRelaxation) << " cycles have been performed:" );
+    rsmdLOG( "total " << (nCyclesAccepted + nCyclesRejected + nCyclesRejectedFailedRelaxation + nCyclesRejectedPrescreening) << " cycles have been performed:" );
     rsmdLOG( "      " << nCyclesAccepted << " accepted" );
     rsmdLOG( "      " << nCyclesRejected << " rejected" );
+    if( delayedAcceptance )
+    {
+        rsmdLOG( "      " << nCyclesRejectedPrescreening << " rejected in the pre-screening (without relaxation)" );
+    }
     rsmdLOG( "      " << nCyclesRejectedFailedRelaxation << " rejected due to a failed relaxation" );
+    rsmdLOG( "energy cache (energies before the reactive steps): " << energyCache->getHits() << " hits, " << energyCache->getMisses() << " misses" );
     rsmdLOG( "failed relaxations happened for: ");
     for( const auto& element: nCyclesFailedRelaxation_reactions )
     {
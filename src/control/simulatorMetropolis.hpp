@@ -27,13 +27,22 @@ class SimulatorMetropolis : public SimulatorBase
     std::size_t nCyclesAccepted {0};
     std::size_t nCyclesRejected {0};
     std::size_t nCyclesRejectedFailedRelaxation {0};
+    std::size_t nCyclesRejectedPrescreening {0};
 
     std::map<std::string, std::size_t> nCyclesFailedRelaxation_reactions {};
     REAL temperature {0};
 
+    // delayed acceptance: pre-screen candidates with the single-point energy of the unrelaxed products,
+    // the relaxed energy difference is then accepted relative to the pre-screening energy difference
+    bool delayedAcceptance {false};
+    REAL prescreeningEnergyDifference {0};
+
     // some functions that need to be implemented in derived:
     void reactiveStep();
     bool acceptance(const ReactionCandidate&);
+    bool prescreening(const ReactionCandidate&);
+    void writeStatisticsHeaderText();
+    void writeStatisticsLineText();
 
   public:
     SimulatorMetropolis() = default;
@@ -11,6 +11,9 @@
 
 #include "simulatorRate.hpp"
 
+#include <limits>
+#include <thread>
+
 //
 // setup stuff specific to hybrid MC/MD simulation with rate 
 // based acceptance criterion
@@ -26,10 +29,7 @@ void SimulatorRate::setup(const Parameters& parameters)
     rsFrequency = parameters.getOption("reaction.frequency").as<REAL>();
 
     // check statistics file and write header
-    STATISTICS_FILE << std::setw(10) << "# cycle"
-                    << std::setw(15) << "# candidates"
-                    << std::setw(15) << "# accepted"
-                    << std::setw(15) << "# attempted" << '\n';
+    writeStatisticsHeader();
 
     rsmdLOG( "... setup done, time to start the simulation!" );
     rsmdLOG( std::flush << std::setprecision(3) );
@@ -40,47 +40,45 @@ void SimulatorRate::setup(const Parameters& parameters)
 //
 void SimulatorRate::reactiveStep()
 {
-    std::vector<int> nReactionsAttempted(8, 0);
-    std::vector<int> nReactionsAccepted(8, 0);
-    std::stringstream accepted_string;
-    std::stringstream attempted_string;
-    int ntotalaccepted = 0;
-    int ntotalattempted = 0;
-    int i;
-    std::vector<ReactionCandidate> acceptedCandidates {};
     std::unordered_map<std::string, int> candidateTypes {};
 
     // search for candidates
     universe.update(lastReactiveCycle);
     auto candidates = universe.CellSearchReactionCandidates(); //searchReactionCandidates();  // returns shuffled vector of reaction candidates
-    STATISTICS_FILE << std::setw(10) << currentCycle << std::setw(15) << candidates.size();
+    beginStatisticsLine(candidates);
     if( candidates.size() > 0 )
     {
         rsmdLOG( "... found " << candidates.size() << " potential reaction candidates" );
-        // go through candidates and react them if accepted
-        for( auto& candidate: candidates )
+        // draw acceptance for all candidates at once
+        std::vector<char> acceptedDraws {};
+        std::vector<REAL> conditions {};
+        drawAcceptance(candidates, acceptedDraws, conditions);
+
+        // go through candidates in (shuffled) order and resolve conflicts:
+        // a candidate is still available if none of its reactants has been claimed by a previously accepted candidate
+        std::size_t highestMolID = 0;
+        for( const auto& candidate: candidates )
+        {
+            for( const auto& reactant: candidate.getReactants() )   highestMolID = std::max( highestMolID, reactant.getID() );
+        }
+        std::vector<bool> claimed ( highestMolID + 1, false );
+        std::vector<std::reference_wrapper<ReactionCandidate>> acceptedCandidates {};
+        for( std::size_t i=0; i<candidates.size(); ++i )
         {
-            if( universe.isAvailable(candidate) )
+            auto& candidate = candidates[i];
+            const auto& reactants = candidate.getReactants();
+            if( std::none_of(reactants.begin(), reactants.end(), [&claimed](const auto& reactant){ return claimed[reactant.getID()]; }) )
             {
-                for (i=0; i<universe.getReactionTemplates().size(); i++)
+                ++ statisticsRecord.attempted[ reactionIndex(candidate) ];
+                if( acceptedDraws[i] )
                 {
-                    if (candidate.reaction_name()==universe.getReactionTemplates()[i].getName())
-                    {
-                        ++ nReactionsAttempted[i];
-                    }
-                }
-                if( acceptance(candidate) )
-                {
-                    universe.react(candidate);
+                    for( const auto& reactant: reactants )  claimed[reactant.getID()] = true;
                     acceptedCandidates.push_back(candidate);
-                    rsmdLOG( "... reacted candidate " << candidate.shortInfo() );
-                    for (i=0; i<universe.getReactionTemplates().size(); i++)
-                    {
-                        if (candidate.reaction_name() == universe.getReactionTemplates()[i].getName())
-                        {
-                            ++ nReactionsAccepted[i];
-                        }
-                    }
+                    ++ statisticsRecord.accepted[ reactionIndex(candidate) ];
+                    statisticsRecord.entries.emplace_back();
+                    statisticsRecord.entries.back().reaction = reactionIndex(candidate);
+                    statisticsRecord.entries.back().accepted = true;
+                    statisticsRecord.entries.back().criterion = conditions[i];
                 }
             }
             else
@@ -90,16 +88,17 @@ void SimulatorRate::reactiveStep()
             candidateTypes.try_emplace( candidate.getName(), 0 );
             candidateTypes[candidate.getName()] += 1;
         }     
+
+        // perform all accepted reactions at once
+        universe.react(acceptedCandidates);
+        for( const ReactionCandidate& candidate: acceptedCandidates )
+        {
+            rsmdLOG( "... reacted candidate " << candidate.shortInfo() );
+        }
         
-        for(std::vector<int>::iterator it = nReactionsAccepted.begin(); it != nReactionsAccepted.end(); ++it)
-        ntotalaccepted += *it;
-        for(std::vector<int>::iterator it = nReactionsAttempted.begin(); it != nReactionsAttempted.end(); ++it)
-        ntotalattempted += *it;
-        
-        std::copy(nReactionsAccepted.begin(), nReactionsAccepted.end(), std::ostream_iterator<int>(accepted_string, " "));  
-        std::copy(nReactionsAttempted.begin(), nReactionsAttempted.end(), std::ostream_iterator<int>(attempted_string, " "));
-        
-        STATISTICS_FILE << std::setw(50) << accepted_string.str().c_str() << std::setw(50) << attempted_string.str().c_str();
+        const auto ntotalaccepted = std::accumulate( statisticsRecord.accepted.begin(), statisticsRecord.accepted.end(), 0u );
+        const auto ntotalattempted = std::accumulate( statisticsRecord.attempted.begin(), statisticsRecord.attempted.end(), 0u );
+        statisticsRecord.outcome = ( ntotalaccepted > 0 ? STATISTICS_OUTCOME::ACCEPTED : STATISTICS_OUTCOME::REJECTED );
         
         // relaxation
         if( ntotalaccepted > 0 )
@@ -111,7 +110,7 @@ void SimulatorRate::reactiveStep()
             {
                 rsmdLOG( "... " << pair.second << " " << pair.first ); 
             }
-            if( mdEngine->runRelaxation(currentCycle) )
+            if( relax() )
             {
                 rsmdLOG( "... relaxation succeeded!" );
                 lastReactiveCycle = currentCycle;
@@ -126,6 +125,7 @@ void SimulatorRate::reactiveStep()
             else
             {
                 rsmdWARNING( "... relaxation failed, stepping out!" );
+                statisticsRecord.outcome = STATISTICS_OUTCOME::REJECTED_RELAXATION;
                 raise(SIGABRT);
             }
         }
@@ -141,17 +141,90 @@ void SimulatorRate::reactiveStep()
         rsmdLOG( "...found no candidates");
         ++ nCyclesNoReaction;
     }
-    STATISTICS_FILE << '\n' << std::flush;
+}
+
+
+//
+// columns of the (text) statistics file:
+// # accepted / # attempted candidates per reaction template
+//
+void SimulatorRate::writeStatisticsHeaderText()
+{
+    STATISTICS_FILE << std::setw(10) << "# cycle"
+                    << std::setw(15) << "# candidates"
+                    << std::setw(50) << "# accepted"
+                    << std::setw(50) << "# attempted";
+}
+
+void SimulatorRate::writeStatisticsLineText()
+{
+    STATISTICS_FILE << std::setw(10) << statisticsRecord.cycle << std::setw(15) << statisticsRecord.nCandidates;
+    if( statisticsRecord.nCandidates > 0 )
+    {
+        std::stringstream accepted_string;
+        std::stringstream attempted_string;
+        std::copy(statisticsRecord.accepted.begin(), statisticsRecord.accepted.end(), std::ostream_iterator<unsigned int>(accepted_string, " "));  
+        std::copy(statisticsRecord.attempted.begin(), statisticsRecord.attempted.end(), std::ostream_iterator<unsigned int>(attempted_string, " "));
+        STATISTICS_FILE << std::setw(50) << accepted_string.str() << std::setw(50) << attempted_string.str();
+    }
+}
+
+
+
+//
+// acceptance condition of a candidate
+//
+REAL SimulatorRate::acceptanceCondition(const ReactionCandidate& candidate) const
+{
+    return rsFrequency * candidate.getCurrentReactionRateValue();
+}
+
+
+//
+// draw acceptance for all candidates
+// (the distance-dependent rates of all candidates are interpolated in the same pass;
+//  candidate i uses random stream i of a seed drawn once per cycle, so the result
+//  does not depend on the number of threads)
+//
+void SimulatorRate::drawAcceptance(const std::vector<ReactionCandidate>& candidates, std::vector<char>& accepted, std::vector<REAL>& conditions) const
+{
+    accepted.assign( candidates.size(), 0 );
+    conditions.assign( candidates.size(), 0 );
+    const auto seed = enhance::random<std::size_t>( 0, std::numeric_limits<std::size_t>::max() );
+
+    auto draw = [&](std::size_t first, std::size_t last){
+        for( std::size_t i=first; i<last; ++i )
+        {
+            conditions[i] = acceptanceCondition(candidates[i]);
+            accepted[i] = ( enhance::streamRandom(seed, i) < conditions[i] );
+        }
+    };
+
+    // only worth spawning threads for many candidates
+    const std::size_t nThreads = std::min<std::size_t>( std::max(1u, std::thread::hardware_concurrency()), 1 + candidates.size() / 4096 );
+    if( nThreads == 1 )
+    {
+        draw(0, candidates.size());
+        return;
+    }
+    std::vector<std::thread> threads {};
+    const std::size_t chunk = (candidates.size() + nThreads - 1) / nThreads;
+    for( std::size_t first=0; first<candidates.size(); first+=chunk )
+    {
+        threads.emplace_back( draw, first, std::min(first + chunk, candidates.size()) );
+    }
+    for( auto& thread: threads )    thread.join();
 }
 
 
 //
 // check acceptance
+// (of a single candidate, the reactive step draws for all candidates at once, see drawAcceptance)
 //
 bool SimulatorRate::acceptance(const ReactionCandidate& candidate)
 {
     REAL random = enhance::random(0.0, 1.0);
-    REAL condition = rsFrequency * candidate.getCurrentReactionRateValue(); 
+    REAL condition = acceptanceCondition(candidate); 
     rsmdDEBUG( "checking acceptance for candidate " << candidate.shortInfo() );
     rsmdDEBUG( "condition = " << rsFrequency << "*" << candidate.getCurrentReactionRateValue() << "=" << condition);
     if( random < condition )
@@ -174,6 +247,7 @@ bool SimulatorRate::acceptance(const ReactionCandidate& candidate)
 void SimulatorRate::finish() 
 {
     STATISTICS_FILE.close();
+    STATISTICS_BINARY.close();
 
     rsmdLOG( "" );
     rsmdLOG( "finished rs@md simulation" );
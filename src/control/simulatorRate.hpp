@@ -31,9 +31,16 @@ class SimulatorRate : public SimulatorBase
 
     REAL rsFrequency {0};
 
+    // acceptance conditions and acceptance draws for all candidates
+    // (in parallel, with one random stream per candidate)
+    REAL acceptanceCondition(const ReactionCandidate&) const;
+    void drawAcceptance(const std::vector<ReactionCandidate>&, std::vector<char>&, std::vector<REAL>&) const;
+
     // some functions that need to be implemented in derived:
     void reactiveStep();
     bool acceptance(const ReactionCandidate&);
+    void writeStatisticsHeaderText();
+    void writeStatisticsLineText();
 
   public:
     SimulatorRate() = default;
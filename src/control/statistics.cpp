@@ -0,0 +1,201 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "control/statistics.hpp"
+
+#include <filesystem>
+
+namespace
+{
+    const std::string MAGIC {"rsmd-statistics"};
+    constexpr int VERSION {2};
+
+    //
+    // read one size-prefixed block, returns false at the end of the file
+    // (or if the block is truncated)
+    //
+    bool readBlock(std::ifstream& FILE, std::vector<char>& block)
+    {
+        unsigned char size[4];
+        if( ! FILE.read(reinterpret_cast<char*>(size), 4) )   return false;
+        block.resize( (std::size_t(size[0]) << 24) | (std::size_t(size[1]) << 16) | (std::size_t(size[2]) << 8) | std::size_t(size[3]) );
+        return static_cast<bool>( FILE.read(block.data(), block.size()) );
+    }
+
+    void writeBlock(std::ofstream& FILE, const XdrWriter& writer)
+    {
+        XdrWriter size {};
+        size.writeUInt( static_cast<unsigned int>(writer.size()) );
+        FILE.write( size.data().data(), size.size() );
+        FILE.write( writer.data().data(), writer.size() );
+    }
+}
+
+
+
+//
+// reset for a new cycle with n reaction templates
+//
+void StatisticsRecord::reset(std::int64_t c, std::size_t n)
+{
+    cycle = c;
+    nCandidates = 0;
+    candidates.assign(n, 0);
+    attempted.assign(n, 0);
+    accepted.assign(n, 0);
+    outcome = STATISTICS_OUTCOME::NONE;
+    entries.clear();
+    timings.clear();
+    relaxationLength = std::numeric_limits<double>::quiet_NaN();
+}
+
+
+
+//
+// open the file, write the header to a new file or check the header of an existing one
+//
+void StatisticsWriter::open(const std::string& name, const std::vector<std::string>& reactions, const std::vector<std::string>& phases, bool append)
+{
+    filename = name;
+    nReactions = reactions.size();
+    nPhases = phases.size();
+
+    if( append && std::filesystem::exists(filename) && std::filesystem::file_size(filename) > 0 )
+    {
+        try
+        {
+            StatisticsReader existing (filename);
+            if( existing.getReactions() != reactions || existing.getPhases() != phases )
+            {
+                rsmdCRITICAL( "reaction templates or timed phases of the simulation do not match the header of the statistics file " << filename );
+            }
+            version = existing.getVersion();
+            // remove a truncated record at the end
+            StatisticsRecord record {};
+            while( existing.next(record) ) {}
+            if( existing.getEnd() < std::filesystem::file_size(filename) )
+            {
+                rsmdWARNING( "... removing a truncated record at the end of the statistics file " << filename );
+                std::filesystem::resize_file( filename, existing.getEnd() );
+            }
+        }
+        catch(const std::exception& e)
+        {
+            rsmdCRITICAL( "could not read the header of the statistics file " << filename << ": " << e.what() );
+        }
+        FILE.open( filename, std::ios::binary | std::ios::app );
+    }
+    else
+    {
+        FILE.open( filename, std::ios::binary | std::ios::trunc );
+        version = VERSION;
+        writer.clear();
+        writer.writeString( MAGIC );
+        writer.writeInt( VERSION );
+        writer.writeUInt( static_cast<unsigned int>(reactions.size()) );
+        for( const auto& reaction: reactions )  writer.writeString( reaction );
+        writer.writeUInt( static_cast<unsigned int>(phases.size()) );
+        for( const auto& phase: phases )    writer.writeString( phase );
+        writeBlock( FILE, writer );
+    }
+
+    if( ! FILE )
+    {
+        rsmdCRITICAL( "opening file " << filename << " failed." );
+    }
+    FILE.flush();
+}
+
+
+
+//
+// append a record
+//
+void StatisticsWriter::write(const StatisticsRecord& record)
+{
+    writer.clear();
+    writer.writeInt64( record.cycle );
+    writer.writeUInt( static_cast<unsigned int>(record.nCandidates) );
+    for( std::size_t i=0; i<nReactions; ++i )   writer.writeUInt( record.candidates[i] );
+    for( std::size_t i=0; i<nReactions; ++i )   writer.writeUInt( record.attempted[i] );
+    for( std::size_t i=0; i<nReactions; ++i )   writer.writeUInt( record.accepted[i] );
+    writer.writeInt( static_cast<int>(record.outcome) );
+    writer.writeUInt( static_cast<unsigned int>(record.entries.size()) );
+    for( const auto& entry: record.entries )
+    {
+        writer.writeInt( entry.reaction );
+        writer.writeInt( entry.accepted ? 1 : 0 );
+        writer.writeDouble( entry.criterion );
+        writer.writeDouble( entry.energyDifference );
+    }
+    for( std::size_t i=0; i<nPhases; ++i )  writer.writeDouble( i < record.timings.size() ? record.timings[i] : 0 );
+    if( version >= 2 )  writer.writeDouble( record.relaxationLength );
+
+    writeBlock( FILE, writer );
+    FILE.flush();
+}
+
+
+
+//
+// open a statistics file and read its header
+//
+StatisticsReader::StatisticsReader(const std::string& name)
+    : filename(name)
+    , FILE(name, std::ios::binary)
+{
+    if( ! FILE )    throw std::runtime_error("could not open file '" + filename + "'");
+
+    std::vector<char> block {};
+    if( ! readBlock(FILE, block) )  throw std::runtime_error("missing header in file '" + filename + "'");
+    end = 4 + block.size();
+    reader.assign( filename, std::move(block) );
+
+    if( reader.readString() != MAGIC )  throw std::runtime_error("'" + filename + "' is not a binary rs@md statistics file");
+    version = reader.readInt();
+    if( version < 1 || version > VERSION )  throw std::runtime_error("unsupported version of statistics file '" + filename + "'");
+    reactions.resize( reader.readUInt() );
+    for( auto& reaction: reactions )    reaction = reader.readString();
+    phases.resize( reader.readUInt() );
+    for( auto& phase: phases )  phase = reader.readString();
+}
+
+
+
+//
+// read the next record, returns false at the end of the file
+//
+bool StatisticsReader::next(StatisticsRecord& record)
+{
+    std::vector<char> block {};
+    if( ! readBlock(FILE, block) )  return false;
+    end += 4 + block.size();
+    reader.assign( filename, std::move(block) );
+
+    record.reset( reader.readInt64(), reactions.size() );
+    record.nCandidates = reader.readUInt();
+    for( auto& n: record.candidates )   n = reader.readUInt();
+    for( auto& n: record.attempted )    n = reader.readUInt();
+    for( auto& n: record.accepted )     n = reader.readUInt();
+    record.outcome = static_cast<STATISTICS_OUTCOME>( reader.readInt() );
+    record.entries.resize( reader.readUInt() );
+    for( auto& entry: record.entries )
+    {
+        entry.reaction = reader.readInt();
+        entry.accepted = ( reader.readInt() != 0 );
+        entry.criterion = reader.readDouble();
+        entry.energyDifference = reader.readDouble();
+    }
+    record.timings.resize( phases.size() );
+    for( auto& timing: record.timings )     timing = reader.readDouble();
+    if( version >= 2 )  record.relaxationLength = reader.readDouble();
+    return true;
+}
@@ -0,0 +1,131 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "parser/xdrFile.hpp"
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <fstream>
+#include <cstdint>
+
+//
+// binary statistics stream (statisticsFormat = binary)
+//
+// an append-only file in XDR format (big endian) of size-prefixed blocks (uint: # bytes of the block),
+// starting with a header
+//   string   "rsmd-statistics"
+//   int      format version
+//   uint n   + n strings: names of the reaction templates
+//   uint m   + m strings: names of the timed phases (m = 0 if simulation.timing is off)
+// followed by one record per cycle
+//   int64    cycle
+//   uint     # candidates
+//   n uint   # candidates per reaction template
+//   n uint   # attempted candidates per reaction template
+//   n uint   # accepted candidates per reaction template
+//   int      outcome of the cycle (see STATISTICS_OUTCOME)
+//            (REJECTED_PRESCREENING: stage one of reaction.delayedAcceptance, REJECTED: stage two respectively no pre-screening)
+//   uint k   + k entries: chosen / accepted candidates
+//              int reaction template, int accepted, double criterion value, double energy difference
+//   m double time spent per phase (ms)
+//   double   length of the relaxation (ps, NaN if not adapted, see gromacs.relaxationExtensions)   (version >= 2)
+//
+// a truncated record at the end of the file (e.g. from a killed run) is ignored by the reader
+// and removed before appending to the file
+//
+
+enum class STATISTICS_OUTCOME : int { NONE, ACCEPTED, REJECTED, REJECTED_RELAXATION, REJECTED_PRESCREENING };
+
+
+struct StatisticsEntry
+{
+    int    reaction {-1};
+    bool   accepted {false};
+    double criterion {std::numeric_limits<double>::quiet_NaN()};
+    double energyDifference {std::numeric_limits<double>::quiet_NaN()};
+};
+
+
+struct StatisticsRecord
+{
+    std::int64_t                  cycle {0};
+    std::size_t                   nCandidates {0};
+    std::vector<unsigned int>     candidates {};   // per reaction template
+    std::vector<unsigned int>     attempted {};    // per reaction template
+    std::vector<unsigned int>     accepted {};     // per reaction template
+    STATISTICS_OUTCOME            outcome {STATISTICS_OUTCOME::NONE};
+    std::vector<StatisticsEntry>  entries {};
+    std::vector<double>           timings {};      // per phase (ms)
+    double                        relaxationLength {std::numeric_limits<double>::quiet_NaN()};     // ps
+
+    //
+    // reset for a new cycle with n reaction templates
+    //
+    void reset(std::int64_t, std::size_t);
+};
+
+
+
+class StatisticsWriter
+{
+  private:
+    std::string   filename {};
+    std::ofstream FILE {};
+    XdrWriter     writer {};
+    std::size_t   nReactions {0};
+    std::size_t   nPhases {0};
+    int           version {0};      // of the file (appending to a file of an older version)
+
+  public:
+    //
+    // open the file, write the header to a new file or check the header of an existing one
+    //
+    void open(const std::string&, const std::vector<std::string>&, const std::vector<std::string>&, bool);
+
+    //
+    // append a record
+    //
+    void write(const StatisticsRecord&);
+
+    inline bool isOpen() const { return FILE.is_open(); }
+    inline void close() { FILE.close(); }
+};
+
+
+
+class StatisticsReader
+{
+  private:
+    std::string   filename {};
+    std::ifstream FILE {};
+    XdrFile       reader {};
+
+    std::vector<std::string> reactions {};
+    std::vector<std::string> phases {};
+    int         version {0};
+    std::size_t end {0};    // position after the last complete block
+
+  public:
+    explicit StatisticsReader(const std::string&);
+
+    inline const auto& getReactions() const { return reactions; }
+    inline const auto& getPhases() const { return phases; }
+    inline int getVersion() const { return version; }
+    inline std::size_t getEnd() const { return end; }
+
+    //
+    // read the next record, returns false at the end of the file
+    //
+    bool next(StatisticsRecord&);
+};
@@ -22,9 +22,12 @@ typedef enhance::Vector3d<float>  REALVEC;
 
 //
 // log errors, warnings etc.
+// (see enhance/logging.hpp: messages are only formatted if their level is enabled
+//  for the subsystem, i.e. the source directory, of the calling file)
 //
 #include <csignal>
 #include <iostream>
+#include "enhance/logging.hpp"
 
 static std::string rsmdALL_formatting       {"          "};
 static std::string rsmdLOG_formatting       {"  [LOG]   "};
@@ -32,14 +35,19 @@ static std::string rsmdDEBUG_formatting     {" [DEBUG]  "};
 static std::string rsmdWARNING_formatting   {"[WARNING] "};
 static std::string rsmdCRITICAL_formatting  {" [ERROR]  "};
 
+#define rsmdMESSAGE(level, prefix, x)  {constexpr auto rsmdSUBSYSTEM = enhance::logSubsystem(__FILE__); \
+                                        if( enhance::Log.isEnabled(level, rsmdSUBSYSTEM) ) { auto& rsmdSTREAM = enhance::Log.formatter(); \
+                                        rsmdSTREAM << prefix; do { rsmdSTREAM << x; } while (0); rsmdSTREAM << '\n'; enhance::Log.submit(level); }}
+
 #ifndef NDEBUG
-    #define rsmdDEBUG(x) {std::cerr << rsmdDEBUG_formatting; do { std::cerr << x; } while (0); std::cerr << '\n';}
+    #define rsmdDEBUG(x) rsmdMESSAGE(enhance::LOGLEVEL::DEBUG, rsmdDEBUG_formatting, x)
 #else
     #define rsmdDEBUG(x)
 #endif
-#define rsmdLOG(x)       {std::cout << rsmdLOG_formatting; do { std::cout << x; } while (0); std::cout << '\n';}
-#define rsmdWARNING(x)   {std::cout << std::flush; std::clog << rsmdWARNING_formatting; do { std::clog << x; } while (0); std::clog << '\n';}
-#define rsmdCRITICAL(x)  {std::cout << std::flush; std::cerr << rsmdCRITICAL_formatting << __FILE__ <<":" << __LINE__ << "  "; do { std::cerr << x; } while (0); std::cerr <<", raising SIGABRT\n"; std::raise(SIGABRT); }
-#define rsmdEXIT(x)      {std::cout << std::flush; std::cerr << rsmdCRITICAL_formatting; do { std::cerr << x; } while (0);  std::cout << '\n'; std::exit(EXIT_FAILURE); }
+#define rsmdLOG(x)       rsmdMESSAGE(enhance::LOGLEVEL::LOG, rsmdLOG_formatting, x)
+#define rsmdVERBOSE(x)   rsmdMESSAGE(enhance::LOGLEVEL::VERBOSE, rsmdLOG_formatting, x)
+#define rsmdWARNING(x)   rsmdMESSAGE(enhance::LOGLEVEL::WARNING, rsmdWARNING_formatting, x)
+#define rsmdCRITICAL(x)  {enhance::Log.flush(); std::cerr << rsmdCRITICAL_formatting << __FILE__ <<":" << __LINE__ << "  "; do { std::cerr << x; } while (0); std::cerr <<", raising SIGABRT\n"; std::raise(SIGABRT); }
+#define rsmdEXIT(x)      {enhance::Log.flush(); std::cerr << rsmdCRITICAL_formatting; do { std::cerr << x; } while (0);  std::cout << '\n'; std::exit(EXIT_FAILURE); }
 
 
@@ -13,13 +13,21 @@
 
 #include "definitions.hpp"
 #include "parameters/parameters.hpp"
+#include "engine/engineWorker.hpp"
+#include "parser/energyCache.hpp"
+#include "enhance/timing.hpp"
 
 #include <stdlib.h>
 #include <sstream>
+#include <vector>
+#include <memory>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/wait.h>
 #include <csignal>
 #include <cstring>
+#include <filesystem>
+#include <limits>
 
 //
 // a base class that implements
@@ -37,6 +45,15 @@ class EngineBase
   protected:
     EngineBase() = default;
 
+    // optional long-lived worker process that executes the commands
+    std::unique_ptr<EngineWorker> worker {};
+
+    // energies known already (shared with the energy parser), may be null
+    std::shared_ptr<EnergyCache> energyCache {};
+
+    // handle wait status (and output) of an executed command
+    inline void checkStatus( int, const std::string& ) const;
+
     // execute a command in subprocess 
     template<typename... Args>
     void execute( const char*, Args&& ... args );
@@ -54,12 +71,69 @@ class EngineBase
     virtual void runMDInitial( ) = 0;
     virtual void runMDAppending( const std::size_t&, const std::size_t& ) = 0;
     virtual bool runRelaxation( const std::size_t& ) = 0;
+    virtual void runPrescreening( const std::size_t&, const std::size_t& ) = 0;
     virtual void runEnergyComputation( const std::size_t&, const std::size_t& ) = 0;
     virtual void cleanup( const std::size_t&) = 0;
+
+    // clean up at the end of the run
+    virtual void finish() {}
+
+    // atom ids (before/after) of the reacted molecules of the current reactive step
+    virtual void setReactionRecords( const std::vector<std::pair<std::size_t, std::size_t>>& ) {}
+
+    inline void setEnergyCache( std::shared_ptr<EnergyCache> cache ) { energyCache = std::move(cache); }
+
+    // length (ps) of the last relaxation if it is adapted (see gromacs.relaxationExtensions), else NaN
+    virtual double getRelaxationLength() const { return std::numeric_limits<double>::quiet_NaN(); }
+
+    // simulated time (ps) of one md sequence between two reactive steps
+    virtual double getMDLength() const = 0;
 };
 
 
 
+//
+// handle the wait status of an executed command: 
+// raise any signals and spill the process output / throw if anything went wrong
+//
+void EngineBase::checkStatus( int status, const std::string& pipeOut ) const
+{
+    if( WIFEXITED(status) )
+    {
+        rsmdDEBUG( "[EngineBase::execute()] " << "exited: status = " << WEXITSTATUS(status) );
+    }
+    else if( WIFSIGNALED(status) )
+    {
+        rsmdWARNING( "[EngineBase::execute()] " << "killed by signal " << WTERMSIG(status) );    
+        std::raise( WTERMSIG(status) ); 
+    }
+    else if( WIFSTOPPED(status) ) 
+    {
+        rsmdWARNING( "[EngineBase::execute()] " << "stopped by signal " << WSTOPSIG(status) );
+        std::raise( WSTOPSIG(status) );
+        return;
+    }
+    else if( WIFCONTINUED(status) )
+    {
+        rsmdWARNING( "[EngineBase::execute()] " << "continued" );
+        return;
+    }
+
+    // spill process output in case anything went wrong
+    if( WEXITSTATUS(status) != 0 || WIFSIGNALED(status) )
+    {
+        rsmdWARNING( "process output was: \n" << pipeOut );
+    }
+
+    // throw exception in case exited with status != 0
+    if( WEXITSTATUS(status) != 0 )
+    {
+        throw std::runtime_error("something went wrong in child process execution");
+    }
+}
+
+
+
 //
 // execute the command (+ cmdline options) given by args
 //
@@ -103,11 +177,32 @@ void EngineBase::execute( std::string& pipeIn, const char* cmd, Args&& ... args
     using expander = int[];
     (void) expander {0, (void(stream << ' ' << std::forward<const char*>(args)),0)...};
     rsmdDEBUG( stream.str() );
+
+    // time every subprocess, e.g. as "gmx mdrun"
+    std::string timerName {};
+    if( enhance::Timings.isEnabled() )
+    {
+        std::vector<std::string> arguments { std::string(args)... };
+        timerName = std::filesystem::path(arguments[0]).filename().string() + ( arguments.size() > 1 ? " " + arguments[1] : "" );
+    }
+    enhance::ScopedTimer timer (timerName);
     
+    // let the worker execute the command if there is one
+    if( worker )
+    {
+        std::vector<std::string> arguments {};
+        (void) expander {0, (void(arguments.emplace_back(std::forward<const char*>(args))),0)...};
+        status = worker->run( arguments, pipeIn, pipeOut );
+        checkStatus( status, pipeOut );
+        return;
+    }
+
     // creating the pipes
-    if( pipe(childIn) < 0)   // failure in creating a pipe
+    // (close-on-exec, so that children started concurrently from other threads 
+    //  do not inherit and keep open the pipes of this child)
+    if( pipe2(childIn, O_CLOEXEC) < 0)   // failure in creating a pipe
         rsmdCRITICAL( "failure in creating a pipe")
-    if( pipe(childOut) < 0)  // failure in creating a pipe
+    if( pipe2(childOut, O_CLOEXEC) < 0)  // failure in creating a pipe
         rsmdCRITICAL( "failure in creating a pipe" );
 
     // try forking a new process
@@ -142,39 +237,17 @@ void EngineBase::execute( std::string& pipeIn, const char* cmd, Args&& ... args
     
         default:    // fork successful, this section is only entered from within parent
             // write to childIn[1] (which will become stdin for the child) and close both sides of the pipe afterwards
+            // (only if there is any input: a child that does not read its input might have exited already,
+            //  writing to its closed pipe would raise SIGPIPE)
             close( childIn[READ_FD] );
-            write( childIn[WRITE_FD], pipeIn.c_str(), (strlen( pipeIn.c_str() )+1) );
+            if( ! pipeIn.empty() )  write( childIn[WRITE_FD], pipeIn.c_str(), (strlen( pipeIn.c_str() )+1) );
             close( childIn[WRITE_FD]) ;
 
-            // wait for state changes in the child (aka for it to return)
-            // and handle exit status or any signals correctly
-            do
-            {
-                wait( &status );
-                if( WIFEXITED(status) )
-                {
-                    rsmdDEBUG( "[EngineBase::execute()] " << "exited: status = " << WEXITSTATUS(status) );
-                }
-                else if( WIFSIGNALED(status) )
-                {
-                    rsmdWARNING( "[EngineBase::execute()] " << "killed by signal " << WTERMSIG(status) );    
-                    std::raise( WTERMSIG(status) ); 
-                }
-                else if( WIFSTOPPED(status) ) 
-                {
-                    rsmdWARNING( "[EngineBase::execute()] " << "stopped by signal " << WSTOPSIG(status) );
-                    std::raise( WSTOPSIG(status) );
-                }
-                else if( WIFCONTINUED(status) )
-                {
-                    rsmdWARNING( "[EngineBase::execute()] " << "continued" );
-                }
-            } while( !WIFEXITED(status) && !WIFSIGNALED(status) );
-            
             // close writing part of file descriptor
             close( childOut[WRITE_FD] );
 
             // get output from reading part of file descriptor
+            // (read before waiting, else the child might block on a full pipe)
             while( (readResult = read(childOut[READ_FD], buffer, sizeof(buffer)-1)) > 0 )
             {
                 buffer[readResult] = 0;
@@ -184,17 +257,14 @@ void EngineBase::execute( std::string& pipeIn, const char* cmd, Args&& ... args
             // finally also close reading part
             close(childOut[READ_FD]);
 
-            // spill process output in case anything went wrong
-            if( WEXITSTATUS(status) != 0 || WIFSIGNALED(status) || WIFSTOPPED(status) || WIFCONTINUED(status) )
-            {
-                rsmdWARNING( "process output was: \n" << pipeOut );
-            }
-
-            // throw exception in case exited with status != 0
-            if( WEXITSTATUS(status) != 0 )
+            // wait for this specific child (other children might run concurrently)
+            // and handle exit status or any signals correctly
+            do
             {
-                throw std::runtime_error("something went wrong in child process execution");
-            }
+                waitpid( child_pid, &status, 0 );
+                if( WIFSTOPPED(status) || WIFCONTINUED(status) )  checkStatus( status, pipeOut );
+            } while( !WIFEXITED(status) && !WIFSIGNALED(status) );
+            checkStatus( status, pipeOut );
 
             break;
     }   // end of switch()
@@ -10,6 +10,7 @@
 */
 
 #include "engine/engineGMX.hpp"
+#include "parser/edrReader.hpp"
 
 
 void EngineGMX::setup(const Parameters& parameters)
@@ -20,6 +21,16 @@ void EngineGMX::setup(const Parameters& parameters)
     mdp_file =            parameters.getOption("gromacs.mdp").as<std::string>();
     mdp_file_energy =     parameters.getOption("gromacs.mdp.energy").as<std::string>();
     mdp_file_relaxation = parameters.getOption("gromacs.mdp.relaxation").as<std::string>();
+
+    // use absolute paths, the working directory might change (see simulation.scratch)
+    for( auto* path: {&mdp_file, &mdp_file_energy, &mdp_file_relaxation} )
+    {
+        if( ! path->empty() )   *path = std::filesystem::absolute(*path).string();
+    }
+    if( std::filesystem::path(executablePath).has_parent_path() )
+    {
+        executablePath = std::filesystem::absolute(executablePath).string();
+    }
     if( parameters.getOption("reaction.mc").as<bool>() ) 
     {
         // set description for energy computation
@@ -38,9 +49,37 @@ void EngineGMX::setup(const Parameters& parameters)
     }
 
     // set extension time for appending simulations
-    read_mdp( mdp_file );
+    extensionTime = read_mdp( mdp_file );
     extensionTime_str = std::to_string(extensionTime);
 
+    // adaptive relaxation: the relaxation .mdp file gives the length of one segment
+    maxRelaxationExtensions = parameters.getOption("gromacs.relaxationExtensions").as<std::size_t>();
+    if( maxRelaxationExtensions > 0 )
+    {
+        const auto integrator = parse_mdp( mdp_file_relaxation )["integrator"];
+        relaxationSegment = read_mdp( mdp_file_relaxation );
+        if( integrator == "steep" || integrator == "cg" || integrator == "l-bfgs" || relaxationSegment <= 0 )
+        {
+            rsmdWARNING( "gromacs.relaxationExtensions requires a dynamical integrator (md, sd, bd) and nsteps * dt > 0 in '" << mdp_file_relaxation << "', using a fixed relaxation length" );
+            maxRelaxationExtensions = 0;
+        }
+        else
+        {
+            relaxationTolerance = parameters.getOption("gromacs.relaxationTolerance").as<REAL>();
+            relaxationSegment_str = std::to_string(relaxationSegment);
+            rsmdLOG( "... extending the relaxation up to " << maxRelaxationExtensions << " times by " << relaxationSegment 
+                     << " ps while the potential energy changes by more than " << relaxationTolerance << " kJ/mol" );
+        }
+    }
+
+    // local relaxation: derived relaxation .mdp file that freezes the group 'frozen' (see X.relaxation.ndx)
+    if( parameters.getOption("gromacs.relaxationRadius").as<REAL>() > 0 )
+    {
+        localRelaxation = true;
+        mdp_file_relaxation = write_mdp_localRelaxation( mdp_file_relaxation );
+        rsmdLOG( "... relaxing only molecules within " << parameters.getOption("gromacs.relaxationRadius").as<REAL>() << " nm of the products, using '" << mdp_file_relaxation << "'" );
+    }
+
     // get usable number of threads:
     int nt = parameters.getOption("gromacs.nt").as<int>();
     int ntmpi = parameters.getOption("gromacs.ntmpi").as<int>();
@@ -55,10 +94,31 @@ void EngineGMX::setup(const Parameters& parameters)
     ntmpi_as_str = std::to_string(ntmpi);
     ntomp_as_str = std::to_string(ntomp);
 
+    // the pipeline runs the reruns of the local energy branches (reactants / products and their solvation) 
+    // at the same time: split the threads between them (one thread-MPI rank each) to not oversubscribe the node
+    if( parameters.getOption("gromacs.pipeline").as<bool>() && computeLocalPotentialEnergies )
+    {
+        const int nBranches = ( computeSolvationPotentialEnergies ? 4 : 2 );
+        int nThreads = nt;
+        if( nThreads == 0 )     nThreads = ( ntmpi > 0 && ntomp > 0 ? ntmpi * ntomp : static_cast<int>(std::thread::hardware_concurrency()) );
+        const int ntRerun = std::max( 1, nThreads / nBranches );
+        ntRerun_as_str = std::to_string(ntRerun);
+        rsmdLOG( "... running " << nBranches << " energy reruns concurrently with " << ntRerun << " thread(s) each" );
+    }
+
     // check what to do in cleanup() after rs was rejected:
     saveRejectedFiles = parameters.getOption("reaction.saveRejected").as<bool>();
     rejectedFilekeys = {".top", "-rs.tpr", "-rs.gro", "-rs.log", "-rs.edr", "-rs.cpt", "-rs.xtc", "-rs-mdpout.mdp", ".reactants.ndx", ".products.ndx"};
-    if( parameters.getOption("reaction.mc").as<bool>() )    rejectedFilekeys.emplace_back("-rs.xvg");
+    readEnergyFiles = parameters.getOption("gromacs.edr").as<bool>();
+    nativeTrajectorySubsets = parameters.getOption("gromacs.nativeSubsets").as<bool>();
+    if( parameters.getOption("reaction.mc").as<bool>() && ! readEnergyFiles )    rejectedFilekeys.emplace_back("-rs.xvg");
+    if( parameters.getOption("gromacs.trr").as<bool>() )    rejectedFilekeys.emplace_back("-rs.trr");
+    if( localRelaxation )   rejectedFilekeys.emplace_back(".relaxation.ndx");
+    if( parameters.getOption("reaction.delayedAcceptance").as<bool>() )
+    {
+        rejectedFilekeys.insert( rejectedFilekeys.end(), {"-pre.tpr", "-pre-mdpout.mdp", "-pre.edr", "-pre.log"} );
+        if( ! readEnergyFiles )     rejectedFilekeys.emplace_back("-pre.xvg");
+    }
 
     // set backup policy
     if( parameters.getOption("gromacs.backup").as<bool>() )
@@ -66,6 +126,21 @@ void EngineGMX::setup(const Parameters& parameters)
         backupPolicy = "-backup";
     }
 
+    // set pipeline policy
+    runConcurrently = parameters.getOption("gromacs.pipeline").as<bool>();
+    if( parameters.getOption("gromacs.gromppCache").as<std::size_t>() > 0 )
+    {
+        useGromppCache = true;
+        gromppCache.setup( std::filesystem::current_path()/".rsmd-grompp-cache", parameters.getOption("gromacs.gromppCache").as<std::size_t>() );
+    }
+
+    // start worker process that executes all gromacs commands if requested
+    if( ! parameters.getOption("simulation.worker").as<std::string>().empty() )
+    {
+        worker = std::make_unique<EngineWorker>();
+        worker->start( parameters.getOption("simulation.worker").as<std::string>() );
+    }
+
     // check that topology/coordinate files are present
     std::string topologyFile = parameters.getOption("gromacs.topology").as<std::string>();
     std::string coordinatesFile = parameters.getOption("gromacs.coordinates").as<std::string>();
@@ -206,10 +281,14 @@ void EngineGMX::runMDAppending( const std::size_t& cycle, const std::size_t& las
 
 
 // rs / relax   in: cycle = X 
-//              grompp -f relax.mdp -c X-rs.gro -p X-rs.top -o X-rs.tpr
+//              grompp -f relax.mdp -c X-rs.gro -p X-rs.top -o X-rs.tpr [-n X.relaxation.ndx]
 //              mdrun  -s X-rs.tpr -deffnm X-rs
+//              (adaptive, while not converged:)
+//              convert-tpr -s X-rs.tpr -o X-rs.tpr -extend T
+//              mdrun  -s X-rs.tpr -cpi X-rs.cpt -append -deffnm X-rs
 bool EngineGMX::runRelaxation( const std::size_t& cycle )
 {
+    enhance::ScopedTimer timer ("relaxation");
     std::stringstream keyOut, key {};
     keyOut << cycle << "-rs";
     key << cycle;
@@ -217,13 +296,30 @@ bool EngineGMX::runRelaxation( const std::size_t& cycle )
 
     try
     {
-        // run grompp -f mdp.mdp -p top -c gro.gro -o tpr.tpr
+        // run grompp -f mdp.mdp -p top -c gro.gro -o tpr.tpr (-n ndx.ndx with the freeze groups)
         // void EngineGMX::grompp( const std::string& mdp, const std::string& top, const std::string& gro, const std::string& tpr )
-        grompp( mdp_file_relaxation, key.str(), keyOut.str(), keyOut.str() );
+        if( localRelaxation )   grompp( mdp_file_relaxation, key.str(), keyOut.str(), keyOut.str(), key.str() + ".relaxation" );
+        else                    grompp( mdp_file_relaxation, key.str(), keyOut.str(), keyOut.str() );
 
         // run mdrun -s tpr.tpr -deffnm tpr
         // void EngineGMX::mdrun( const std::string& tpr )
         mdrun( keyOut.str() );
+
+        // extend the relaxation as long as the potential energy keeps changing
+        if( maxRelaxationExtensions > 0 )
+        {
+            relaxationLength = relaxationSegment;
+            double segmentStart = -std::numeric_limits<double>::infinity();
+            std::size_t nExtensions {0};
+            while( nExtensions < maxRelaxationExtensions && ! relaxationConverged(keyOut.str() + ".edr", segmentStart) )
+            {
+                extend_tpr( keyOut.str(), keyOut.str(), relaxationSegment_str );
+                mdrun( keyOut.str(), keyOut.str(), keyOut.str() );
+                relaxationLength += relaxationSegment;
+                ++ nExtensions;
+            }
+            rsmdLOG( "... relaxation length: " << relaxationLength << " ps (" << nExtensions << " extensions)" );
+        }
     }
     catch(const std::exception& e)
     {
@@ -235,11 +331,51 @@ bool EngineGMX::runRelaxation( const std::size_t& cycle )
 
 
 
+// pre-screening (delayed acceptance)   in: cycle = X, lastReactiveCycle = Y
+//          grompp -f relaxation.mdp -p X.top -c X-rs.gro -o X-pre.tpr [-n X.relaxation.ndx]
+//          mdrun -s X-pre.tpr -rerun X-rs.gro -deffnm X-pre
+//          energy -f X-pre.edr -o X-pre.xvg, energy -f Y-md.edr -o Y-md.xvg
+//
+// single-point energy of the unrelaxed products
+// (with the relaxation parameters, such that the same interactions are used;
+//  the local relaxation .mdp file needs the group 'frozen' from the relaxation index file)
+void EngineGMX::runPrescreening( const std::size_t& currentCycle, const std::size_t& lastReactiveCycle )
+{
+    enhance::ScopedTimer timer ("prescreening");
+    const std::string key = std::to_string(currentCycle);
+    const std::string keyIn = key + "-rs";
+    const std::string keyOut = key + "-pre";
+    const std::string before = std::to_string(lastReactiveCycle) + "-md";
+
+    try
+    {
+        if( localRelaxation )   grompp( mdp_file_relaxation, key, keyIn, keyOut, key + ".relaxation" );
+        else                    grompp( mdp_file_relaxation, key, keyIn, keyOut );
+        mdrunRerun( keyOut, keyIn + ".gro", keyOut );
+        if( ! readEnergyFiles )
+        {
+            energy( keyOut, keyOut );
+            if( ! (energyCache && energyCache->contains(before + ".edr", "Potential")) )    energy( before, before );
+        }
+    }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "caught expection in EngineGMX::runPrescreening(): " << e.what() );
+    }
+}
+
+
+
 // energy   in: cycle = X, lastReactiveCycle = Y 
 //          energy -f X-rs.edr -o X-rs.xvg
 //          energy -f Y-md.edr -o Y-md.xvg
+//
+// all steps are collected in a pipeline, which runs the independent branches 
+// (reactants / products / solvation of reactants / solvation of products) 
+// concurrently if requested
 void EngineGMX::runEnergyComputation( const std::size_t& currentCycle, const std::size_t& lastReactiveCycle )
 {
+    enhance::ScopedTimer timer ("energyComputation");
     //      energy -f edr.edr -o xvg.xvg
     std::stringstream before, after, cycle, cycleBefore {};
     before << lastReactiveCycle << "-md"; 
@@ -247,88 +383,74 @@ void EngineGMX::runEnergyComputation( const std::size_t& currentCycle, const std
     cycle << currentCycle;
     cycleBefore << lastReactiveCycle;
 
+    EnginePipeline pipeline {};
+    std::string backup = backupPolicy;
+
     try
     {
         if( computeLocalPotentialEnergies )
         {
-            std::string backup = backupPolicy;
             backupPolicy = "-nobackup";
 
-            if( computeSolvationPotentialEnergies )
+            // either use whole trajectory (if averaging is requested) or only last frame
+            const std::string trajectory = ( averagePotentialEnergies ? ".xtc" : ".gro" );
+
+            // local energies:
+            // first: create .tpr file for only reactant/product atoms
+            // second: create .gro file or .xtc file for only reactant/product atoms
+            // third: mdrun rerun to create .edr file
+            // forth: convert to .xvg file
+            // (subsets of .xtc trajectories are written as .trr files if cut in-process)
+            const std::string subset = ( nativeTrajectorySubsets && trajectory == ".xtc" ? ".trr" : trajectory );
+            auto addLocalBranch = [&](const std::string& source, const std::string& group, const std::string& ndx, const std::vector<std::size_t>& atoms)
             {
-                // create tpr files
-                // ... for only reactant/product atoms
-                convert_tpr( before.str(), "reactants", cycle.str()+".reactants" );
-                convert_tpr( after.str(), "products", cycle.str()+".products" );
-                // ... for solvation group
-                grompp(mdp_file_energy, cycleBefore.str(), before.str(), "reactants_solvation", cycle.str()+".reactants");
-                grompp(mdp_file_energy, cycle.str(), after.str(), "products_solvation", cycle.str()+".products");
-
-                if( averagePotentialEnergies )
-                {
-                    // create .gro file for only reactant/product atoms
-                    trjconv( before.str(), cycle.str()+".reactants", before.str()+".xtc", "reactants.xtc" );
-                    trjconv( after.str(), cycle.str()+".products", after.str()+".xtc", "products.xtc" );
-                    // ... and mdrun rerun to create .edr file
-                    mdrunRerun("reactants", "reactants.xtc", "reactants");
-                    mdrunRerun("products", "products.xtc", "products");
-                    // mdrun rerun for solvation group
-                    mdrunRerun("reactants_solvation", before.str()+".xtc", "reactants_solvation");
-                    mdrunRerun("products_solvation", after.str()+".xtc", "products_solvation");
-                }
+                pipeline.add( "convert-tpr " + group, {source+".tpr", ndx+".ndx"}, {group+".tpr"}, 
+                              [=](){ convert_tpr(source, group, ndx); } );
+                if( nativeTrajectorySubsets )
+                    pipeline.add( "subset " + group, {source+trajectory}, {group+subset}, 
+                                  [=, &atoms](){ TrajectoryParserGMX::writeSubset(source+trajectory, group+subset, atoms); } );
                 else
-                {
-                    // create .gro file for only reactant/product atoms
-                    trjconv( before.str(), cycle.str()+".reactants", before.str()+".gro", "reactants.gro" );
-                    trjconv( after.str(), cycle.str()+".products", after.str()+".gro", "products.gro" );
-                    // ... and mdrun rerun to create .edr file
-                    mdrunRerun("reactants", "reactants.gro", "reactants");
-                    mdrunRerun("products", "products.gro", "products");
-                    // mdrun rerun for solvation group
-                    mdrunRerun("reactants_solvation", before.str()+".gro", "reactants_solvation");
-                    mdrunRerun("products_solvation", after.str()+".gro", "products_solvation");
-                }
-
-                // convert to .xvg files
-                energy( "reactants", before.str() );
-                energy( "products", after.str() );
-                energySolvation( "reactants_solvation", "reactants_solvation" );
-                energySolvation( "products_solvation", "products_solvation" );
-            }
-            else
+                    pipeline.add( "trjconv " + group, {source+".tpr", ndx+".ndx", source+trajectory}, {group+trajectory}, 
+                                  [=](){ trjconv(source, ndx, source+trajectory, group+trajectory); } );
+                pipeline.add( "mdrun -rerun " + group, {group+".tpr", group+subset}, {group+".edr", group+".log"}, 
+                              [=](){ mdrunRerun(group, group+subset, group, runConcurrently); } );
+                if( ! readEnergyFiles )
+                    pipeline.add( "energy " + group, {group+".edr"}, {source+".xvg"}, 
+                                  [=](){ energy(group, source); } );
+            };
+            addLocalBranch( before.str(), "reactants", cycle.str()+".reactants", reactantAtoms );
+            addLocalBranch( after.str(), "products", cycle.str()+".products", productAtoms );
+
+            // solvation energies:
+            // first: create .tpr file with solvation group
+            // second: mdrun rerun for solvation group to create .edr file
+            // third: convert to .xvg file
+            if( computeSolvationPotentialEnergies )
             {
-                // first: create .tpr file for only reactant/product atoms
-                convert_tpr( before.str(), "reactants", cycle.str()+".reactants" );
-                convert_tpr( after.str(), "products", cycle.str()+".products" );
-                if( averagePotentialEnergies )
-                {
-                    // second: create .gro file or .xtc file for only reactant/product atoms
-                    trjconv( before.str(), cycle.str()+".reactants", before.str()+".xtc", "reactants.xtc" );
-                    trjconv( after.str(), cycle.str()+".products", after.str()+".xtc", "products.xtc" );
-                    // third: mdrun rerun to create .edr file
-                    mdrunRerun("reactants", "reactants.xtc", "reactants");
-                    mdrunRerun("products", "products.xtc", "products");
-                }
-                else
+                auto addSolvationBranch = [&](const std::string& top, const std::string& source, const std::string& group, const std::string& ndx)
                 {
-                    // second: create .xtc file for only reactant/product atoms
-                    trjconv( before.str(), cycle.str()+".reactants", before.str()+".gro", "reactants.gro" );
-                    trjconv( after.str(), cycle.str()+".products", after.str()+".gro", "products.gro" );
-                    // third: mdrun rerun .xtc to create .edr file
-                    mdrunRerun("reactants", "reactants.gro", "reactants");
-                    mdrunRerun("products", "products.gro", "products");
-                }
-                // forth: convert to .xvg file
-                energy( "reactants", before.str() );
-                energy( "products", after.str() );
+                    pipeline.add( "grompp " + group, {mdp_file_energy, top+".top", source+".gro", ndx+".ndx"}, {group+".tpr", group+"-mdpout.mdp"}, 
+                                  [=](){ grompp(mdp_file_energy, top, source, group, ndx); } );
+                    pipeline.add( "mdrun -rerun " + group, {group+".tpr", source+trajectory}, {group+".edr", group+".log"}, 
+                                  [=](){ mdrunRerun(group, source+trajectory, group, runConcurrently); } );
+                    if( ! readEnergyFiles )
+                        pipeline.add( "energy " + group, {group+".edr"}, {group+".xvg"}, 
+                                      [=](){ energySolvation(group, group); } );
+                };
+                addSolvationBranch( cycleBefore.str(), before.str(), "reactants_solvation", cycle.str()+".reactants" );
+                addSolvationBranch( cycle.str(), after.str(), "products_solvation", cycle.str()+".products" );
             }
-            backupPolicy = backup;
         }
-        else
+        else if( ! readEnergyFiles )
         {
-            energy( before.str(), before.str() );
-            energy( after.str(), after.str() );
+            // (the energy before the reactive step is only needed if the energy parser does not know it already)
+            if( ! (energyCache && energyCache->contains(before.str()+".edr", "Potential")) )
+                pipeline.add( "energy " + before.str(), {before.str()+".edr"}, {before.str()+".xvg"}, [&](){ energy( before.str(), before.str() ); } );
+            pipeline.add( "energy " + after.str(), {after.str()+".edr"}, {after.str()+".xvg"}, [&](){ energy( after.str(), after.str() ); } );
         }
+
+        pipeline.run( runConcurrently );
+        backupPolicy = backup;
     }
     catch(const std::exception& e)
     {
@@ -337,11 +459,29 @@ void EngineGMX::runEnergyComputation( const std::size_t& currentCycle, const std
 }
 
 
+//
+// atom ids (before/after) of the reacted molecules of the current reactive step,
+// stored as 0-based indices for cutting subsets out of trajectories
+//
+void EngineGMX::setReactionRecords( const std::vector<std::pair<std::size_t, std::size_t>>& records )
+{
+    reactantAtoms.clear();
+    productAtoms.clear();
+    for( const auto& [before, after]: records )
+    {
+        reactantAtoms.push_back( before - 1 );
+        productAtoms.push_back( after - 1 );
+    }
+}
+
+
+
 //
 // cleanup: rename or delete all files produced during the rejected reactive step
 //
 void EngineGMX::cleanup( const std::size_t& cycle )
 {
+    enhance::ScopedTimer timer ("cleanup");
     std::string key = std::to_string(cycle);
     std::filesystem::path thisPath = std::filesystem::current_path();
 
@@ -380,12 +520,33 @@ void EngineGMX::cleanup( const std::size_t& cycle )
 
 
 
+//
+// finish: report on and remove the grompp cache
+//
+void EngineGMX::finish()
+{
+    if( useGromppCache )
+    {
+        rsmdLOG( "grompp cache: " << gromppCache.getHits() << " hits, " << gromppCache.getMisses() << " misses" );
+        gromppCache.clear();
+    }
+}
+
+
+
 //
 // helper functions
 //
 //     grompp -f mdp.mdp -c gro.gro -p top.top -o tpr.tpr
 void EngineGMX::grompp( const std::string& mdp, const std::string& top, const std::string& gro, const std::string& tpr )
 {
+    std::uint64_t key {0};
+    if( useGromppCache )
+    {
+        key = gromppCache.key( {mdp, top + ".top", gro + ".gro"}, "grompp" );
+        if( gromppCache.restore(key, {tpr + ".tpr", tpr + "-mdpout.mdp"}) ) return;
+    }
+
     execute( executablePath.c_str(), executablePath.c_str(), "grompp", 
             "-f", mdp.c_str(), 
             "-p", (top + ".top").c_str(), 
@@ -394,19 +555,31 @@ void EngineGMX::grompp( const std::string& mdp, const std::string& top, const st
             "-o", (tpr + ".tpr").c_str(), 
             "-po", (tpr + "-mdpout.mdp").c_str(), 
             "-maxwarn", "2");
+
+    if( useGromppCache )    gromppCache.store(key, {tpr + ".tpr", tpr + "-mdpout.mdp"});
 }
 
 //     grompp -f mdp.mdp -c gro.gro -p top.top -o tpr.tpr -n ndx.ndx
 void EngineGMX::grompp( const std::string& mdp, const std::string& top, const std::string& gro, const std::string& tpr, const std::string& ndx )
 {
+    std::uint64_t key {0};
+    if( useGromppCache )
+    {
+        key = gromppCache.key( {mdp, top + ".top", gro + ".gro", ndx + ".ndx"}, "grompp -n" );
+        if( gromppCache.restore(key, {tpr + ".tpr", tpr + "-mdpout.mdp"}) ) return;
+    }
+
     execute( executablePath.c_str(), executablePath.c_str(), "grompp", 
             "-f", mdp.c_str(), 
             "-p", (top + ".top").c_str(), 
             "-c", (gro + ".gro").c_str(),
             "-r", (gro + ".gro").c_str(),
             "-o", (tpr + ".tpr").c_str(), 
+            "-po", (tpr + "-mdpout.mdp").c_str(), 
             "-n", (ndx + ".ndx").c_str(),
             "-maxwarn", "2");       
+
+    if( useGromppCache )    gromppCache.store(key, {tpr + ".tpr", tpr + "-mdpout.mdp"});
 }
 
 //     convert-tpr -s tpr.tpr -o tpr_new.tpr -extend time
@@ -419,6 +592,16 @@ void EngineGMX::convert_tpr( const std::string& tpr, const std::string& tpr_new
             "-quiet", "-nocopyright", backupPolicy.c_str() );       
 }
 
+//     convert-tpr -s tpr.tpr -o tpr_new.tpr -extend time   (with a given time)
+void EngineGMX::extend_tpr( const std::string& tpr, const std::string& tpr_new, const std::string& time )
+{
+    execute( executablePath.c_str(), executablePath.c_str(), "convert-tpr", 
+            "-s", (tpr + ".tpr").c_str(), 
+            "-o", (tpr_new + ".tpr").c_str(), 
+            "-extend", time.c_str(), 
+            "-quiet", "-nocopyright", backupPolicy.c_str() );       
+}
+
 //     convert-tpr -s tpr.tpr -o tpr_new.tpr -n ndx.ndx
 void EngineGMX::convert_tpr( const std::string& tpr, const std::string& tpr_new, const std::string& ndx )
 {
@@ -465,15 +648,19 @@ void EngineGMX::mdrun( const std::string& tpr, const std::string& fnm, const std
             "-quiet", "-nocopyright", backupPolicy.c_str() );
 }
 
-//      mdrun -s tpr.tpr -deffnm deffnm -rerun trj
-void EngineGMX::mdrunRerun( const std::string& tpr, const std::string& trj, const std::string& fnm)
+//      mdrun -s tpr.tpr -rerun trj -deffnm fnm
+//      (-deffnm such that concurrent reruns don't write to the same default output files,
+//       concurrent reruns use their share of the threads: -nt n -ntmpi 1 -ntomp n)
+void EngineGMX::mdrunRerun( const std::string& tpr, const std::string& trj, const std::string& fnm, bool concurrent )
 {
+    const bool share = concurrent && ! ntRerun_as_str.empty();
     execute( executablePath.c_str(), executablePath.c_str(), "mdrun", 
-            "-nt", nt_as_str.c_str(), 
-            "-ntmpi", ntmpi_as_str.c_str(), 
-            "-ntomp", ntomp_as_str.c_str(),  
+            "-nt", (share ? ntRerun_as_str : nt_as_str).c_str(), 
+            "-ntmpi", (share ? std::string("1") : ntmpi_as_str).c_str(), 
+            "-ntomp", (share ? ntRerun_as_str : ntomp_as_str).c_str(),  
             "-s", (tpr + ".tpr").c_str(), 
             "-rerun", trj.c_str(), 
+            "-deffnm", fnm.c_str(),
             "-e", (fnm + ".edr").c_str(), 
             "-g", (fnm + ".log").c_str(), 
             "-quiet", "-nocopyright", backupPolicy.c_str() );
@@ -502,13 +689,12 @@ void EngineGMX::energySolvation( const std::string& edr, const std::string& xvg)
 
 
 //
-// read mdp file and compare with given input, 
-// give warnings if something doesn't match
+// read all options (key = value) of an mdp file
+// (keys with '_' instead of '-', comments removed)
 //
-void EngineGMX::read_mdp( const std::string& filename )
+std::map<std::string, std::string> EngineGMX::parse_mdp( const std::string& filename )
 {
-    std::size_t nSteps = 0;
-    REAL        dt = 0;
+    std::map<std::string, std::string> options {};
 
     std::ifstream FILE( filename );
     if( ! FILE )
@@ -519,20 +705,117 @@ void EngineGMX::read_mdp( const std::string& filename )
     std::string line {};
     while( std::getline(FILE, line, '\n') )
     {
-        if( line.empty() ) continue;
-
-        auto trimmedLine = enhance::trimString(line);
-        if( trimmedLine[0] == ';' ) continue;
+        line = line.substr( 0, line.find(';') );
+        if( line.find('=') == std::string::npos ) continue;
 
         auto splitted = enhance::splitString(line, '=');
-        
-        // search for dt and nsteps to get trajectory length 
-        if( enhance::trimString(splitted[0]) == "nsteps" )   std::stringstream(splitted[1]) >> nSteps;
-        if( enhance::trimString(splitted[0]) == "dt" )       std::stringstream(splitted[1]) >> dt;
+        auto key = enhance::trimString(splitted[0]);
+        std::replace( key.begin(), key.end(), '_', '-' );
+        options[key] = ( splitted.size() > 1 ? enhance::trimString(splitted[1]) : std::string() );
+    }
+    return options;
+}
+
+
+//
+// read the md sequence length (nsteps * dt) from an mdp file
+//
+REAL EngineGMX::read_mdp( const std::string& filename )
+{
+    std::size_t nSteps = 0;
+    REAL        dt = 0;
+
+    auto options = parse_mdp( filename );
+    std::stringstream(options["nsteps"]) >> nSteps;
+    std::stringstream(options["dt"]) >> dt;
+
+    const REAL length = nSteps * dt;
+    rsmdLOG( "... reading md sequence length = " << length << " ps from '" << filename << "'");
+    return length;
+}
 
+
+
+//
+// check whether the potential energy of the last relaxation segment (all frames of the .edr file
+// from the given time on) has converged, i.e. the mean of the second half of the segment differs from
+// the mean of the first half by at most gromacs.relaxationTolerance,
+// sets the given time to the end of the segment
+// (if the segment has less than two frames, e.g. without -append, all frames are used)
+//
+bool EngineGMX::relaxationConverged( const std::string& edr, double& segmentStart )
+{
+    EdrReader reader {};
+    try
+    {
+        reader.read( edr, {"Potential"} );
+    }
+    catch(const std::exception& e)
+    {
+        rsmdWARNING( "could not read the potential energy from " << edr << ", not extending the relaxation: " << e.what() );
+        return true;
+    }
+    const auto& times = reader.getTimes();
+    const auto& potential = reader.getValues(0);
+
+    std::size_t first = std::lower_bound( times.begin(), times.end(), segmentStart - 1e-6 ) - times.begin();
+    if( times.size() - first < 2 )  first = 0;
+    if( times.size() - first < 2 )
+    {
+        rsmdWARNING( "less than two energy frames in " << edr << ", not extending the relaxation (see nstenergy)" );
+        return true;
+    }
+    segmentStart = times.back();
+
+    const std::size_t middle = first + (times.size() - first) / 2;
+    const double before = std::accumulate( potential.begin() + first, potential.begin() + middle, 0.0 ) / (middle - first);
+    const double after = std::accumulate( potential.begin() + middle, potential.end(), 0.0 ) / (potential.size() - middle);
+    rsmdVERBOSE( "... change of the mean potential energy over the last relaxation segment: " << after - before << " kJ/mol" );
+    return std::abs(after - before) <= relaxationTolerance;
+}
+
+
+
+//
+// write a copy of the given relaxation .mdp file (as <name>-local.mdp in the run directory,
+// the directory of the input file might be read-only or shared between runs)
+// that freezes the group 'frozen' in all dimensions,
+// returns the (absolute) path of the new file
+//
+std::string EngineGMX::write_mdp_localRelaxation( const std::string& filename )
+{
+    std::ifstream FILE( filename );
+    if( ! FILE )
+    {
+        rsmdCRITICAL( "could not read file '" << filename << "'");
+    }
+
+    const auto path = std::filesystem::path(filename);
+    const auto localFilename = ( std::filesystem::current_path() / (path.stem().string() + "-local.mdp") ).string();
+    std::ofstream LOCAL( localFilename );
+    if( ! LOCAL )
+    {
+        rsmdCRITICAL( "could not write file '" << localFilename << "'");
+    }
+
+    std::string line {};
+    while( std::getline(FILE, line, '\n') )
+    {
+        // (gromacs accepts '-' and '_' in keys)
+        const auto splitted = enhance::splitString(line, '=');
+        auto key = ( splitted.empty() ? std::string() : enhance::trimString(splitted[0]) );
+        std::replace( key.begin(), key.end(), '_', '-' );
+        if( key == "freezegrps" || key == "freezedim" )
+        {
+            rsmdWARNING( "... ignoring '" << enhance::trimString(line) << "' in '" << filename << "' for the local relaxation" );
+            continue;
+        }
+        LOCAL << line << '\n';
     }
 
-    extensionTime = nSteps * dt;
-    rsmdLOG( "... reading md sequence length = " << extensionTime << " ps from '" << filename << "'");
+    LOCAL << "\n; local relaxation (gromacs.relaxationRadius), written by rs@md\n";
+    LOCAL << "freezegrps               = frozen\n";
+    LOCAL << "freezedim                = Y Y Y\n";
 
+    return localFilename;
 }
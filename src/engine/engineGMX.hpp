@@ -12,10 +12,14 @@
 #pragma once
 
 #include "engine/engineBase.hpp"
+#include "engine/enginePipeline.hpp"
+#include "engine/gromppCache.hpp"
+#include "parser/trajectoryParserGMX.hpp"
 #include "enhance/utility.hpp"
 
 #include <thread>
 #include <filesystem>
+#include <map>
 
 //
 // a derived class that implements the gromacs engine
@@ -32,9 +36,19 @@ class EngineGMX : public EngineBase
     std::string mdp_file_relaxation {};
     std::string mdp_file_energy {};
 
+    bool localRelaxation {false};           // freeze everything outside of gromacs.relaxationRadius around the products
+
+    // adaptive relaxation: extend by the relaxation length while the potential energy keeps changing
+    std::size_t maxRelaxationExtensions {0};
+    REAL        relaxationTolerance {0};
+    REAL        relaxationSegment {0};
+    std::string relaxationSegment_str {};
+    double      relaxationLength {std::numeric_limits<double>::quiet_NaN()};
+
     std::string nt_as_str {};
     std::string ntmpi_as_str {};
     std::string ntomp_as_str {};
+    std::string ntRerun_as_str {};      // threads per rerun if the pipeline runs reruns concurrently
 
     REAL  extensionTime {1};
     std::string  extensionTime_str {"1"};
@@ -42,6 +56,15 @@ class EngineGMX : public EngineBase
     bool computeLocalPotentialEnergies {false};
     bool computeSolvationPotentialEnergies {false};
     bool averagePotentialEnergies {false};
+    bool readEnergyFiles {false};      // energies are read from .edr files by the energy parser, skip gmx energy
+
+    bool nativeTrajectorySubsets {false};   // cut reactant/product atoms out of trajectories in-process instead of gmx trjconv
+    std::vector<std::size_t> reactantAtoms {};
+    std::vector<std::size_t> productAtoms {};
+
+    bool        runConcurrently {false};
+    bool        useGromppCache {false};
+    GromppCache gromppCache {};
 
     bool        saveRejectedFiles {false};
     std::vector<std::string>  rejectedFilekeys {};
@@ -52,13 +75,17 @@ class EngineGMX : public EngineBase
     void grompp( const std::string&, const std::string&, const std::string&, const std::string&, const std::string& );
     void convert_tpr( const std::string&, const std::string&, const std::string& );
     void convert_tpr( const std::string&, const std::string&);
+    void extend_tpr( const std::string&, const std::string&, const std::string& );
     void trjconv( const std::string&, const std::string&, const std::string&, const std::string& );
     void mdrun( const std::string& );
     void mdrun( const std::string&, const std::string&, const std::string& );
-    void mdrunRerun( const std::string&, const std::string&, const std::string& );
+    void mdrunRerun( const std::string&, const std::string&, const std::string&, bool = false );
     void energy( const std::string&, const std::string& );
     void energySolvation( const std::string&, const std::string& );
-    void read_mdp( const std::string& );
+    std::map<std::string, std::string> parse_mdp( const std::string& );
+    REAL read_mdp( const std::string& );
+    bool relaxationConverged( const std::string&, double& );
+    std::string write_mdp_localRelaxation( const std::string& );
 
 
   public:
@@ -71,6 +98,11 @@ class EngineGMX : public EngineBase
     void runMDInitial();
     void runMDAppending( const std::size_t&, const std::size_t& );
     bool runRelaxation( const std::size_t& );
+    void runPrescreening( const std::size_t&, const std::size_t& );
     void runEnergyComputation( const std::size_t&, const std::size_t& );
     void cleanup( const std::size_t& );
+    void finish();
+    void setReactionRecords( const std::vector<std::pair<std::size_t, std::size_t>>& );
+    inline double getRelaxationLength() const { return relaxationLength; }
+    inline double getMDLength() const { return extensionTime; }
 };
\ No newline at end of file
@@ -0,0 +1,466 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "engine/engineMock.hpp"
+#include "parser/edrReader.hpp"
+#include "parser/xdrFile.hpp"
+#include "parser/trajectoryParserGMX.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <cstdio>
+#include <cmath>
+
+
+namespace
+{
+    // energy per atom around which the mock potential energies fluctuate
+    constexpr REAL MOCK_POTENTIAL_PER_ATOM = -10;
+    constexpr REAL MOCK_COULOMB_PER_ATOM   = -2;
+    constexpr REAL MOCK_LJ_PER_ATOM        = -1;
+
+    // trajectory length (ps) and number of energy frames
+    constexpr std::size_t MOCK_N_FRAMES = 11;
+    constexpr double      MOCK_FRAME_TIME = 1;
+}
+
+
+
+//
+// setup
+//
+void EngineMock::setup(const Parameters& parameters)
+{
+    latency = std::chrono::duration<double, std::milli>( parameters.getOption("mock.latency").as<REAL>() );
+    displacement = parameters.getOption("mock.displacement").as<REAL>();
+    noise = parameters.getOption("mock.noise").as<REAL>();
+
+    const auto seed = parameters.getOption("rseed").as<std::size_t>();
+    randomEngine.seed( seed != 0 ? seed : std::random_device{}() );
+
+    if( parameters.getOption("reaction.mc").as<bool>() )
+    {
+        computeLocalPotentialEnergies = parameters.getOption("reaction.computeLocalPotentialEnergy").as<bool>();
+        computeSolvationPotentialEnergies = parameters.getOption("reaction.computeSolvationPotentialEnergy").as<bool>();
+    }
+    readEnergyFiles = parameters.getOption("gromacs.edr").as<bool>();
+
+    // set rejected file policy (same file names as the gromacs engine)
+    saveRejectedFiles = parameters.getOption("reaction.saveRejected").as<bool>();
+    rejectedFilekeys = {".top", "-rs.gro", "-rs.edr", ".reactants.ndx", ".products.ndx"};
+    if( parameters.getOption("reaction.mc").as<bool>() && ! readEnergyFiles )    rejectedFilekeys.emplace_back("-rs.xvg");
+    writeTrajectories = parameters.getOption("gromacs.trr").as<bool>();
+    if( writeTrajectories )     rejectedFilekeys.emplace_back("-rs.trr");
+    if( parameters.getOption("gromacs.relaxationRadius").as<REAL>() > 0 )   rejectedFilekeys.emplace_back(".relaxation.ndx");
+    if( parameters.getOption("reaction.delayedAcceptance").as<bool>() )
+    {
+        rejectedFilekeys.emplace_back("-pre.edr");
+        if( ! readEnergyFiles )     rejectedFilekeys.emplace_back("-pre.xvg");
+    }
+
+    // check that topology/coordinate files are present
+    std::string topologyFile = parameters.getOption("gromacs.topology").as<std::string>();
+    std::string coordinatesFile = parameters.getOption("gromacs.coordinates").as<std::string>();
+    switch( parameters.getSimulationMode() )
+    {
+        case SIMMODE::NEW:
+            if( ! std::filesystem::exists(std::filesystem::current_path()/"0.top") )
+            {
+                rsmdLOG( "... copying '" << topologyFile << "' -> '0.top'" );
+                std::filesystem::copy_file(std::filesystem::current_path()/topologyFile, std::filesystem::current_path()/"0.top");
+            }
+            if( ! std::filesystem::exists(std::filesystem::current_path()/"0-md.gro") )
+            {
+                rsmdLOG( "... copying '" << coordinatesFile << "' -> '0-md.gro'" );
+                std::filesystem::copy_file(std::filesystem::current_path()/coordinatesFile, std::filesystem::current_path()/"0-md.gro");
+            }
+            break;
+
+        case SIMMODE::RESTART:
+            if( ! std::filesystem::exists( std::filesystem::current_path()/topologyFile ) )
+            {
+                rsmdCRITICAL("existence of topology file '" << topologyFile << "' is mandatory in order to restart the simulation" );
+            }
+            if( ! std::filesystem::exists( std::filesystem::current_path()/coordinatesFile ) )
+            {
+                rsmdCRITICAL("existence of coordinates file '" << coordinatesFile << "' is mandatory in order to restart the simulation" );
+            }
+            break;
+    }
+
+    verifyExecutable();
+}
+
+
+
+void EngineMock::verifyExecutable()
+{
+    rsmdLOG( "... using a mock md engine (latency = " << latency.count() << " ms, displacement = " << displacement << " nm, noise = " << noise << " kJ/mol)" );
+}
+
+
+
+void EngineMock::wait() const
+{
+    if( latency.count() > 0 )   std::this_thread::sleep_for( latency );
+}
+
+
+
+// md           in: cycle = X
+//              X-rs.gro -> X-md.gro, X-md.edr
+void EngineMock::runMD( const std::size_t& cycle )
+{
+    const std::string key = std::to_string(cycle);
+    try
+    {
+        wait();
+        auto nAtoms = writeCoordinates( key + "-rs.gro", key + "-md.gro", displacement, randomEngine, writeTrajectories ? key + "-md.trr" : "" );
+        writeEnergies( key + "-md.edr", nAtoms, noise, randomEngine );
+    }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "caught expection in EngineMock::runMD(): " << e.what() );
+    }
+}
+
+
+
+// md           in: cycle = 0
+//              0-md.gro -> 0-md.gro, 0-md.edr
+void EngineMock::runMDInitial()
+{
+    try
+    {
+        wait();
+        auto nAtoms = writeCoordinates( "0-md.gro", "0-md.gro", displacement, randomEngine, writeTrajectories ? "0-md.trr" : "" );
+        writeEnergies( "0-md.edr", nAtoms, noise, randomEngine );
+    }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "caught expection in EngineMock::runMDInitial(): " << e.what() );
+    }
+}
+
+
+
+// mdAppending  in: cycle = X, lastReactiveCycle = Y
+//              Y-md.gro -> Y-md.gro, Y-md.edr
+void EngineMock::runMDAppending( const std::size_t&, const std::size_t& lastReactiveCycle )
+{
+    const std::string key = std::to_string(lastReactiveCycle);
+    try
+    {
+        wait();
+        auto nAtoms = writeCoordinates( key + "-md.gro", key + "-md.gro", displacement, randomEngine, writeTrajectories ? key + "-md.trr" : "" );
+        writeEnergies( key + "-md.edr", nAtoms, noise, randomEngine );
+    }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "caught expection in EngineMock::runMDAppending(): " << e.what() );
+    }
+}
+
+
+
+// rs / relax   in: cycle = X
+//              X-rs.gro -> X-rs.gro, X-rs.edr
+bool EngineMock::runRelaxation( const std::size_t& cycle )
+{
+    enhance::ScopedTimer timer ("relaxation");
+    const std::string key = std::to_string(cycle);
+    bool statusRelaxation = true;
+    try
+    {
+        wait();
+        auto nAtoms = writeCoordinates( key + "-rs.gro", key + "-rs.gro", displacement, randomEngine, writeTrajectories ? key + "-rs.trr" : "" );
+        writeEnergies( key + "-rs.edr", nAtoms, noise, randomEngine );
+    }
+    catch(const std::exception& e)
+    {
+        rsmdWARNING( "caught expection in EngineMock::runRelaxation(): " << e.what() );
+        statusRelaxation = false;
+    }
+    return statusRelaxation;
+}
+
+
+
+// pre-screening    in: cycle = X, lastReactiveCycle = Y
+//                  X-rs.gro -> X-pre.edr (+ X-pre.xvg, Y-md.xvg)
+void EngineMock::runPrescreening( const std::size_t& currentCycle, const std::size_t& lastReactiveCycle )
+{
+    enhance::ScopedTimer timer ("prescreening");
+    const std::string key = std::to_string(currentCycle);
+    const std::string before = std::to_string(lastReactiveCycle) + "-md";
+    try
+    {
+        wait();
+        writeEnergies( key + "-pre.edr", countAtoms(key + "-rs.gro"), noise, randomEngine );
+        if( ! readEnergyFiles )
+        {
+            writeXvg( key + "-pre.edr", key + "-pre.xvg", {"Potential"} );
+            if( ! (energyCache && energyCache->contains(before + ".edr", "Potential")) )    writeXvg( before + ".edr", before + ".xvg", {"Potential"} );
+        }
+    }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "caught expection in EngineMock::runPrescreening(): " << e.what() );
+    }
+}
+
+
+
+// energy   in: cycle = X, lastReactiveCycle = Y
+//          same output files as EngineGMX::runEnergyComputation()
+void EngineMock::runEnergyComputation( const std::size_t& currentCycle, const std::size_t& lastReactiveCycle )
+{
+    enhance::ScopedTimer timer ("energyComputation");
+    const std::string before = std::to_string(lastReactiveCycle) + "-md";
+    const std::string after = std::to_string(currentCycle) + "-rs";
+    try
+    {
+        wait();
+        if( computeLocalPotentialEnergies )
+        {
+            writeEnergies( "reactants.edr", nReactantAtoms, noise, randomEngine );
+            writeEnergies( "products.edr", nProductAtoms, noise, randomEngine );
+            if( ! readEnergyFiles )
+            {
+                writeXvg( "reactants.edr", before + ".xvg", {"Potential"} );
+                writeXvg( "products.edr", after + ".xvg", {"Potential"} );
+            }
+            if( computeSolvationPotentialEnergies )
+            {
+                writeEnergies( "reactants_solvation.edr", nReactantAtoms, noise, randomEngine );
+                writeEnergies( "products_solvation.edr", nProductAtoms, noise, randomEngine );
+                if( ! readEnergyFiles )
+                {
+                    writeXvg( "reactants_solvation.edr", "reactants_solvation.xvg", {"Coul-SR:xxx-rest", "LJ-SR:xxx-rest"} );
+                    writeXvg( "products_solvation.edr", "products_solvation.xvg", {"Coul-SR:xxx-rest", "LJ-SR:xxx-rest"} );
+                }
+            }
+        }
+        else if( ! readEnergyFiles )
+        {
+            if( ! (energyCache && energyCache->contains(before + ".edr", "Potential")) )    writeXvg( before + ".edr", before + ".xvg", {"Potential"} );
+            writeXvg( after + ".edr", after + ".xvg", {"Potential"} );
+        }
+    }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "caught expection in EngineMock::runEnergyComputation(): " << e.what() );
+    }
+}
+
+
+
+//
+// simulated time of one (mock) md sequence: time span of the written energy frames
+//
+double EngineMock::getMDLength() const
+{
+    return (MOCK_N_FRAMES - 1) * MOCK_FRAME_TIME;
+}
+
+
+
+//
+// number of reactant/product atoms of the current reactive step
+//
+void EngineMock::setReactionRecords( const std::vector<std::pair<std::size_t, std::size_t>>& records )
+{
+    nReactantAtoms = records.size();
+    nProductAtoms = records.size();
+}
+
+
+
+//
+// cleanup: rename or delete all files produced during the rejected reactive step
+//
+void EngineMock::cleanup( const std::size_t& cycle )
+{
+    enhance::ScopedTimer timer ("cleanup");
+    std::string key = std::to_string(cycle);
+    std::filesystem::path thisPath = std::filesystem::current_path();
+
+    for( auto filename: rejectedFilekeys )
+    {
+        try
+        {
+            if( saveRejectedFiles )
+                std::filesystem::rename( thisPath/(key+filename), thisPath/("rejected-"+key+filename) );
+            else
+                std::filesystem::remove( thisPath/(key+filename) );
+        }
+        catch(const std::exception& e)
+        {
+            rsmdWARNING( "   caught exception while cleaning up " << thisPath/(key+filename) << ": " << e.what() );
+        }
+    }
+}
+
+
+
+//
+// write randomly displaced coordinates of a .gro file to another (or the same) .gro file
+//
+std::size_t EngineMock::writeCoordinates( const std::string& input, const std::string& output, REAL maxDisplacement, std::mt19937_64& engine, const std::string& trajectory )
+{
+    std::ifstream INPUT( input );
+    if( ! INPUT )   throw std::runtime_error("could not read file '" + input + "'");
+    std::vector<std::string> lines {};
+    std::string line {};
+    while( std::getline(INPUT, line) )  lines.emplace_back( std::move(line) );
+    INPUT.close();
+
+    if( lines.size() < 3 )  throw std::runtime_error("file '" + input + "' is not a valid .gro file");
+    const std::size_t nAtoms = std::stoul( lines[1] );
+    if( lines.size() < nAtoms + 3 ) throw std::runtime_error("file '" + input + "' is not a valid .gro file");
+
+    REALVEC box {};
+    std::stringstream( lines[nAtoms+2] ) >> box(0) >> box(1) >> box(2);
+
+    // (full precision frame for the .trr file)
+    TrajectoryFrame frame {};
+    if( ! trajectory.empty() )
+    {
+        frame.box = {box(0), 0, 0, 0, box(1), 0, 0, 0, box(2)};
+        frame.x.reserve( 3 * nAtoms );
+        frame.v.reserve( 3 * nAtoms );
+    }
+
+    std::uniform_real_distribution<REAL> distribution( -maxDisplacement, maxDisplacement );
+    char buffer[32];
+    for( std::size_t i=2; i<nAtoms+2; ++i )
+    {
+        auto& atomLine = lines[i];
+        if( atomLine.size() < 44 )  throw std::runtime_error("file '" + input + "' is not a valid .gro file");
+        for( std::size_t k=0; k<3; ++k )
+        {
+            REAL position = std::stof( atomLine.substr(20 + 8*k, 8) ) + distribution(engine);
+            if( box(k) > 0 )    position -= std::floor( position / box(k) ) * box(k);
+            std::snprintf( buffer, sizeof(buffer), "%8.3f", position );
+            atomLine.replace( 20 + 8*k, 8, buffer, 8 );
+            if( ! trajectory.empty() )  frame.x.push_back( position );
+        }
+        if( ! trajectory.empty() )
+        {
+            for( std::size_t k=0; k<3; ++k )    frame.v.push_back( atomLine.size() >= 68 ? std::stof( atomLine.substr(44 + 8*k, 8) ) : 0 );
+        }
+    }
+    if( ! trajectory.empty() )  TrajectoryParserGMX::writeTRR( trajectory, {frame} );
+
+    std::ofstream OUTPUT( output );
+    if( ! OUTPUT )  throw std::runtime_error("could not write file '" + output + "'");
+    for( const auto& l: lines )    OUTPUT << l << '\n';
+    return nAtoms;
+}
+
+
+
+//
+// number of atoms in a .gro file
+//
+std::size_t EngineMock::countAtoms( const std::string& filename )
+{
+    std::ifstream FILE( filename );
+    std::string line {};
+    if( ! std::getline(FILE, line) || ! std::getline(FILE, line) )
+    {
+        throw std::runtime_error("could not read number of atoms from file '" + filename + "'");
+    }
+    return std::stoul( line );
+}
+
+
+
+//
+// write energies of a system with the given number of atoms to a (single precision) .edr file
+//
+void EngineMock::writeEnergies( const std::string& filename, std::size_t nAtoms, REAL sigma, std::mt19937_64& engine )
+{
+    const std::vector<std::pair<std::string, REAL>> terms { {"Potential", MOCK_POTENTIAL_PER_ATOM},
+                                                            {"Coul-SR:xxx-rest", MOCK_COULOMB_PER_ATOM},
+                                                            {"LJ-SR:xxx-rest", MOCK_LJ_PER_ATOM} };
+    std::normal_distribution<REAL> distribution( 0, sigma );
+
+    XdrWriter file {};
+
+    // header: magic number, version, names + units
+    file.writeInt( -55555 );
+    file.writeInt( 5 );
+    file.writeInt( static_cast<int>(terms.size()) );
+    for( const auto& term: terms )
+    {
+        file.writeString( term.first );
+        file.writeString( "kJ/mol" );
+    }
+
+    // frames
+    for( std::size_t frame=0; frame<MOCK_N_FRAMES; ++frame )
+    {
+        file.writeFloat( -2e10f );
+        file.writeInt( -7777777 );
+        file.writeInt( 5 );                                 // version
+        file.writeDouble( frame * MOCK_FRAME_TIME );        // time
+        file.writeInt64( static_cast<std::int64_t>(frame) );// step
+        file.writeInt( 0 );                                 // nsum
+        file.writeInt64( 0 );                               // nsteps
+        file.writeDouble( MOCK_FRAME_TIME );                // dt
+        file.writeInt( static_cast<int>(terms.size()) );    // nre
+        file.writeInt( 0 );                                 // ndisre
+        file.writeInt( 0 );                                 // nblock
+        file.writeInt( 0 );                                 // e_size
+        file.writeInt( 0 );
+        file.writeInt( 0 );
+        for( const auto& term: terms )
+        {
+            file.writeFloat( static_cast<float>(term.second * nAtoms + distribution(engine)) );
+        }
+    }
+    file.save( filename );
+}
+
+
+
+//
+// write the requested energy terms of an .edr file to an .xvg file
+//
+void EngineMock::writeXvg( const std::string& edrFile, const std::string& xvgFile, const std::vector<std::string>& terms )
+{
+    EdrReader reader {};
+    reader.read( edrFile, terms );
+
+    std::ofstream FILE( xvgFile );
+    if( ! FILE )    throw std::runtime_error("could not write file '" + xvgFile + "'");
+
+    FILE << "# written by a mock md engine\n"
+         << "@    title \"Energies\"\n"
+         << "@    xaxis  label \"Time (ps)\"\n"
+         << "@    yaxis  label \"(kJ/mol)\"\n"
+         << "@TYPE xy\n";
+    for( std::size_t i=0; i<terms.size(); ++i )
+    {
+        FILE << "@ s" << i << " legend \"" << terms[i] << "\"\n";
+    }
+    for( std::size_t frame=0; frame<reader.getNFrames(); ++frame )
+    {
+        FILE << std::fixed << std::setprecision(6) << std::setw(12) << reader.getTimes()[frame];
+        for( std::size_t i=0; i<terms.size(); ++i )
+        {
+            FILE << "  " << std::setw(12) << reader.getValues(i)[frame];
+        }
+        FILE << '\n';
+    }
+}
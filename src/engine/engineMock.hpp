@@ -0,0 +1,96 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "engine/engineBase.hpp"
+
+#include <random>
+#include <chrono>
+#include <filesystem>
+
+//
+// a derived class that implements a mock md engine
+// derived from engineBase
+//
+// does not simulate anything, but produces plausible output files in the
+// same layout as the gromacs engine (i.e. X-md.gro, X-rs.gro, .edr, .xvg),
+// such that the simulation control flow of rs@md can be run (and timed)
+// without an md engine:
+//  - coordinates are randomly displaced (and wrapped into the box),
+//    with gromacs.trr also written to X-md.trr / X-rs.trr
+//  - potential energies scale with the number of atoms plus gaussian noise
+//  - every call takes (at least) the configured latency
+//
+// the static helper functions are also used by the fake gmx executable (tools/gmxMock.cpp)
+//
+
+class EngineMock : public EngineBase
+{
+  private:
+    std::chrono::duration<double, std::milli> latency {0};
+    REAL displacement {0.01};
+    REAL noise {1};
+
+    bool computeLocalPotentialEnergies {false};
+    bool computeSolvationPotentialEnergies {false};
+    bool readEnergyFiles {false};
+    bool writeTrajectories {false};
+    std::size_t nReactantAtoms {0};
+    std::size_t nProductAtoms {0};
+
+    bool        saveRejectedFiles {false};
+    std::vector<std::string>  rejectedFilekeys {};
+
+    std::mt19937_64 randomEngine {};
+
+    // wait for the configured latency
+    void wait() const;
+
+  public:
+    EngineMock() = default;
+    ~EngineMock() = default;
+
+    void setup(const Parameters&);
+    void verifyExecutable();
+    void runMD( const std::size_t& );
+    void runMDInitial();
+    void runMDAppending( const std::size_t&, const std::size_t& );
+    bool runRelaxation( const std::size_t& );
+    void runPrescreening( const std::size_t&, const std::size_t& );
+    void runEnergyComputation( const std::size_t&, const std::size_t& );
+    void cleanup( const std::size_t& );
+    void setReactionRecords( const std::vector<std::pair<std::size_t, std::size_t>>& );
+    double getMDLength() const;
+
+    //
+    // write randomly displaced coordinates of a .gro file to another (or the same) .gro file
+    // (and, if a name is given, in full precision + velocities to a .trr file),
+    // returns the number of atoms
+    //
+    static std::size_t writeCoordinates( const std::string&, const std::string&, REAL, std::mt19937_64&, const std::string& = "" );
+
+    //
+    // number of atoms in a .gro file
+    //
+    static std::size_t countAtoms( const std::string& );
+
+    //
+    // write energies (Potential, Coul-SR:xxx-rest, LJ-SR:xxx-rest) of a system with the given number of atoms
+    // to a (single precision) .edr file
+    //
+    static void writeEnergies( const std::string&, std::size_t, REAL, std::mt19937_64& );
+
+    //
+    // write the requested energy terms of an .edr file to an .xvg file
+    //
+    static void writeXvg( const std::string&, const std::string&, const std::vector<std::string>& );
+};
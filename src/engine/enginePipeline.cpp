@@ -0,0 +1,113 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "engine/enginePipeline.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <future>
+#include <exception>
+
+
+//
+// add a step to the pipeline
+//
+void EnginePipeline::add(const std::string& name, const std::vector<std::string>& inputs, const std::vector<std::string>& outputs, std::function<void()> task)
+{
+    steps.push_back( PipelineStep{name, inputs, outputs, std::move(task)} );
+}
+
+
+//
+// group steps into levels of independent steps
+//
+// step j depends on an earlier step i if
+//  - j reads a file that i writes     (read after write)
+//  - j writes a file that i reads     (write after read)
+//  - j writes a file that i writes    (write after write)
+//
+std::vector<std::vector<std::size_t>> EnginePipeline::plan() const
+{
+    auto intersects = [](const std::vector<std::string>& lhs, const std::vector<std::string>& rhs)
+    {
+        return std::any_of( lhs.begin(), lhs.end(), [&rhs](const auto& file){ return std::find(rhs.begin(), rhs.end(), file) != rhs.end(); } );
+    };
+
+    std::vector<std::size_t> levelOfStep (steps.size(), 0);
+    std::size_t nLevels = 0;
+    for( std::size_t j=0; j<steps.size(); ++j )
+    {
+        for( std::size_t i=0; i<j; ++i )
+        {
+            if( intersects(steps[j].inputs, steps[i].outputs)
+             || intersects(steps[j].outputs, steps[i].inputs)
+             || intersects(steps[j].outputs, steps[i].outputs) )
+            {
+                levelOfStep[j] = std::max( levelOfStep[j], levelOfStep[i] + 1 );
+            }
+        }
+        nLevels = std::max( nLevels, levelOfStep[j] + 1 );
+    }
+
+    std::vector<std::vector<std::size_t>> levels (nLevels);
+    for( std::size_t j=0; j<steps.size(); ++j )
+    {
+        levels[levelOfStep[j]].push_back(j);
+    }
+    return levels;
+}
+
+
+//
+// run all steps level by level
+// exceptions thrown by any step are re-thrown after all steps of its level finished
+//
+void EnginePipeline::run(bool concurrent)
+{
+    for( const auto& level: plan() )
+    {
+        #ifndef NDEBUG
+        std::string separator {""};
+        std::stringstream stream {};
+        for( const auto& ix: level ) { stream << separator << steps[ix].name; separator = ", "; }
+        rsmdDEBUG( "[EnginePipeline::run()] running level: " << stream.str() );
+        #endif
+
+        if( concurrent && level.size() > 1 )
+        {
+            std::vector<std::future<void>> futures {};
+            for( const auto& ix: level )
+            {
+                futures.emplace_back( std::async(std::launch::async, steps[ix].task) );
+            }
+            std::exception_ptr exception {nullptr};
+            for( auto& future: futures )
+            {
+                try
+                {
+                    future.get();
+                }
+                catch(...)
+                {
+                    if( ! exception )   exception = std::current_exception();
+                }
+            }
+            if( exception ) std::rethrow_exception(exception);
+        }
+        else
+        {
+            for( const auto& ix: level )
+            {
+                steps[ix].task();
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+
+#include <string>
+#include <vector>
+#include <functional>
+
+//
+// a small planner for md engine subprocess pipelines
+//
+// every step declares the files it reads and writes,
+// the planner derives the dependencies between steps from these files
+// and groups them into levels of mutually independent steps,
+// all steps within one level can be run concurrently
+//
+
+struct PipelineStep
+{
+    std::string              name {};
+    std::vector<std::string> inputs {};
+    std::vector<std::string> outputs {};
+    std::function<void()>    task {};
+};
+
+class EnginePipeline
+{
+  private:
+    std::vector<PipelineStep> steps {};
+
+  public:
+    //
+    // add a step to the pipeline
+    //
+    void add(const std::string&, const std::vector<std::string>&, const std::vector<std::string>&, std::function<void()>);
+
+    //
+    // group steps into levels of independent steps
+    // (steps keep their order of addition within a level)
+    //
+    std::vector<std::vector<std::size_t>> plan() const;
+
+    //
+    // run all steps level by level,
+    // either concurrently or sequentially within a level
+    //
+    void run(bool);
+
+    inline auto size()  const { return steps.size(); }
+    inline void clear()       { steps.clear(); }
+};
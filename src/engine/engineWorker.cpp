@@ -0,0 +1,237 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "engine/engineWorker.hpp"
+#include "enhance/utility.hpp"
+
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+
+//
+// helper functions for the line-based protocol
+//
+bool worker::writeAll(int fd, const char* data, std::size_t n)
+{
+    while( n > 0 )
+    {
+        ssize_t written = ::write(fd, data, n);
+        if( written < 0 && errno == EINTR ) continue;
+        if( written <= 0 )  return false;
+        data += written;
+        n -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool worker::writeAll(int fd, const std::string& data)
+{
+    return writeAll(fd, data.data(), data.size());
+}
+
+bool worker::readLine(int fd, std::string& line)
+{
+    line.clear();
+    char c;
+    while( true )
+    {
+        ssize_t n = ::read(fd, &c, 1);
+        if( n < 0 && errno == EINTR ) continue;
+        if( n <= 0 )    return false;
+        if( c == '\n' ) return true;
+        line.push_back(c);
+    }
+}
+
+bool worker::readBytes(int fd, std::size_t n, std::string& data)
+{
+    data.resize(n);
+    std::size_t position = 0;
+    while( position < n )
+    {
+        ssize_t received = ::read(fd, &data[position], n - position);
+        if( received < 0 && errno == EINTR ) continue;
+        if( received <= 0 ) return false;
+        position += static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+
+
+//
+// shut down worker if still running
+//
+EngineWorker::~EngineWorker()
+{
+    try
+    {
+        stop();
+    }
+    catch(const std::exception& e)
+    {
+        rsmdWARNING( "caught exception while shutting down engine worker: " << e.what() );
+    }
+}
+
+
+
+//
+// start worker process and wait until it accepts connections
+//
+void EngineWorker::start(const std::string& command)
+{
+    socketPath = ( std::filesystem::temp_directory_path() / ("rsmd-worker-" + std::to_string(getpid()) + ".sock") ).string();
+
+    std::vector<std::string> arguments {};
+    for( const auto& argument: enhance::splitString(command, ' ') )
+    {
+        if( ! argument.empty() )    arguments.push_back( argument );
+    }
+    arguments.push_back( socketPath );
+    std::vector<char*> argv {};
+    for( auto& argument: arguments )    argv.push_back( argument.data() );
+    argv.push_back( nullptr );
+
+    rsmdLOG( "... starting engine worker: " << command << " " << socketPath );
+    workerPID = fork();
+    switch( workerPID )
+    {
+        case -1:
+            throw std::runtime_error("fork failed");
+
+        case 0:
+            #ifdef __linux__
+            // terminate worker if rs@md dies
+            prctl( PR_SET_PDEATHSIG, SIGTERM );
+            #endif
+            execvp( argv[0], argv.data() );
+            std::exit(EXIT_FAILURE);
+
+        default:
+            break;
+    }
+
+    // wait for worker to accept connections
+    for( int attempt=0; attempt<200; ++attempt )
+    {
+        int status;
+        if( waitpid(workerPID, &status, WNOHANG) == workerPID )
+        {
+            workerPID = -1;
+            throw std::runtime_error("engine worker exited unexpectedly");
+        }
+        int fd = connect();
+        if( fd >= 0 )
+        {
+            ::close(fd);
+            rsmdLOG( "... engine worker is running" );
+            return;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds(50) );
+    }
+    stop();
+    throw std::runtime_error("engine worker does not accept connections on " + socketPath);
+}
+
+
+
+//
+// connect to worker socket, returns -1 on failure
+//
+int EngineWorker::connect() const
+{
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if( fd < 0 )    return -1;
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    std::strncpy( address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1 );
+    if( ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 )
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+
+//
+// execute command (argv) in current working directory with piped input,
+// returns the wait status and the process output
+//
+int EngineWorker::run(const std::vector<std::string>& arguments, const std::string& input, std::string& output) const
+{
+    int fd = connect();
+    if( fd < 0 )    throw std::runtime_error("could not connect to engine worker on " + socketPath);
+
+    std::stringstream request {};
+    request << "EXEC\n";
+    request << "CWD " << std::filesystem::current_path().string() << '\n';
+    for( const auto& argument: arguments )  request << "ARG " << argument << '\n';
+    request << "IN " << input.size() << '\n' << input;
+    request << "END\n";
+
+    std::string line {};
+    int status {0};
+    std::size_t nBytes {0};
+    bool okay = worker::writeAll(fd, request.str()) && worker::readLine(fd, line);
+    if( okay )
+    {
+        std::stringstream response (line);
+        std::string keyword {};
+        response >> keyword >> status >> nBytes;
+        okay = ( keyword == "STATUS" ) && ! response.fail() && worker::readBytes(fd, nBytes, output);
+    }
+    ::close(fd);
+
+    if( ! okay )    throw std::runtime_error("communication with engine worker failed");
+    return status;
+}
+
+
+
+//
+// shut down worker process
+//
+void EngineWorker::stop()
+{
+    if( workerPID <= 0 )    return;
+
+    int fd = connect();
+    if( fd >= 0 )
+    {
+        worker::writeAll(fd, "QUIT\n");
+        ::close(fd);
+    }
+    else
+    {
+        ::kill(workerPID, SIGTERM);
+    }
+    int status;
+    waitpid(workerPID, &status, 0);
+    workerPID = -1;
+    std::filesystem::remove(socketPath);
+}
@@ -0,0 +1,86 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+//
+// client for a long-lived worker process (see tools/rsmdWorker.cpp)
+// that executes md engine commands on behalf of rs@md,
+// such that the (large) rs@md process does not need to fork for every command
+//
+// communication happens via a UNIX socket using a line-based protocol,
+// every command uses its own connection (so commands can be submitted concurrently):
+//
+//   request:   EXEC\n
+//              CWD <working directory>\n
+//              ARG <argument>\n          (one line per argument, argv[0] first)
+//              IN <n>\n<n bytes>         (piped input)
+//              END\n
+//   response:  STATUS <wait status> <n>\n<n bytes>   (process output)
+//
+//   request:   QUIT\n                    (shut down worker)
+//
+
+class EngineWorker
+{
+  private:
+    std::string socketPath {};
+    pid_t       workerPID {-1};
+
+    int connect() const;
+
+  public:
+    EngineWorker() = default;
+    ~EngineWorker();
+
+    EngineWorker(const EngineWorker&) = delete;
+    EngineWorker& operator=(const EngineWorker&) = delete;
+
+    //
+    // start worker process (given command line + socket path as last argument)
+    // and wait until it accepts connections
+    //
+    void start(const std::string&);
+
+    //
+    // execute command (argv) in current working directory with piped input,
+    // returns the wait status and the process output
+    //
+    int run(const std::vector<std::string>&, const std::string&, std::string&) const;
+
+    //
+    // shut down worker process
+    //
+    void stop();
+
+    inline bool running() const { return workerPID > 0; }
+};
+
+
+//
+// helper functions for the line-based protocol
+//
+namespace worker
+{
+    // write all bytes to file descriptor
+    bool writeAll(int, const char*, std::size_t);
+    bool writeAll(int, const std::string&);
+
+    // read a line (without '\n') / exactly n bytes from file descriptor
+    bool readLine(int, std::string&);
+    bool readBytes(int, std::size_t, std::string&);
+}
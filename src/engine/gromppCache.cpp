@@ -0,0 +1,119 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "engine/gromppCache.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+
+//
+// setup cache directory and maximum number of entries
+//
+void GromppCache::setup(const std::filesystem::path& dir, const std::size_t& maxEntries)
+{
+    directory = dir;
+    capacity = std::max<std::size_t>(maxEntries, 1);
+    std::filesystem::create_directories(directory);
+}
+
+
+//
+// compute key from input files and additional arguments
+//
+std::uint64_t GromppCache::key(const std::vector<std::string>& inputFiles, const std::string& arguments) const
+{
+    auto hash = enhance::hashString(arguments);
+    for( const auto& file: inputFiles )
+    {
+        hash = enhance::hashFile(file, hash);
+    }
+    return hash;
+}
+
+
+//
+// path of a cached file, named according to key and file extension
+//
+std::filesystem::path GromppCache::entryPath(const std::uint64_t& key, const std::string& file) const
+{
+    std::stringstream name {};
+    name << std::hex << std::setw(16) << std::setfill('0') << key << std::filesystem::path(file).extension().string();
+    return directory / name.str();
+}
+
+
+//
+// try to restore the given output files from the cache
+//
+bool GromppCache::restore(const std::uint64_t& key, const std::vector<std::string>& outputFiles)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = std::find(entries.begin(), entries.end(), key);
+    if( it == entries.end() )
+    {
+        ++ nMisses;
+        return false;
+    }
+
+    for( const auto& file: outputFiles )
+    {
+        std::filesystem::copy_file( entryPath(key, file), file, std::filesystem::copy_options::overwrite_existing );
+    }
+    entries.splice(entries.begin(), entries, it);
+    ++ nHits;
+    rsmdDEBUG( "[GromppCache::restore()] cache hit for key " << std::hex << key << std::dec );
+    return true;
+}
+
+
+//
+// store the given output files in the cache
+// (evicts least recently used entries if the cache is full)
+//
+void GromppCache::store(const std::uint64_t& key, const std::vector<std::string>& outputFiles)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if( std::find(entries.begin(), entries.end(), key) != entries.end() ) return;
+
+    for( const auto& file: outputFiles )
+    {
+        std::filesystem::copy_file( file, entryPath(key, file), std::filesystem::copy_options::overwrite_existing );
+    }
+    entries.push_front(key);
+
+    while( entries.size() > capacity )
+    {
+        for( const auto& file: outputFiles )
+        {
+            std::filesystem::remove( entryPath(entries.back(), file) );
+        }
+        entries.pop_back();
+    }
+}
+
+
+
+//
+// remove all entries and the cache directory
+//
+void GromppCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.clear();
+    std::error_code error {};
+    std::filesystem::remove_all( directory, error );
+    if( error )     rsmdWARNING( "could not remove the grompp cache " << directory << ": " << error.message() );
+}
@@ -0,0 +1,81 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+#include "enhance/utility.hpp"
+
+#include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <filesystem>
+
+//
+// a cache for preprocessed md engine input (e.g. gromacs .tpr files)
+//
+// entries are keyed by a content hash of all input files
+// (+ any additional command line arguments),
+// which allows to skip repeated identical preprocessing steps
+//
+// note: files that are only included indirectly (e.g. .itp files)
+//       are not part of the key, they are assumed not to change during a run
+// note: the index of entries is only kept in memory, i.e. the cache is
+//       valid for one run only and its directory is removed at the end of the run
+//
+
+class GromppCache
+{
+  private:
+    std::filesystem::path directory {".rsmd-grompp-cache"};
+    std::size_t           capacity {16};
+    std::list<std::uint64_t> entries {};    // most recently used first
+    std::mutex            mutex {};
+
+    std::size_t nHits {0};
+    std::size_t nMisses {0};
+
+    std::filesystem::path entryPath(const std::uint64_t&, const std::string&) const;
+
+  public:
+    //
+    // setup cache directory and maximum number of entries
+    //
+    void setup(const std::filesystem::path&, const std::size_t&);
+
+    //
+    // compute key from input files and additional arguments
+    //
+    std::uint64_t key(const std::vector<std::string>&, const std::string&) const;
+
+    //
+    // try to restore the given output files from the cache,
+    // returns false if there is no entry for the given key
+    //
+    bool restore(const std::uint64_t&, const std::vector<std::string>&);
+
+    //
+    // store the given output files in the cache
+    //
+    void store(const std::uint64_t&, const std::vector<std::string>&);
+
+    //
+    // remove all entries and the cache directory
+    //
+    void clear();
+
+    //
+    // some getters
+    //
+    const auto& getHits()   const { return nHits; }
+    const auto& getMisses() const { return nMisses; }
+};
@@ -0,0 +1,110 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+//
+// binary indexed (Fenwick) tree of non-negative weights,
+// e.g. the rates of all reaction candidates:
+// - build in O(n)
+// - change of a single weight, total weight and weighted selection in O(log n)
+//
+
+namespace enhance
+{
+    class FenwickTree
+    {
+      private:
+        std::vector<double> tree {};        // 1-based partial sums
+        std::vector<double> weights {};
+        std::size_t         highestPower {0};   // highest power of 2 <= size
+        std::size_t         nPositive {0};      // # weights > 0 (to return exactly 0 if all are gone)
+
+      public:
+        FenwickTree() = default;
+        explicit FenwickTree(const std::vector<double>& w) { assign(w); }
+
+        //
+        // (re)build the tree from the given weights
+        //
+        inline void assign(const std::vector<double>& w)
+        {
+            weights = w;
+            tree.assign( weights.size() + 1, 0 );
+            nPositive = 0;
+            for( std::size_t i=1; i<=weights.size(); ++i )
+            {
+                tree[i] += weights[i-1];
+                if( weights[i-1] > 0 )  ++ nPositive;
+                const std::size_t parent = i + (i & (~i + 1));
+                if( parent <= weights.size() )  tree[parent] += tree[i];
+            }
+            highestPower = 1;
+            while( highestPower * 2 <= weights.size() )     highestPower *= 2;
+        }
+
+        //
+        // set the weight of element i
+        //
+        inline void update(std::size_t i, double weight)
+        {
+            const double delta = weight - weights[i];
+            if( delta == 0 )    return;
+            if( weights[i] > 0 )    -- nPositive;
+            if( weight > 0 )        ++ nPositive;
+            weights[i] = weight;
+            for( ++i; i<tree.size(); i += (i & (~i + 1)) )    tree[i] += delta;
+        }
+
+        //
+        // sum of the weights of elements 0 ... i-1
+        //
+        inline double prefix(std::size_t i) const
+        {
+            double sum {0};
+            for( ; i>0; i -= (i & (~i + 1)) )  sum += tree[i];
+            return sum;
+        }
+
+        inline double total() const { return ( nPositive > 0 ? prefix(weights.size()) : 0 ); }
+
+        //
+        // element i with prefix(i) <= value < prefix(i+1), i.e. for a value uniformly drawn
+        // from [0, total()) element i is selected with probability weight(i) / total()
+        // (round-off residue of removed weights in the partial sums can lead to an element with weight 0,
+        //  then the next element with a positive weight is selected, at the upper end the last one)
+        //
+        inline std::size_t find(double value) const
+        {
+            std::size_t position {0};
+            for( std::size_t step=highestPower; step>0; step /= 2 )
+            {
+                if( position + step < tree.size() && tree[position + step] <= value )
+                {
+                    position += step;
+                    value -= tree[position];
+                }
+            }
+            for( auto next=position; next<weights.size(); ++next )
+            {
+                if( weights[next] > 0 )     return next;
+            }
+            while( position > 0 && (position >= weights.size() || weights[position] <= 0) )     -- position;
+            return position;
+        }
+
+        inline double weight(std::size_t i) const { return weights[i]; }
+        inline std::size_t size() const { return weights.size(); }
+    };
+}
@@ -0,0 +1,262 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "enhance/logging.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+
+enhance::Logger enhance::Log {};
+
+
+namespace
+{
+    int levelFromName(const std::string& name)
+    {
+        if( name == "warning" )     return static_cast<int>(enhance::LOGLEVEL::WARNING);
+        if( name == "log" )         return static_cast<int>(enhance::LOGLEVEL::LOG);
+        if( name == "verbose" )     return static_cast<int>(enhance::LOGLEVEL::VERBOSE);
+        if( name == "debug" )       return static_cast<int>(enhance::LOGLEVEL::DEBUG);
+        throw std::invalid_argument("unknown log level '" + name + "'");
+    }
+}
+
+
+
+//
+// ring buffer with a capacity of (at least) n messages
+//
+enhance::LogRing::LogRing(std::size_t n)
+{
+    std::size_t capacity {2};
+    while( capacity < n )   capacity *= 2;
+    slots = std::make_unique<Slot[]>(capacity);
+    mask = capacity - 1;
+    for( std::size_t i=0; i<capacity; ++i )     slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+
+//
+// push a message (moved from), returns false if the ring is full
+//
+bool enhance::LogRing::push(LOGLEVEL level, std::string& text)
+{
+    auto position = head.load(std::memory_order_relaxed);
+    Slot* slot {nullptr};
+    while( true )
+    {
+        slot = &slots[position & mask];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if( difference == 0 )
+        {
+            if( head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed) )    break;
+        }
+        else if( difference < 0 )
+        {
+            return false;
+        }
+        else
+        {
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
+    slot->level = level;
+    slot->text = std::move(text);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+
+//
+// pop a message, returns false if the ring is empty
+// (single consumer only)
+//
+bool enhance::LogRing::pop(LOGLEVEL& level, std::string& text)
+{
+    const auto position = tail.load(std::memory_order_relaxed);
+    auto& slot = slots[position & mask];
+    if( slot.sequence.load(std::memory_order_acquire) != position + 1 )     return false;
+    level = slot.level;
+    text = std::move(slot.text);
+    slot.text.clear();
+    slot.sequence.store(position + mask + 1, std::memory_order_release);
+    tail.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+
+
+enhance::Logger::Logger()
+{
+#ifndef NDEBUG
+    for( auto& level: levels )  level.store( static_cast<int>(LOGLEVEL::DEBUG) );
+#else
+    for( auto& level: levels )  level.store( static_cast<int>(LOGLEVEL::LOG) );
+#endif
+}
+
+enhance::Logger::~Logger()
+{
+    stopAsync();
+}
+
+
+//
+// set the level of all / of one subsystem
+//
+void enhance::Logger::setLevel(const std::string& name)
+{
+    const auto value = levelFromName(name);
+    for( auto& level: levels )  level.store(value);
+}
+
+void enhance::Logger::setLevel(LOGSUBSYSTEM subsystem, const std::string& name)
+{
+    levels[static_cast<int>(subsystem)].store( levelFromName(name) );
+}
+
+
+//
+// start / stop the background writer thread
+//
+void enhance::Logger::startAsync(std::size_t capacity)
+{
+    if( async.load() )  return;
+    ring = std::make_unique<LogRing>(capacity);
+    running.store(true);
+    writer = std::thread( [this](){ drain(); } );
+    async.store(true);
+}
+
+void enhance::Logger::stopAsync()
+{
+    if( ! async.load() )    return;
+
+    // new messages are written directly, messages already on their way to the ring
+    // (counted in pending before async is checked, see submit) are still written by the writer thread
+    async.store(false);
+    while( pending.load() > 0 )     std::this_thread::sleep_for( std::chrono::microseconds(100) );
+    running.store(false);
+    if( writer.joinable() )     writer.join();
+    std::cout << std::flush;
+}
+
+
+//
+// background writer: write messages as long as there are any,
+// flush std::cout whenever the ring runs empty
+//
+void enhance::Logger::drain()
+{
+    LOGLEVEL level {};
+    std::string text {};
+    bool written {false};
+    while( true )
+    {
+        if( ring->pop(level, text) )
+        {
+            write(level, text);
+            pending.fetch_sub(1, std::memory_order_release);
+            written = true;
+        }
+        else if( written )
+        {
+            std::cout << std::flush;
+            written = false;
+        }
+        else if( ! running.load() )
+        {
+            break;
+        }
+        else
+        {
+            std::this_thread::sleep_for( std::chrono::microseconds(200) );
+        }
+    }
+}
+
+
+//
+// wait until all queued messages have been written
+//
+void enhance::Logger::flush()
+{
+    if( async.load() )
+    {
+        while( pending.load(std::memory_order_acquire) > 0 )    std::this_thread::sleep_for( std::chrono::microseconds(100) );
+    }
+    std::cout << std::flush;
+}
+
+
+//
+// write a message to the stream of its level
+//
+void enhance::Logger::write(LOGLEVEL level, const std::string& text)
+{
+    switch( level )
+    {
+        case LOGLEVEL::ERROR:
+            std::cout << std::flush;
+            std::cerr << text;
+            break;
+        case LOGLEVEL::WARNING:
+            std::cout << std::flush;
+            std::clog << text;
+            break;
+        case LOGLEVEL::LOG:
+        case LOGLEVEL::VERBOSE:
+            std::cout << text;
+            break;
+        case LOGLEVEL::DEBUG:
+            std::cerr << text;
+            break;
+    }
+}
+
+
+//
+// per-thread stream to format a message in
+// (formatting flags persist, e.g. std::setprecision, as they used to on std::cout)
+//
+std::ostringstream& enhance::Logger::formatter()
+{
+    thread_local std::ostringstream stream {};
+    return stream;
+}
+
+
+//
+// submit the message formatted in formatter()
+//
+void enhance::Logger::submit(LOGLEVEL level)
+{
+    auto& stream = formatter();
+    std::string text = stream.str();
+    stream.str( std::string() );
+
+    if( level != LOGLEVEL::ERROR )
+    {
+        // (pending is incremented before async is checked, so that stopAsync waits for this message)
+        pending.fetch_add(1);
+        if( async.load() )
+        {
+            // back pressure: wait for the writer if the ring is full
+            while( ! ring->push(level, text) )  std::this_thread::yield();
+            return;
+        }
+        pending.fetch_sub(1);
+    }
+    write(level, text);
+}
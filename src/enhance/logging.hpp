@@ -0,0 +1,142 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+//
+// logging backend of the rsmdLOG, rsmdVERBOSE, rsmdWARNING, ... macros (see definitions.hpp)
+//
+// - every message belongs to a subsystem, given by the source directory of the calling file
+//   (src/container, src/engine, ...), and has a level
+// - levels can be set at runtime per subsystem (log.level, log.<subsystem>),
+//   the macros only format a message if its level is enabled,
+//   i.e. disabled messages cost one (relaxed) atomic load
+// - messages are written either directly (default) or, if log.async is set, pushed to
+//   a lock-free ring buffer that is drained by a background writer thread
+// - errors (rsmdCRITICAL, rsmdEXIT) are always written directly, after draining the ring buffer
+//
+
+namespace enhance
+{
+    enum class LOGLEVEL : int { ERROR, WARNING, LOG, VERBOSE, DEBUG };
+    enum class LOGSUBSYSTEM : int { GENERAL, CONTAINER, CONTROL, ENGINE, ENHANCE, PARAMETERS, PARSER, REACTION, N };
+
+    constexpr std::array<std::string_view, static_cast<int>(LOGSUBSYSTEM::N)> LOGSUBSYSTEM_NAMES {
+        "general", "container", "control", "engine", "enhance", "parameters", "parser", "reaction" };
+
+    //
+    // subsystem of a source file: the directory after the last "src/" in its path
+    // (evaluated at compile time with __FILE__)
+    //
+    constexpr LOGSUBSYSTEM logSubsystem(std::string_view file)
+    {
+        const auto src = file.rfind("src/");
+        if( src == std::string_view::npos )     return LOGSUBSYSTEM::GENERAL;
+        const auto directory = file.substr( src + 4, file.find('/', src + 4) - (src + 4) );
+        for( std::size_t i=1; i<LOGSUBSYSTEM_NAMES.size(); ++i )
+        {
+            if( LOGSUBSYSTEM_NAMES[i] == directory )    return static_cast<LOGSUBSYSTEM>(i);
+        }
+        return LOGSUBSYSTEM::GENERAL;
+    }
+
+
+
+    //
+    // bounded multi-producer single-consumer ring buffer of log messages
+    // (sequence numbers per slot, see D. Vyukov's bounded MPMC queue)
+    //
+    class LogRing
+    {
+      private:
+        struct Slot
+        {
+            std::atomic<std::size_t> sequence {0};
+            LOGLEVEL    level {LOGLEVEL::LOG};
+            std::string text {};
+        };
+
+        std::unique_ptr<Slot[]> slots {};
+        std::size_t mask {0};
+        alignas(64) std::atomic<std::size_t> head {0};      // next slot to write (producers)
+        alignas(64) std::atomic<std::size_t> tail {0};      // next slot to read (consumer)
+
+      public:
+        explicit LogRing(std::size_t);
+
+        bool push(LOGLEVEL, std::string&);
+        bool pop(LOGLEVEL&, std::string&);
+    };
+
+
+
+    class Logger
+    {
+      private:
+        std::array<std::atomic<int>, static_cast<int>(LOGSUBSYSTEM::N)> levels {};
+
+        std::unique_ptr<LogRing> ring {nullptr};
+        std::atomic<bool>        async {false};
+        std::atomic<bool>        running {false};
+        std::atomic<std::size_t> pending {0};       // messages submitted but not yet written
+        std::thread              writer {};
+
+        void drain();
+        static void write(LOGLEVEL, const std::string&);
+
+      public:
+        Logger();
+        ~Logger();
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        //
+        // set the level of all / of one subsystem,
+        // level names: warning, log, verbose, debug
+        //
+        void setLevel(const std::string&);
+        void setLevel(LOGSUBSYSTEM, const std::string&);
+
+        //
+        // start / stop the background writer thread
+        //
+        void startAsync(std::size_t);
+        void stopAsync();
+
+        //
+        // wait until all queued messages have been written
+        //
+        void flush();
+
+        inline bool isEnabled(LOGLEVEL level, LOGSUBSYSTEM subsystem) const
+        {
+            return static_cast<int>(level) <= levels[static_cast<int>(subsystem)].load(std::memory_order_relaxed);
+        }
+
+        //
+        // per-thread stream to format a message in, respectively submit the formatted message
+        //
+        static std::ostringstream& formatter();
+        void submit(LOGLEVEL);
+    };
+
+    // global logger
+    extern Logger Log;
+}
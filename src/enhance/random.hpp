@@ -20,6 +20,7 @@
 #include <random>
 #include <algorithm>
 #include <iostream>
+#include <cstdint>
 
 // 
 // random number generator and random iterator utility
@@ -46,6 +47,22 @@ namespace enhance
     T random(const T& a, const T& b);
 
 
+    // counter-based random number from [0,1): an independent stream per (seed, index),
+    // i.e. reproducible irrespective of the order and the thread in which numbers are drawn
+    inline std::uint64_t splitmix64(std::uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    inline double streamRandom(std::uint64_t seed, std::uint64_t index)
+    {
+        return static_cast<double>( splitmix64(seed ^ splitmix64(index)) >> 11 ) * 0x1.0p-53;
+    }
+
+
 
     // shuffle randomly
     template<class D>
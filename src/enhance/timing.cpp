@@ -0,0 +1,80 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "enhance/timing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+
+enhance::TimingRegistry enhance::Timings {};
+
+
+void enhance::TimingRegistry::add(std::string_view name, double seconds)
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    auto it = phases.find(name);
+    if( it == phases.end() )    it = phases.emplace( std::string(name), Phase{} ).first;
+    it->second.samples.push_back( seconds );
+    it->second.cycleTotal += seconds;
+}
+
+
+double enhance::TimingRegistry::getCycleTotal(std::string_view name) const
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    auto it = phases.find(name);
+    return ( it == phases.end() ? 0 : it->second.cycleTotal );
+}
+
+
+void enhance::TimingRegistry::nextCycle()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    for( auto& phase: phases )  phase.second.cycleTotal = 0;
+}
+
+
+std::string enhance::TimingRegistry::summary() const
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    std::stringstream stream {};
+    stream << std::setw(20) << std::left << "phase" << std::right
+           << std::setw(8) << "calls"
+           << std::setw(12) << "total/s"
+           << std::setw(12) << "min/ms"
+           << std::setw(12) << "median/ms"
+           << std::setw(12) << "p95/ms"
+           << std::setw(12) << "max/ms" << '\n';
+
+    for( const auto& [name, phase]: phases )
+    {
+        auto samples = phase.samples;
+        std::sort( samples.begin(), samples.end() );
+        // nearest-rank percentile
+        auto percentile = [&samples](double p){
+            auto rank = static_cast<std::size_t>( std::ceil(p * samples.size()) );
+            return samples[ std::max<std::size_t>(rank, 1) - 1 ];
+        };
+        stream << std::setw(20) << std::left << name << std::right
+               << std::setw(8) << samples.size()
+               << std::fixed << std::setprecision(3)
+               << std::setw(12) << std::accumulate( samples.begin(), samples.end(), 0.0 )
+               << std::setw(12) << 1000 * samples.front()
+               << std::setw(12) << 1000 * percentile(0.5)
+               << std::setw(12) << 1000 * percentile(0.95)
+               << std::setw(12) << 1000 * samples.back() << '\n';
+    }
+    return stream.str();
+}
@@ -0,0 +1,100 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// timing instrumentation
+//
+// scoped timers add the wall time of a named phase (e.g. "search", "gmx mdrun")
+// to the global registry enhance::Timings, which keeps
+//  - all samples per phase (for min/median/p95/max at shutdown) and
+//  - the total per phase of the current cycle (for the statistics file)
+//
+// when disabled, a scoped timer costs one (relaxed) atomic load
+//
+
+namespace enhance
+{
+    class TimingRegistry
+    {
+      private:
+        struct Phase
+        {
+            std::vector<double> samples {};     // seconds
+            double cycleTotal {0};
+        };
+
+        std::atomic<bool>   enabled {false};
+        mutable std::mutex  mutex {};
+        std::map<std::string, Phase, std::less<>> phases {};
+
+      public:
+        inline void enable(bool value) { enabled.store(value); }
+        inline bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+        //
+        // add a sample (seconds) to a phase
+        //
+        void add(std::string_view, double);
+
+        //
+        // total time (seconds) of a phase within the current cycle
+        //
+        double getCycleTotal(std::string_view) const;
+
+        //
+        // reset the totals of the current cycle
+        //
+        void nextCycle();
+
+        //
+        // summary table with # calls, total, min, median, p95 and max per phase
+        //
+        std::string summary() const;
+    };
+
+    // global registry
+    extern TimingRegistry Timings;
+
+
+    class ScopedTimer
+    {
+      private:
+        std::string_view name;
+        bool active {false};
+        std::chrono::steady_clock::time_point start {};
+
+      public:
+        explicit ScopedTimer(std::string_view n)
+            : name(n)
+            , active(Timings.isEnabled())
+        {
+            if( active )    start = std::chrono::steady_clock::now();
+        }
+
+        ~ScopedTimer()
+        {
+            if( active )    Timings.add( name, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() );
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+    };
+}
@@ -54,3 +54,35 @@ std::vector<std::string> enhance::splitString(const std::string& input, char del
 
 
 
+std::uint64_t enhance::hashString(const std::string& input, std::uint64_t hash)
+{
+    for( const auto& c: input )
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+
+
+std::uint64_t enhance::hashFile(const std::string& filename, std::uint64_t hash)
+{
+    std::ifstream FILE( filename, std::ios::binary );
+    if( ! FILE )
+    {
+        throw std::runtime_error("could not read file '" + filename + "' for hashing");
+    }
+
+    // hash in chunks of 64kB
+    std::vector<char> buffer (1 << 16);
+    while( FILE.read(buffer.data(), buffer.size()) || FILE.gcount() > 0 )
+    {
+        for( std::streamsize i=0; i<FILE.gcount(); ++i )
+        {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
@@ -18,6 +18,7 @@
 
 #include <random>
 #include <algorithm>
+#include <cstdint>
 
 // 
 // some useful functionality
@@ -31,6 +32,13 @@ namespace enhance
     // split string at every occurence of char
     std::vector<std::string> splitString(const std::string&, char);
 
+    // compute a (non-cryptographic) 64bit FNV-1a hash of a file's content,
+    // optionally continuing from a given hash value
+    std::uint64_t hashFile(const std::string&, std::uint64_t = 14695981039346656037ull);
+
+    // compute a (non-cryptographic) 64bit FNV-1a hash of a string
+    std::uint64_t hashString(const std::string&, std::uint64_t = 14695981039346656037ull);
+
 }
 
 
@@ -39,6 +39,7 @@ void Parameters::read(int argc, char* argv[])
         ("output,o",  po::value<std::string>()->default_value("RESTART"), "output file where program options for a restart are written to")
         ("rseed",     po::value<std::size_t>()->default_value(0), "random seed (0: true random, else: given seed)")
         ("statistics", po::value<std::string>()->default_value("statistics.data"), "output file for statistics on reactive steps")
+        ("statisticsFormat", po::value<std::string>()->default_value("text"), "format of the statistics file: text or binary (read binary files with rsmd-statistics)")
     ;
 
     // ... helper options
@@ -57,6 +58,10 @@ void Parameters::read(int argc, char* argv[])
         ("simulation.restart", po::bool_switch(), "restart simulation and append to existing simulation files")
         ("simulation.restartCycle", po::value<std::size_t>(), "restart with this cycle")
         ("simulation.restartCycleFiles", po::value<std::size_t>(), "append to simulation files named according to this cycle")
+        ("simulation.scratch", po::value<std::string>()->default_value(""), "write per-cycle files to a (fast, local) scratch directory within this directory, e.g. /dev/shm")
+        ("simulation.archive", po::value<std::string>()->default_value(""), "add per-cycle .top/.gro/.ndx files that are not required anymore to this (compressed) archive file, extract with rsmd-archive")
+        ("simulation.timing", po::bool_switch(), "measure the time spent in every phase of a cycle, write it to the statistics file and print a summary at shutdown")
+        ("simulation.worker", po::value<std::string>()->default_value(""), "execute md engine commands via a long-lived worker process started with this command line, e.g. rsmd-worker")
     ;
     
     // ... reaction related options:
@@ -65,11 +70,13 @@ void Parameters::read(int argc, char* argv[])
         ("reaction.file", po::value<std::vector<std::string>>()->multitoken(), "reaction input files (multiple args or occurrences possible)")
         ("reaction.mc",    po::bool_switch(), "use Metropolis MC acceptance criterion")
         ("reaction.rate",  po::bool_switch(), "use rate-based acceptance criterion")
+        ("reaction.kmc",   po::bool_switch(), "use rejection-free kinetic Monte Carlo with the rates of the reaction templates (in 1/ps)")
         ("reaction.frequency",   po::value<REAL>(), "attempt frequency for reactive steps \n(required if reaction.rates)")
         ("reaction.temperature", po::value<REAL>(), "simulation temperature (required if reaction.mc)" )
         ("reaction.averagePotentialEnergy", po::value<REAL>()->default_value(0.0), "time interval over which to average potential energies (only if reaction.mc)" )
         ("reaction.computeLocalPotentialEnergy", po::bool_switch(), "compute local potential energies (only if reaction.mc)")
         ("reaction.computeSolvationPotentialEnergy", po::bool_switch(), "compute solvation interaction (only if reaction.mc)")
+        ("reaction.delayedAcceptance", po::bool_switch(), "pre-screen candidates with the single-point energy of the unrelaxed products, relax only candidates that pass (delayed acceptance, only if reaction.mc, not with local potential energies)")
         ("reaction.saveRejected", po::bool_switch(), "save md files from failed reactive steps instead of deleting them")
     ;
 
@@ -85,12 +92,43 @@ void Parameters::read(int argc, char* argv[])
         ("gromacs.nt",             po::value<int>()->default_value(0), "total number of threads to start (0 is guess)")
         ("gromacs.ntmpi",          po::value<int>()->default_value(0), "number of thread-MPI ranks to start (0 is guess)")
         ("gromacs.ntomp",          po::value<int>()->default_value(0), "number of OpenMP threads per MPI rank to start (0 is guess)")
+        ("gromacs.edr",            po::bool_switch(), "whether or not energies should be read directly from .edr files (instead of via gmx energy and .xvg files)")
+        ("gromacs.trr",            po::bool_switch(), "whether or not coordinates/velocities should be read from the last frame of .trr files (full precision, needs nstxout/nstvout) instead of .gro files")
+        ("gromacs.nativeSubsets",  po::bool_switch(), "whether or not reactant/product atoms should be cut out of trajectories in-process (instead of via gmx trjconv)")
+        ("gromacs.pipeline",       po::bool_switch(), "whether or not independent gromacs calls (e.g. for energy computation) should run concurrently (concurrent energy reruns share the threads)")
+        ("gromacs.gromppCache",    po::value<std::size_t>()->default_value(0), "number of preprocessed .tpr files to keep in a cache keyed by input content (0 is no caching), the cache directory .rsmd-grompp-cache is removed at the end of the run")
+        ("gromacs.relaxationRadius", po::value<REAL>()->default_value(0), "relax only the products and all molecules within this distance (nm) of them, everything else is frozen (0 is relaxing the whole box)")
+        ("gromacs.relaxationExtensions", po::value<std::size_t>()->default_value(0), "maximum number of times the relaxation is extended by its length (gromacs.mdp.relaxation) while the potential energy keeps changing (0 is a fixed relaxation length)")
+        ("gromacs.relaxationTolerance", po::value<REAL>()->default_value(1), "the relaxation is extended while the mean potential energy (kJ/mol) of the second half of its last segment differs from the first half by more than this")
     ;
 
+    // ... mock md engine related options
+    po::options_description mockOptions("Mock md engine related options (simulation.engine = mock, uses the gromacs file formats)");
+    mockOptions.add_options()
+        ("mock.latency",      po::value<REAL>()->default_value(0), "time (ms) every call of the mock md engine takes")
+        ("mock.displacement", po::value<REAL>()->default_value(0.01), "maximum random displacement (nm) of atoms per md sequence")
+        ("mock.noise",        po::value<REAL>()->default_value(1), "standard deviation (kJ/mol) of the mock potential energies")
+    ;
+
+
+    // ... logging related options
+    po::options_description logOptions("Logging related options");
+    logOptions.add_options()
+        ("log.level",  po::value<std::string>()->default_value(""), "log level: warning, log, verbose or debug (default: debug for debug builds, else log)")
+        ("log.async",  po::bool_switch(), "write log messages from a background thread")
+        ("log.buffer", po::value<std::size_t>()->default_value(4096), "# of log messages that can be queued for the background thread (only if log.async)")
+    ;
+    for( const auto& subsystem: enhance::LOGSUBSYSTEM_NAMES )
+    {
+        const std::string name = "log." + std::string(subsystem);
+        logOptions.add_options()
+            (name.c_str(), po::value<std::string>()->default_value(""), ("log level for messages from src/" + std::string(subsystem) + " (overrides log.level)").c_str());
+    }
+
 
     // ... merge all options 
     po::options_description allOptions("");
-    allOptions.add(generalOptions).add(helpOptions).add(simulationOptions).add(reactionOptions).add(gromacsOptions);
+    allOptions.add(generalOptions).add(helpOptions).add(simulationOptions).add(reactionOptions).add(gromacsOptions).add(mockOptions).add(logOptions);
 
 
     // try storing + notifying the parameterMap
@@ -146,7 +184,8 @@ void Parameters::read(int argc, char* argv[])
         else if( getOption("gromacs").as<bool>() )
         {
             std::cout << programName
-                      << gromacsOptions;
+                      << gromacsOptions
+                      << '\n' << mockOptions;
         }
         else
         {
@@ -157,6 +196,7 @@ void Parameters::read(int argc, char* argv[])
             std::cout << '\n' << generalOptions;
             std::cout << '\n' << simulationOptions;
             std::cout << '\n' << reactionOptions;
+            std::cout << '\n' << logOptions;
             std::cout << '\n' << helpOptions;
             std::cout << '\n' << "Tip: to achieve a civilised shutdown of this program, e.g. if the runtime you \n"
                               << "     allocated for the job is about to run out, send SIGUSR1.\n";
@@ -196,6 +236,10 @@ void Parameters::check()
         {
             mdEngine = ENGINE::GROMACS;
         }
+        else if( tmp == "mock" )
+        {
+            mdEngine = ENGINE::MOCK;
+        }
         else
         {
             std::cout << "error: could not recognise md engine from given program option 'simulation.engine' \n";
@@ -227,6 +271,10 @@ void Parameters::check()
     {
         simulationAlgorithm = SIMALGORITHM::RATE;
     }
+    else if( getOption("reaction.kmc").as<bool>() )
+    {
+        simulationAlgorithm = SIMALGORITHM::KMC;
+    }
     
     // check for mandatory, depending and conflicting options
     if( ! getOption("simulation.restart").as<bool>() && parameterMap.count("simulation.restartCycle") )
@@ -239,14 +287,31 @@ void Parameters::check()
         std::cout << "warning: you set 'simulation.restartCycleFiles' but simulation.restart = off. that doesn't seem right\n";
         std::exit(EXIT_FAILURE);
     }
+    if( getOption("statisticsFormat").as<std::string>() != "text" && getOption("statisticsFormat").as<std::string>() != "binary" )
+    {
+        std::cout << "error: program option 'statisticsFormat' needs to be either text or binary\n";
+        std::exit(EXIT_FAILURE);
+    }
+    for( const auto& subsystem: enhance::LOGSUBSYSTEM_NAMES )
+    {
+        for( const auto& name: {std::string("log.level"), "log." + std::string(subsystem)} )
+        {
+            const auto& level = getOption(name).as<std::string>();
+            if( ! level.empty() && level != "warning" && level != "log" && level != "verbose" && level != "debug" )
+            {
+                std::cout << "error: program option '" << name << "' needs to be one of warning, log, verbose or debug\n";
+                std::exit(EXIT_FAILURE);
+            }
+        }
+    }
     if( ! parameterMap.count("reaction.file") )
     {
         std::cout << "error: at least one occurrence of program option 'reaction.file' is mandatory\n";
         std::exit(EXIT_FAILURE);
     }
-    if( getOption("reaction.rate").as<bool>() == getOption("reaction.mc").as<bool>() )
+    if( getOption("reaction.rate").as<bool>() + getOption("reaction.mc").as<bool>() + getOption("reaction.kmc").as<bool>() != 1 )
     {
-        std::cout << "error: program options 'reaction.rate' and 'reaction.mc' are mutually exclusive, you need to set either of them\n";
+        std::cout << "error: program options 'reaction.rate', 'reaction.mc' and 'reaction.kmc' are mutually exclusive, you need to set one of them\n";
         std::exit(EXIT_FAILURE);
     }
     if( getOption("reaction.rate").as<bool>() && ! parameterMap.count("reaction.frequency") )
@@ -264,8 +329,19 @@ void Parameters::check()
         std::cout << "error: computing interaction energies with solvent without setting 'reaction.computeLocalPotentialEnergy' makes no sense.\n";
         std::exit(EXIT_FAILURE);
     }
+    if( getOption("reaction.delayedAcceptance").as<bool>() && ! getOption("reaction.mc").as<bool>() )
+    {
+        std::cout << "error: 'reaction.delayedAcceptance' requires the Metropolis acceptance criterion ('reaction.mc')\n";
+        std::exit(EXIT_FAILURE);
+    }
+    if( getOption("reaction.delayedAcceptance").as<bool>() && getOption("reaction.computeLocalPotentialEnergy").as<bool>() )
+    {
+        // (the pre-screening energy is a whole system energy, both stages have to compare the same kind of energy)
+        std::cout << "error: 'reaction.delayedAcceptance' can not be combined with 'reaction.computeLocalPotentialEnergy' / 'reaction.computeSolvationPotentialEnergy'\n";
+        std::exit(EXIT_FAILURE);
+    }
 
-    if( mdEngine == ENGINE::GROMACS )
+    if( mdEngine == ENGINE::GROMACS || mdEngine == ENGINE::MOCK )
     {
         if( ! parameterMap.count("gromacs.topology") )
         {
@@ -277,6 +353,9 @@ void Parameters::check()
             std::cout << "error: program option 'gromacs.coordinates' is mandatory\n";
             std::exit(EXIT_FAILURE);
         }
+    }
+    if( mdEngine == ENGINE::GROMACS )
+    {
         if( ! parameterMap.count("gromacs.mdp") )
         {
             std::cout << "error: program option 'gromacs.mdp' is mandatory\n";
@@ -311,11 +390,28 @@ std::string Parameters::str() const
         stream << rsmdALL_formatting << formatted( "input", "none") << '\n';
     stream << rsmdALL_formatting << formatted( "output", getOption("output").as<std::string>() ) << '\n';
     stream << rsmdALL_formatting << formatted( "statistics", getOption("statistics").as<std::string>() ) << '\n';
+    stream << rsmdALL_formatting << formatted( "statisticsFormat", getOption("statisticsFormat").as<std::string>() ) << '\n';
     stream << rsmdALL_formatting << formatted( "rseed", getOption("rseed").as<std::size_t>() ) << '\n';
 
     stream << rsmdALL_formatting << "--- Simulation setup related options:\n"
            << rsmdALL_formatting << formatted( "simulation.engine", getOption("simulation.engine").as<std::string>() ) << '\n'
            << rsmdALL_formatting << formatted( "simulation.cycles", getOption("simulation.cycles").as<std::size_t>() ) << '\n';
+    if( ! getOption("simulation.scratch").as<std::string>().empty() )
+    {
+        stream << rsmdALL_formatting << formatted( "simulation.scratch", getOption("simulation.scratch").as<std::string>() ) << '\n';
+    }
+    if( ! getOption("simulation.archive").as<std::string>().empty() )
+    {
+        stream << rsmdALL_formatting << formatted( "simulation.archive", getOption("simulation.archive").as<std::string>() ) << '\n';
+    }
+    if( getOption("simulation.timing").as<bool>() )
+    {
+        stream << rsmdALL_formatting << formatted( "simulation.timing", getOption("simulation.timing").as<bool>() ) << '\n';
+    }
+    if( ! getOption("simulation.worker").as<std::string>().empty() )
+    {
+        stream << rsmdALL_formatting << formatted( "simulation.worker", getOption("simulation.worker").as<std::string>() ) << '\n';
+    }
     if( getOption("simulation.restart").as<bool>() )
     {
         stream << rsmdALL_formatting << formatted( "simulation.restartCycle", getOption("simulation.restartCycle").as<std::size_t>() ) << '\n'
@@ -330,13 +426,18 @@ std::string Parameters::str() const
                << rsmdALL_formatting << formatted( "reaction.temperature", getOption("reaction.temperature").as<REAL>() ) << '\n'
                << rsmdALL_formatting << formatted( "reaction.averagePotentialEnergy", getOption("reaction.averagePotentialEnergy").as<REAL>() ) << '\n'
                << rsmdALL_formatting << formatted( "reaction.computeLocalPotentialEnergy", getOption("reaction.computeLocalPotentialEnergy").as<bool>() ) << '\n'
-               << rsmdALL_formatting << formatted( "reaction.computeSolvationPotentialEnergy", getOption("reaction.computeSolvationPotentialEnergy").as<bool>() ) << '\n';
+               << rsmdALL_formatting << formatted( "reaction.computeSolvationPotentialEnergy", getOption("reaction.computeSolvationPotentialEnergy").as<bool>() ) << '\n'
+               << rsmdALL_formatting << formatted( "reaction.delayedAcceptance", getOption("reaction.delayedAcceptance").as<bool>() ) << '\n';
     }
     else if( getOption("reaction.rate").as<bool>() )
     {
         stream << rsmdALL_formatting << formatted( "reaction.rate", getOption("reaction.rate").as<bool>() ) << '\n'
                << rsmdALL_formatting << formatted( "reaction.frequency", getOption("reaction.frequency").as<REAL>() ) << '\n';
     }
+    else if( getOption("reaction.kmc").as<bool>() )
+    {
+        stream << rsmdALL_formatting << formatted( "reaction.kmc", getOption("reaction.kmc").as<bool>() ) << '\n';
+    }
     stream << rsmdALL_formatting << formatted( "saveRejected", getOption("reaction.saveRejected").as<bool>() ) << '\n';
 
     if( mdEngine == ENGINE::GROMACS )
@@ -354,8 +455,46 @@ std::string Parameters::str() const
         stream << rsmdALL_formatting << formatted("gromacs.backup", getOption("gromacs.backup").as<bool>() ) << '\n'
                << rsmdALL_formatting << formatted("gromacs.nt", getOption("gromacs.nt").as<int>() ) << '\n'
                << rsmdALL_formatting << formatted("gromacs.ntmpi", getOption("gromacs.ntmpi").as<int>() ) << '\n'
-               << rsmdALL_formatting << formatted("gromacs.ntomp", getOption("gromacs.ntomp").as<int>() ) << '\n';
+               << rsmdALL_formatting << formatted("gromacs.ntomp", getOption("gromacs.ntomp").as<int>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.edr", getOption("gromacs.edr").as<bool>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.trr", getOption("gromacs.trr").as<bool>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.nativeSubsets", getOption("gromacs.nativeSubsets").as<bool>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.pipeline", getOption("gromacs.pipeline").as<bool>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.gromppCache", getOption("gromacs.gromppCache").as<std::size_t>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.relaxationRadius", getOption("gromacs.relaxationRadius").as<REAL>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.relaxationExtensions", getOption("gromacs.relaxationExtensions").as<std::size_t>() ) << '\n';
+        if( getOption("gromacs.relaxationExtensions").as<std::size_t>() > 0 )
+        {
+            stream << rsmdALL_formatting << formatted("gromacs.relaxationTolerance", getOption("gromacs.relaxationTolerance").as<REAL>() ) << '\n';
+        }
+    }
+    else if( mdEngine == ENGINE::MOCK )
+    {
+        stream << rsmdALL_formatting << "--- Mock md engine related options:\n"
+               << rsmdALL_formatting << formatted("gromacs.topology", getOption("gromacs.topology").as<std::string>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.coordinates", getOption("gromacs.coordinates").as<std::string>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.edr", getOption("gromacs.edr").as<bool>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.trr", getOption("gromacs.trr").as<bool>() ) << '\n'
+               << rsmdALL_formatting << formatted("gromacs.relaxationRadius", getOption("gromacs.relaxationRadius").as<REAL>() ) << '\n'
+               << rsmdALL_formatting << formatted("mock.latency", getOption("mock.latency").as<REAL>() ) << '\n'
+               << rsmdALL_formatting << formatted("mock.displacement", getOption("mock.displacement").as<REAL>() ) << '\n'
+               << rsmdALL_formatting << formatted("mock.noise", getOption("mock.noise").as<REAL>() ) << '\n';
+    }
+
+    std::stringstream logStream {};
+    if( ! getOption("log.level").as<std::string>().empty() )
+        logStream << rsmdALL_formatting << formatted("log.level", getOption("log.level").as<std::string>() ) << '\n';
+    for( const auto& subsystem: enhance::LOGSUBSYSTEM_NAMES )
+    {
+        const std::string name = "log." + std::string(subsystem);
+        if( ! getOption(name).as<std::string>().empty() )
+            logStream << rsmdALL_formatting << formatted(name, getOption(name).as<std::string>() ) << '\n';
     }
+    if( getOption("log.async").as<bool>() )
+        logStream << rsmdALL_formatting << formatted("log.async", getOption("log.async").as<bool>() ) << '\n'
+                  << rsmdALL_formatting << formatted("log.buffer", getOption("log.buffer").as<std::size_t>() ) << '\n';
+    if( ! logStream.str().empty() )
+        stream << rsmdALL_formatting << "--- Logging related options:\n" << logStream.str();
     
     return stream.str();
 }
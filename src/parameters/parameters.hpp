@@ -28,9 +28,9 @@
 // ... and implements getter functions for all options
 //
 
-enum ENGINE { NONE, GROMACS };
+enum ENGINE { NONE, GROMACS, MOCK };
 enum SIMMODE { NEW, RESTART };
-enum SIMALGORITHM { RATE, MC };
+enum SIMALGORITHM { RATE, MC, KMC };
 
 class Parameters
 {
@@ -0,0 +1,230 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "parser/edrReader.hpp"
+
+#include <algorithm>
+
+
+namespace
+{
+    constexpr int    EDR_FILE_MAGIC  = -55555;
+    constexpr int    EDR_FRAME_MAGIC = -7777777;
+    constexpr double EDR_FRAME_FIRST_REAL_LIMIT = -1e10;    // first real of a frame is -2e10
+
+    // xdr data types of sub-blocks
+    enum XDR_DATATYPE
+    {
+        XDR_INT = 0,
+        XDR_FLOAT,
+        XDR_DOUBLE,
+        XDR_INT64,
+        XDR_CHAR,
+        XDR_STRING
+    };
+}
+
+
+//
+// read given energy terms of all frames from file
+//
+void EdrReader::read(const std::string& filename, const std::vector<std::string>& terms)
+{
+    XdrFile file( filename );
+
+    // energy term names
+    std::vector<std::string> names {};
+    readHeader(file, names);
+
+    termNames = terms;
+    std::vector<std::size_t> indices {};
+    for( const auto& term: terms )
+    {
+        auto it = std::find( names.begin(), names.end(), term );
+        if( it == names.end() )
+        {
+            throw std::runtime_error("energy term '" + term + "' not found in file '" + filename + "'");
+        }
+        indices.push_back( std::distance(names.begin(), it) );
+    }
+
+    times.clear();
+    values.assign( terms.size(), std::vector<double>{} );
+
+    // frames
+    doublePrecision = detectPrecision(file);
+    rsmdDEBUG( "reading " << (doublePrecision ? "double" : "single") << " precision energy file '" << filename << "' (version " << fileVersion << ")" );
+    while( ! file.eof() )
+    {
+        readFrame(file, names.size(), indices);
+    }
+}
+
+
+
+//
+// read the file header: magic number, version and names (+ units) of all energy terms
+//
+void EdrReader::readHeader(XdrFile& file, std::vector<std::string>& names)
+{
+    int magic = file.readInt();
+    if( magic > 0 )
+    {
+        throw std::runtime_error("energy file '" + file.name() + "' has an old format that is not supported");
+    }
+    if( magic != EDR_FILE_MAGIC )
+    {
+        throw std::runtime_error("'" + file.name() + "' is not a gromacs energy file");
+    }
+
+    // (version 1 stores additional dummy reals per term and frames without magic number)
+    fileVersion = file.readInt();
+    if( fileVersion < 2 )
+    {
+        throw std::runtime_error("energy file '" + file.name() + "' has version " + std::to_string(fileVersion) + " that is not supported");
+    }
+    int nre = file.readInt();
+
+    names.clear();
+    names.reserve(nre);
+    for( int i=0; i<nre; ++i )
+    {
+        names.emplace_back( file.readString() );
+        file.readString();  // unit
+    }
+}
+
+
+
+//
+// each frame starts with a real (-2e10) followed by a magic number,
+// try single precision first, then double precision
+//
+bool EdrReader::detectPrecision(XdrFile& file)
+{
+    const auto start = file.tell();
+    if( file.size() - start < 12 )  return false;  // no frames
+
+    if( file.readFloat() < EDR_FRAME_FIRST_REAL_LIMIT && file.readInt() == EDR_FRAME_MAGIC )
+    {
+        file.seek(start);
+        return false;
+    }
+    file.seek(start);
+    if( file.readDouble() < EDR_FRAME_FIRST_REAL_LIMIT && file.readInt() == EDR_FRAME_MAGIC )
+    {
+        file.seek(start);
+        return true;
+    }
+    throw std::runtime_error("could not determine precision of energy file '" + file.name() + "'");
+}
+
+
+
+//
+// read one frame, store time and requested energy terms
+// (frames without energies, e.g. only containing blocks, are skipped)
+//
+bool EdrReader::readFrame(XdrFile& file, std::size_t nTerms, const std::vector<std::size_t>& indices)
+{
+    // frame header
+    if( file.readReal(doublePrecision) > EDR_FRAME_FIRST_REAL_LIMIT || file.readInt() != EDR_FRAME_MAGIC )
+    {
+        throw std::runtime_error("energy frame magic number mismatch in file '" + file.name() + "'");
+    }
+    int version = file.readInt();
+    double time = file.readDouble();
+    file.readInt64();                       // step
+    int nsum = file.readInt();
+    if( version >= 3 )  file.readInt64();   // nsteps
+    if( version >= 5 )  file.readDouble();  // dt
+    int nre = file.readInt();
+    int ndisre = file.readInt();            // reserved since version 4
+    int nblock = file.readInt();
+    if( version < 4 && ndisre != 0 )
+    {
+        throw std::runtime_error("distance restraint data in energy file '" + file.name() + "' (version < 4) is not supported");
+    }
+
+    // block layout: (type, nr) for each sub-block
+    std::vector<std::vector<std::pair<int,int>>> blocks (nblock);
+    for( auto& block: blocks )
+    {
+        if( version >= 4 )
+        {
+            file.readInt();     // id
+            int nsub = file.readInt();
+            for( int i=0; i<nsub; ++i )
+            {
+                int type = file.readInt();
+                int nr = file.readInt();
+                block.emplace_back( type, nr );
+            }
+        }
+        else
+        {
+            block.emplace_back( (doublePrecision ? XDR_DOUBLE : XDR_FLOAT), file.readInt() );
+        }
+    }
+    file.readInt();     // e_size
+    file.readInt();     // reserved
+    file.readInt();     // reserved
+
+    // energies
+    std::vector<double> energies (nre);
+    for( auto& energy: energies )
+    {
+        energy = file.readReal(doublePrecision);
+        if( nsum > 0 )
+        {
+            file.readReal(doublePrecision);     // average
+            file.readReal(doublePrecision);     // sum
+        }
+    }
+
+    // skip block data
+    for( const auto& block: blocks )
+    {
+        for( const auto& [type, nr]: block )
+        {
+            switch( type )
+            {
+                case XDR_INT:
+                case XDR_FLOAT:
+                case XDR_CHAR:      // every unsigned char is stored in 4 bytes
+                    file.skip( 4*std::size_t(nr) );
+                    break;
+                case XDR_DOUBLE:
+                case XDR_INT64:
+                    file.skip( 8*std::size_t(nr) );
+                    break;
+                case XDR_STRING:
+                    for( int i=0; i<nr; ++i ) file.readString();
+                    break;
+                default:
+                    throw std::runtime_error("unknown data type in energy file '" + file.name() + "'");
+            }
+        }
+    }
+
+    if( nre == 0 )  return false;
+    if( std::size_t(nre) != nTerms )
+    {
+        throw std::runtime_error("number of energy terms in frame does not match header in file '" + file.name() + "'");
+    }
+
+    times.push_back( time );
+    for( std::size_t i=0; i<indices.size(); ++i )
+    {
+        values[i].push_back( energies[indices[i]] );
+    }
+    return true;
+}
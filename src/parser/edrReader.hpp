@@ -0,0 +1,54 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+#include "parser/xdrFile.hpp"
+
+#include <string>
+#include <vector>
+
+//
+// reader for gromacs energy files (.edr)
+// extracts the time series of the requested energy terms,
+// e.g. "Potential", "Coul-SR:xxx-rest", "LJ-SR:xxx-rest"
+//
+// supports single and double precision files (file versions 2 to 5)
+//
+
+class EdrReader
+{
+  private:
+    std::vector<std::string>         termNames {};
+    std::vector<double>              times {};
+    std::vector<std::vector<double>> values {};     // values[term][frame]
+
+    int  fileVersion {0};
+    bool doublePrecision {false};
+
+    void readHeader(XdrFile&, std::vector<std::string>&);
+    bool detectPrecision(XdrFile&);
+    bool readFrame(XdrFile&, std::size_t, const std::vector<std::size_t>&);
+
+  public:
+    //
+    // read given energy terms of all frames from file
+    //
+    void read(const std::string&, const std::vector<std::string>&);
+
+    //
+    // some getters
+    //
+    inline const auto& getTimes() const { return times; }
+    inline const auto& getValues(std::size_t term) const { return values.at(term); }
+    inline auto getNFrames() const { return times.size(); }
+};
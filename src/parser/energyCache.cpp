@@ -0,0 +1,86 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/* 
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0 
+*/
+
+#include "parser/energyCache.hpp"
+
+
+//
+// key of an entry: absolute path of the file + energy term
+//
+std::string EnergyCache::key(const std::string& filename, const std::string& term)
+{
+    return std::filesystem::absolute(filename).lexically_normal().string() + '\n' + term;
+}
+
+
+//
+// size and modification time of a file, false if it does not exist
+//
+bool EnergyCache::identity(const std::string& filename, std::uintmax_t& size, std::filesystem::file_time_type& mtime)
+{
+    std::error_code error {};
+    size = std::filesystem::file_size(filename, error);
+    if( error )     return false;
+    mtime = std::filesystem::last_write_time(filename, error);
+    return ! error;
+}
+
+
+//
+// whether there is a valid entry for the given file and term
+//
+bool EnergyCache::contains(const std::string& filename, const std::string& term) const
+{
+    std::uintmax_t size {0};
+    std::filesystem::file_time_type mtime {};
+    if( ! identity(filename, size, mtime) )     return false;
+
+    std::lock_guard<std::mutex> lock (mutex);
+    auto it = entries.find( key(filename, term) );
+    return ( it != entries.end() && it->second.size == size && it->second.mtime == mtime );
+}
+
+
+//
+// look up the energy of the given file and term
+//
+bool EnergyCache::lookup(const std::string& filename, const std::string& term, REAL& value)
+{
+    std::uintmax_t size {0};
+    std::filesystem::file_time_type mtime {};
+    const bool exists = identity(filename, size, mtime);
+
+    std::lock_guard<std::mutex> lock (mutex);
+    auto it = entries.find( key(filename, term) );
+    if( exists && it != entries.end() && it->second.size == size && it->second.mtime == mtime )
+    {
+        value = it->second.value;
+        ++ nHits;
+        return true;
+    }
+    ++ nMisses;
+    return false;
+}
+
+
+//
+// store the energy of the given file and term
+// (replaces an outdated entry of the same file)
+//
+void EnergyCache::store(const std::string& filename, const std::string& term, const REAL& value)
+{
+    Entry entry {};
+    if( ! identity(filename, entry.size, entry.mtime) )     return;
+    entry.value = value;
+
+    std::lock_guard<std::mutex> lock (mutex);
+    entries[ key(filename, term) ] = entry;
+}
@@ -0,0 +1,73 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/* 
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0 
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <mutex>
+#include <filesystem>
+
+//
+// a cache for energies read from (or computed for) energy files
+//
+// entries are keyed by the path of the energy file (e.g. Y-md.edr) and the energy term,
+// and are only valid as long as size and modification time of the file are unchanged,
+// i.e. an energy file that is appended to (e.g. by an appending md run) invalidates its entries
+//
+// shared by the md engine (to skip e.g. gmx energy if the energy is known already)
+// and the energy parser
+//
+
+class EnergyCache
+{
+  private:
+    struct Entry
+    {
+        std::uintmax_t                  size {0};
+        std::filesystem::file_time_type mtime {};
+        REAL                            value {0};
+    };
+
+    std::unordered_map<std::string, Entry> entries {};
+    mutable std::mutex mutex {};
+
+    std::size_t nHits {0};
+    std::size_t nMisses {0};
+
+    static std::string key(const std::string&, const std::string&);
+    static bool identity(const std::string&, std::uintmax_t&, std::filesystem::file_time_type&);
+
+  public:
+    //
+    // whether there is a valid entry for the given file and term
+    //
+    bool contains(const std::string&, const std::string&) const;
+
+    //
+    // look up the energy of the given file and term (counted as hit or miss),
+    // returns false if there is no valid entry
+    //
+    bool lookup(const std::string&, const std::string&, REAL&);
+
+    //
+    // store the energy of the given file and term
+    //
+    void store(const std::string&, const std::string&, const REAL&);
+
+    //
+    // some getters
+    //
+    const auto& getHits()   const { return nHits; }
+    const auto& getMisses() const { return nMisses; }
+};
@@ -12,6 +12,9 @@
 
 #include "definitions.hpp"
 #include "parameters/parameters.hpp"
+#include "parser/energyCache.hpp"
+
+#include <memory>
 
 //
 // a base class that implements
@@ -23,12 +26,18 @@ class EnergyParserBase
   protected:
     EnergyParserBase() = default;
 
+    // energies known already (shared with the md engine), may be null
+    std::shared_ptr<EnergyCache> energyCache {};
+
 
   public:
     virtual ~EnergyParserBase() = default;
 
     virtual REAL readPotentialEnergyDifference( const std::size_t& , const std::size_t& ) = 0;
+    virtual REAL readPrescreeningEnergyDifference( const std::size_t& , const std::size_t& ) = 0;
 
     virtual void setup(const Parameters&) = 0;
 
+    inline void setEnergyCache( std::shared_ptr<EnergyCache> cache ) { energyCache = std::move(cache); }
+
 };
\ No newline at end of file
@@ -19,6 +19,7 @@ void EnergyParserGMX::setup(const Parameters& parameters)
     potentialEnergyAverageTime = parameters.getOption("reaction.averagePotentialEnergy").as<REAL>();
     computeLocalPotentialEnergy = parameters.getOption("reaction.computeLocalPotentialEnergy").as<bool>();
     computeSolvationPotentialEnergy = parameters.getOption("reaction.computeSolvationPotentialEnergy").as<bool>();
+    readEnergyFiles = parameters.getOption("gromacs.edr").as<bool>();
 }
 
 
@@ -28,12 +29,28 @@ void EnergyParserGMX::setup(const Parameters& parameters)
 //
 REAL EnergyParserGMX::readPotentialEnergyDifference( const std::size_t& cycle, const std::size_t& lastReactiveCycle )
 {
+    enhance::ScopedTimer timer ("energyParsing");
+    if( readEnergyFiles )
+    {
+        // see EngineGMX::runEnergyComputation() for the names of the .edr files
+        std::string filenameAfter = ( computeLocalPotentialEnergy ? "products" : std::to_string(cycle) + "-rs" ) + ".edr";
+
+        REAL energyBefore = ( computeLocalPotentialEnergy ? readPotentialEnergyEdr("reactants.edr") : readReactantEnergy(lastReactiveCycle) );
+        REAL energyDifference = readPotentialEnergyEdr(filenameAfter) - energyBefore;
+        if( computeSolvationPotentialEnergy )
+        {
+            energyDifference += (readSolvationEnergyEdr("products_solvation.edr") - readSolvationEnergyEdr("reactants_solvation.edr"));   
+        }
+        return energyDifference;
+    }
+
     std::stringstream filenameBefore, filenameAfter {};
     filenameBefore << lastReactiveCycle << "-md.xvg";
     filenameAfter << cycle << "-rs.xvg";
 
-    REAL energyDifference = 0;
-    energyDifference = readPotentialEnergy(filenameAfter.str()) - readPotentialEnergy(filenameBefore.str());
+    // (with local energies, Y-md.xvg contains the energies of the reactants only)
+    REAL energyBefore = ( computeLocalPotentialEnergy ? readPotentialEnergy(filenameBefore.str()) : readReactantEnergy(lastReactiveCycle) );
+    REAL energyDifference = readPotentialEnergy(filenameAfter.str()) - energyBefore;
 
     if( computeSolvationPotentialEnergy )
     {
@@ -45,74 +62,97 @@ REAL EnergyParserGMX::readPotentialEnergyDifference( const std::size_t& cycle, c
 
 
 //
-// read potential energies from .xvg file
-// average them if requested, else read only energy from last step
+// energy difference of the pre-screening (reaction.delayedAcceptance):
+// single-point energy of the unrelaxed products minus the (averaged) energy before the reactive step
+// (see EngineGMX::runPrescreening() for the names of the files)
 //
-// IDEA: read in reverse order through file in order to save time ?!
-//       (--> benchmark before implementing!)
-REAL EnergyParserGMX::readPotentialEnergy( const std::string& filename )
+REAL EnergyParserGMX::readPrescreeningEnergyDifference( const std::size_t& cycle, const std::size_t& lastReactiveCycle )
 {
-    REAL time = 0;
-    REAL potentialEnergy = 0;
-    REAL tmp = 0;
-    REAL timeMargin = 0;
-    std::string line {};
-    std::stringstream linestream {};
-    std::size_t counter = 0;
+    enhance::ScopedTimer timer ("energyParsing");
+    const std::string after = std::to_string(cycle) + "-pre" + ( readEnergyFiles ? ".edr" : ".xvg" );
+
+    return readSinglePointEnergy(after) - readReactantEnergy(lastReactiveCycle);
+}
 
-    std::ifstream FILE( filename );
-    if( ! FILE )
-    {
-        rsmdCRITICAL( "could not read file '" << filename << "', cannot extract potential energy");
-    }
 
-    // read last line from file, save time & potential energy,
-    FILE.seekg(-2, std::ios::end);
-    while( FILE.peek() != '\n' )
+//
+// (averaged) potential energy of the whole system before the reactive step,
+// read from Y-md.edr respectively Y-md.xvg (written from it by gmx energy)
+// and memoized as long as Y-md.edr does not change, see EnergyCache
+//
+REAL EnergyParserGMX::readReactantEnergy( const std::size_t& lastReactiveCycle )
+{
+    const std::string before = std::to_string(lastReactiveCycle) + "-md";
+    REAL energy {0};
+    if( energyCache && energyCache->lookup(before + ".edr", "Potential", energy) )
     {
-        FILE.seekg(-1, std::ios::cur);
+        rsmdDEBUG( "potentialEnergy = " << energy << " kJ/mol (cached)" );
+        return energy;
     }
-    FILE >> time >> potentialEnergy;
-    rsmdDEBUG( "reading potential energy " << potentialEnergy );
-    
 
-    // if no averaging requested --> return potentialEnergy
-    // else set timeMargin correctly and read + average remaining values
-    if( potentialEnergyAverageTime != 0 )
-    {
-        FILE.seekg(0, std::ios::beg);
+    energy = ( readEnergyFiles ? readPotentialEnergyEdr(before + ".edr") : readPotentialEnergy(before + ".xvg") );
+    if( energyCache )   energyCache->store(before + ".edr", "Potential", energy);
+    return energy;
+}
+
 
-        // set timeMargin accordingly
-        timeMargin = time - potentialEnergyAverageTime;
-        rsmdDEBUG( "potentialEnergyAverageTime = " << potentialEnergyAverageTime << " ps");
-        rsmdDEBUG( "reading potential energies in [" << timeMargin << ", " << time << "] (ps)" );
-        if( timeMargin < 0 )
+//
+// read the potential energy of the last frame from an .edr or .xvg file
+//
+REAL EnergyParserGMX::readSinglePointEnergy( const std::string& filename )
+{
+    std::vector<double> energies {};
+    try
+    {
+        if( readEnergyFiles )
         {
-            rsmdWARNING( "potentialEnergyAverageTime is larger than total relaxation sequence time (" << time << " < " << potentialEnergyAverageTime << ")" );
-            rsmdWARNING( " setting potentialEnergyAverageTime to " << time << " ps.")
-            timeMargin = 0;
+            edrReader.read( filename, {"Potential"} );
+            energies = edrReader.getValues(0);
         }
-
-        // read file line by line and extract potential energies
-        potentialEnergy = 0;
-        while( std::getline(FILE, line, '\n') )
+        else
         {
-            if( line[0] == '#' || line[0] == '@' ) continue;
-
-            linestream = std::stringstream(line);
-            linestream >> time >> tmp;
-            
-            if( time >= timeMargin )
-            {
-                potentialEnergy += tmp;
-                ++ counter;
-            }
+            energies = xvgReader.read( filename, {"Potential"}, 0 );
         }
-        potentialEnergy /= counter;
-        rsmdDEBUG( "potentialEnergy = " << potentialEnergy << " kJ/mol (averaged over " << counter << " data points)" );
+    }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "could not read file '" << filename << "', cannot extract potential energy: " << e.what() );
+    }
+    if( energies.empty() )
+    {
+        rsmdCRITICAL( "no energies found in energy file '" << filename << "'" );
     }
 
-    FILE.close();
+    REAL potentialEnergy = static_cast<REAL>( energies.back() );
+    rsmdDEBUG( "single-point potentialEnergy = " << potentialEnergy << " kJ/mol" );
+    return potentialEnergy;
+}
+
+
+//
+// read potential energies from .xvg file
+// average them if requested, else read only energy from last step
+//
+REAL EnergyParserGMX::readPotentialEnergy( const std::string& filename )
+{
+    std::vector<double> energies {};
+    try
+    {
+        energies = xvgReader.read( filename, {"Potential"}, potentialEnergyAverageTime );
+    }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "could not read file '" << filename << "', cannot extract potential energy: " << e.what() );
+    }
+
+    if( potentialEnergyAverageTime > xvgReader.getLastTime() )
+    {
+        rsmdWARNING( "potentialEnergyAverageTime is larger than total relaxation sequence time (" << xvgReader.getLastTime() << " < " << potentialEnergyAverageTime << ")" );
+        rsmdWARNING( " setting potentialEnergyAverageTime to " << xvgReader.getLastTime() << " ps.")
+    }
+
+    REAL potentialEnergy = static_cast<REAL>( energies[0] );
+    rsmdDEBUG( "potentialEnergy = " << potentialEnergy << " kJ/mol (averaged over " << xvgReader.getNFrames() << " data points)" );
     return potentialEnergy;
 }
 
@@ -121,69 +161,94 @@ REAL EnergyParserGMX::readPotentialEnergy( const std::string& filename )
 // read interaction energies with solvent from .xvg file
 // average them if requested, else read only energy from last step
 //
-// IDEA: read in reverse order through file in order to save time ?!
-//       (--> benchmark before implementing!)
 REAL EnergyParserGMX::readSolvationEnergy( const std::string& filename )
 {
-    REAL time = 0;
-    REAL energy_lj = 0;
-    REAL energy_coulomb = 0;
-    REAL tmp1 = 0;
-    REAL tmp2 = 0;
-    REAL timeMargin = 0;
-    std::string line {};
-    std::stringstream linestream {};
-    std::size_t counter = 0;
-
-    std::ifstream FILE( filename );
-    if( ! FILE )
+    std::vector<double> energies {};
+    try
     {
-        rsmdCRITICAL( "could not read file '" << filename << "', cannot extract potential energy");
+        energies = xvgReader.read( filename, {"Coul-SR:xxx-rest", "LJ-SR:xxx-rest"}, potentialEnergyAverageTime );
     }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "could not read file '" << filename << "', cannot extract potential energy: " << e.what() );
+    }
+
+    REAL energy_coulomb = static_cast<REAL>( energies[0] );
+    REAL energy_lj = static_cast<REAL>( energies[1] );
+    rsmdDEBUG( "lj energy = " << energy_lj << ", coulomb energy = " << energy_coulomb << " kJ/mol (averaged over " << xvgReader.getNFrames() << " data points)" );
+    return (energy_lj + energy_coulomb);
+}
 
-    // read last line from file, save time & potential energy,
-    FILE.seekg(-2, std::ios::end);
-    while( FILE.peek() != '\n' )
+
+//
+// read potential energy from .edr file
+// average over the last potentialEnergyAverageTime ps if requested, else return energy from last frame
+//
+REAL EnergyParserGMX::readPotentialEnergyEdr( const std::string& filename )
+{
+    try
+    {
+        edrReader.read( filename, {"Potential"} );
+    }
+    catch(const std::exception& e)
     {
-        FILE.seekg(-1, std::ios::cur);
+        rsmdCRITICAL( "could not read file '" << filename << "', cannot extract potential energy: " << e.what() );
     }
-    FILE >> time >> energy_coulomb >> energy_lj;
-    rsmdDEBUG( "reading energies lj = " << energy_lj << ", coulomb = " << energy_coulomb );
 
-    // if no averaging requested --> return potentialEnergy
-    // else set timeMargin correctly and read + average remaining values
-    if( potentialEnergyAverageTime != 0 )
+    const auto& times = edrReader.getTimes();
+    if( potentialEnergyAverageTime != 0 && ! times.empty() && times.back() < potentialEnergyAverageTime )
     {
-        FILE.seekg(0, std::ios::beg);
+        rsmdWARNING( "potentialEnergyAverageTime is larger than total relaxation sequence time (" << times.back() << " < " << potentialEnergyAverageTime << ")" );
+        rsmdWARNING( " setting potentialEnergyAverageTime to " << times.back() << " ps.")
+    }
 
-        // set timeMargin accordingly
-        timeMargin = time - potentialEnergyAverageTime;
-        rsmdDEBUG( "potentialEnergyAverageTime = " << potentialEnergyAverageTime << " ps");
-        rsmdDEBUG( "reading potential energies in [" << timeMargin << ", " << time << "] (ps)" );
-    
-        // read file line by line and extract potential energies
-        energy_lj = 0;
-        energy_coulomb = 0;
-        while( std::getline(FILE, line, '\n') )
-        {
-            if( line[0] == '#' || line[0] == '@' ) continue;
-
-            linestream = std::stringstream(line);
-            linestream >> time >> tmp1 >> tmp2;
-            
-            if( time >= timeMargin )
-            {
-                energy_coulomb += tmp1;
-                energy_lj += tmp2;
-                ++ counter;
-                rsmdDEBUG(tmp1 << " " << tmp2);
-            }
-        }
-        energy_lj /= counter;
-        energy_coulomb /= counter;
-        rsmdDEBUG( "lj energy = " << energy_lj << ", coulomb energy = " << energy_coulomb << " kJ/mol (averaged over " << counter << " data points)" );
+    REAL potentialEnergy = average( times, edrReader.getValues(0) );
+    rsmdDEBUG( "potentialEnergy = " << potentialEnergy << " kJ/mol" );
+    return potentialEnergy;
+}
+
+
+//
+// read interaction energies with solvent from .edr file
+// average over the last potentialEnergyAverageTime ps if requested, else return energies from last frame
+//
+REAL EnergyParserGMX::readSolvationEnergyEdr( const std::string& filename )
+{
+    try
+    {
+        edrReader.read( filename, {"Coul-SR:xxx-rest", "LJ-SR:xxx-rest"} );
+    }
+    catch(const std::exception& e)
+    {
+        rsmdCRITICAL( "could not read file '" << filename << "', cannot extract potential energy: " << e.what() );
     }
 
-    FILE.close();
+    REAL energy_coulomb = average( edrReader.getTimes(), edrReader.getValues(0) );
+    REAL energy_lj = average( edrReader.getTimes(), edrReader.getValues(1) );
+    rsmdDEBUG( "lj energy = " << energy_lj << ", coulomb energy = " << energy_coulomb << " kJ/mol" );
     return (energy_lj + energy_coulomb);
 }
+
+
+//
+// average of all values within the last potentialEnergyAverageTime ps
+// (or only the last value if no averaging is requested)
+//
+REAL EnergyParserGMX::average( const std::vector<double>& times, const std::vector<double>& values ) const
+{
+    if( values.empty() )
+    {
+        rsmdCRITICAL( "no energies found in energy file" );
+    }
+    if( potentialEnergyAverageTime == 0 )   return static_cast<REAL>( values.back() );
+
+    const double timeMargin = times.back() - potentialEnergyAverageTime;
+    double sum = 0;
+    std::size_t counter = 0;
+    for( std::size_t i=values.size(); i-- > 0 && times[i] >= timeMargin; )
+    {
+        sum += values[i];
+        ++ counter;
+    }
+    return static_cast<REAL>( sum / counter );
+}
@@ -12,6 +12,9 @@
 #pragma once
 
 #include "parser/energyParserBase.hpp"
+#include "parser/edrReader.hpp"
+#include "parser/xvgReader.hpp"
+#include "enhance/timing.hpp"
 
 #include <sstream>
 #include <fstream>
@@ -29,15 +32,31 @@ class EnergyParserGMX: public EnergyParserBase
     bool computeLocalPotentialEnergy {false};
     bool computeSolvationPotentialEnergy {false};
     REAL potentialEnergyAverageTime {0.0};
+
+    XvgReader xvgReader {};
     REAL readPotentialEnergy( const std::string& );
     REAL readSolvationEnergy( const std::string& );
 
+    // read energies directly from .edr files (instead of .xvg files written by gmx energy)
+    bool readEnergyFiles {false};
+    EdrReader edrReader {};
+    REAL readPotentialEnergyEdr( const std::string& );
+    REAL readSolvationEnergyEdr( const std::string& );
+    REAL average( const std::vector<double>&, const std::vector<double>& ) const;
+
+    // (averaged) potential energy of the whole system before the reactive step, memoized per Y-md.edr
+    REAL readReactantEnergy( const std::size_t& );
+
+    // single-point energy (last frame, no averaging) of the pre-screening (.edr or .xvg)
+    REAL readSinglePointEnergy( const std::string& );
+
 
   public:
     ~EnergyParserGMX() = default;
     EnergyParserGMX()  = default;
 
     REAL readPotentialEnergyDifference( const std::size_t&, const std::size_t& );        
+    REAL readPrescreeningEnergyDifference( const std::size_t&, const std::size_t& );
 
     void setup(const Parameters&);
 };
\ No newline at end of file
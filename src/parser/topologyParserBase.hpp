@@ -26,6 +26,7 @@ class TopologyParserBase
     TopologyParserBase() = default;
 
   public:
+    virtual void setup( const Parameters& ) {}
     virtual void read( Topology&, const std::size_t&) = 0;
     virtual void readRelaxed( Topology&, const std::size_t&) = 0;
     virtual void write(Topology&, const std::size_t&) = 0;
@@ -11,29 +11,64 @@
 
 #include "parser/topologyParserGMX.hpp"
 
+#include <charconv>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+    // residue and atom ids in .gro files have (at most) five digits
+    constexpr std::size_t GRO_ID_WRAP = 100000;
+
+    // fixed-width field of a line without surrounding whitespace
+    std::string_view field( const std::string& line, std::size_t pos, std::size_t width )
+    {
+        auto view = std::string_view(line).substr(pos, width);
+        while( ! view.empty() && std::isspace(static_cast<unsigned char>(view.front())) )   view.remove_prefix(1);
+        while( ! view.empty() && std::isspace(static_cast<unsigned char>(view.back())) )    view.remove_suffix(1);
+        return view;
+    }
+
+    bool parseReal( const std::string& line, std::size_t pos, std::size_t width, REAL& value )
+    {
+        const auto view = field(line, pos, width);
+        const auto result = std::from_chars( view.data(), view.data() + view.size(), value );
+        return result.ec == std::errc() && result.ptr == view.data() + view.size();
+    }
+}
+
+void TopologyParserGMX::setup( const Parameters& parameters )
+{
+    readTrajectory = parameters.getOption("gromacs.trr").as<bool>();
+    relaxationRadius = parameters.getOption("gromacs.relaxationRadius").as<REAL>();
+}
+
+
 void TopologyParserGMX::read( Topology& topology, const std::size_t& cycle )
 {
     // convert filenames
     std::stringstream topFile {};
     std::stringstream coordFile {};
+    std::stringstream trajectoryFile {};
     topFile << cycle << ".top";
     coordFile << cycle << "-md.gro";
+    trajectoryFile << cycle << "-md.trr";
+
+    // keep only the snapshot of this cycle, older ones are not read again
+    for( auto it = snapshots.begin(); it != snapshots.end(); )
+    {
+        if( it->first != cycle )    it = snapshots.erase(it);
+        else                        ++ it;
+    }
+    auto snapshot = snapshots.find( cycle );
 
     // read topology
     auto topologyMap = read_top( topFile.str() );
-    read_gro( coordFile.str(), topology );
+    readStructure( coordFile.str(), trajectoryFile.str(), topology, snapshot == snapshots.end() ? nullptr : &snapshot->second );
+    checkConsistency( topologyMap, topology );
 
-    // some consistency checks:
-    unsigned int atomCounter = 0;
-    for( const auto& moleculetype: topologyMap )
-    {
-        auto foundMolecules = topology.getMolecules( moleculetype.first );
-        if( foundMolecules.size() != moleculetype.second )   
-            rsmdWARNING(".top and .gro don't match (# molecules of type " << moleculetype.first << " " << moleculetype.second << " vs. " << foundMolecules.size() << ")") 
-        atomCounter += foundMolecules.size();
-    }
-    if( atomCounter != topology.size() )
-        rsmdWARNING( " total number of molecules in .gro and .top doesn't match" << "(" << atomCounter << " vs. " << topology.size() << ")" )
+    // (the same cycle is read again as long as reactive steps are rejected)
+    if( snapshot == snapshots.end() )   storeSnapshot( cycle, topology );
 }
 
 void TopologyParserGMX::readRelaxed( Topology& topology, const std::size_t& cycle )
@@ -41,24 +76,157 @@ void TopologyParserGMX::readRelaxed( Topology& topology, const std::size_t& cycl
     // convert filenames
     std::stringstream topFile {};
     std::stringstream coordFile {};
+    std::stringstream trajectoryFile {};
     topFile << cycle << ".top";
     coordFile << cycle << "-rs.gro";
+    trajectoryFile << cycle << "-rs.trr";
+
+    auto snapshot = snapshots.find( cycle );
 
     // read topology
     auto topologyMap = read_top( topFile.str() );
-    read_gro( coordFile.str(), topology );
+    readStructure( coordFile.str(), trajectoryFile.str(), topology, snapshot == snapshots.end() ? nullptr : &snapshot->second );
+    checkConsistency( topologyMap, topology );
+}
+
+
+//
+// read coordinates/velocities of a cycle:
+// from the last frame of the .trr file (gromacs.trr) if possible, otherwise from the .gro file
+//
+void TopologyParserGMX::readStructure( const std::string& groFile, const std::string& trrFile, Topology& top, const Topology* snapshot )
+{
+    if( readTrajectory )
+    {
+        TrajectoryFrame frame {};
+        bool frameRead = false;
+        try
+        {
+            frameRead = TrajectoryParserGMX::readLastTRRFrame( trrFile, frame ) && ! frame.v.empty();
+        }
+        catch(const std::exception& e)
+        {
+            rsmdWARNING( "... could not read " << trrFile << ": " << e.what() );
+        }
+
+        if( frameRead )
+        {
+            // layout from the snapshot
+            if( snapshot != nullptr && 3 * static_cast<std::size_t>(snapshot->getNAtoms()) == frame.x.size() )
+            {
+                top = *snapshot;
+                applyFrame( frame, top );
+                return;
+            }
+            // layout from the .gro file (+ check that both agree)
+            read_gro( groFile, top, snapshot );
+            if( 3 * static_cast<std::size_t>(top.getNAtoms()) == frame.x.size() )
+            {
+                checkFrame( frame, top, trrFile );
+                applyFrame( frame, top );
+            }
+            else
+            {
+                rsmdWARNING( "... # atoms in " << trrFile << " and " << groFile << " don't match, using " << groFile );
+            }
+            return;
+        }
+        if( ! warnedTrajectory )
+        {
+            rsmdWARNING( "... no frame with coordinates and velocities in " << trrFile << ", reading .gro files instead (check nstxout / nstvout)" );
+            warnedTrajectory = true;
+        }
+    }
+    read_gro( groFile, top, snapshot );
+}
+
+
+//
+// set coordinates, velocities and box of a topology from a .trr frame
+//
+void TopologyParserGMX::applyFrame( const TrajectoryFrame& frame, Topology& top ) const
+{
+    std::size_t i {0};
+    for( auto& mol: top )
+    {
+        for( auto& atom: mol )
+        {
+            for( std::size_t k=0; k<3; ++k )
+            {
+                atom.position(k) = frame.x[3*i + k];
+                atom.velocity(k) = frame.v[3*i + k];
+            }
+            ++ i;
+        }
+    }
+    if( frame.box[0] > 0 && frame.box[4] > 0 && frame.box[8] > 0 )
+    {
+        top.setDimensions( REALVEC(frame.box[0], frame.box[4], frame.box[8]) );
+        top.setCellNumbers();
+    }
+}
+
+
+//
+// check a .trr frame against the coordinates/velocities read from a .gro file
+// (which are rounded to 3 / 4 decimals)
+//
+void TopologyParserGMX::checkFrame( const TrajectoryFrame& frame, const Topology& top, const std::string& trrFile ) const
+{
+    REAL maxPosition {0}, maxVelocity {0};
+    std::size_t i {0};
+    for( const auto& mol: top )
+    {
+        for( const auto& atom: mol )
+        {
+            for( std::size_t k=0; k<3; ++k )
+            {
+                maxPosition = std::max( maxPosition, std::abs(atom.position(k) - frame.x[3*i + k]) );
+                maxVelocity = std::max( maxVelocity, std::abs(atom.velocity(k) - frame.v[3*i + k]) );
+            }
+            ++ i;
+        }
+    }
+    if( maxPosition > 0.0006 || maxVelocity > 0.00006 )
+    {
+        rsmdWARNING( "... coordinates / velocities in " << trrFile << " differ from the .gro file by up to " << maxPosition << " / " << maxVelocity 
+                     << ", is the last frame not the end of the run?" );
+    }
+    else
+    {
+        rsmdVERBOSE( "... " << trrFile << " agrees with the .gro file (max. deviation " << maxPosition << " / " << maxVelocity << ")" );
+    }
+}
 
-    // some consistency checks:
-    unsigned int atomCounter = 0;
+
+//
+// keep the layout of a topology for reading the coordinates of the same cycle
+//
+void TopologyParserGMX::storeSnapshot( const std::size_t& cycle, const Topology& topology )
+{
+    auto& snapshot = snapshots[cycle];
+    snapshot = topology;
+    snapshot.clearReactionRecords();
+}
+
+
+//
+// some consistency checks between .top and .gro
+//
+void TopologyParserGMX::checkConsistency( const std::map<std::string, unsigned int>& topologyMap, const Topology& topology ) const
+{
+    const auto& counts = topology.getMoleculetypeCounts();
+    std::size_t moleculeCounter = 0;
     for( const auto& moleculetype: topologyMap )
     {
-        auto foundMolecules = topology.getMolecules( moleculetype.first );
-        if( foundMolecules.size() != moleculetype.second )   
-            rsmdWARNING(".top and .gro don't match (# molecules of type " << moleculetype.first << " " << moleculetype.second << " vs. " << foundMolecules.size() << ")") 
-        atomCounter += foundMolecules.size();
+        auto found = counts.find( moleculetype.first );
+        std::size_t foundMolecules = ( found == counts.end() ? 0 : found->second );
+        if( foundMolecules != moleculetype.second )   
+            rsmdWARNING(".top and .gro don't match (# molecules of type " << moleculetype.first << " " << moleculetype.second << " vs. " << foundMolecules << ")") 
+        moleculeCounter += foundMolecules;
     }
-    if( atomCounter != topology.size() )
-        rsmdWARNING( " total number of molecules in .gro and .top doesn't match" << "(" << atomCounter << " vs. " << topology.size() << ")" )
+    if( moleculeCounter != topology.size() )
+        rsmdWARNING( " total number of molecules in .gro and .top doesn't match" << "(" << moleculeCounter << " vs. " << topology.size() << ")" )
 }
 
 
@@ -70,19 +238,34 @@ void TopologyParserGMX::write(Topology& top, const std::size_t& currentCycle)
     std::stringstream cycle {};
     cycle << currentCycle;
 
+    // keep the layout for reading the relaxed configuration / the next cycle
+    storeSnapshot( currentCycle, top );
+
     // write topology
     write_top( cycle.str() + ".top", top );
     write_gro( cycle.str() + "-rs.gro", top );
     write_index( cycle.str() + ".reactants.ndx", cycle.str() + ".products.ndx", top );
+    if( relaxationRadius > 0 )  write_relaxationIndex( cycle.str() + ".relaxation.ndx", top );
 }
 
 
 
 std::map<std::string, unsigned int> TopologyParserGMX::read_top( const std::string& topFile )
 {
+    // skip reading a file that was written by write_top() and not changed since
+    if( topFile == writtenTopFile )
+    {
+        std::error_code error {};
+        const auto time = std::filesystem::last_write_time( topFile, error );
+        if( ! error && time == writtenTopTime && std::filesystem::file_size( topFile, error ) == writtenTopSize && ! error )
+        {
+            return writtenMolecules;
+        }
+    }
+
     std::map<std::string, unsigned int> topologyMap {};
 
-    bool readFileContent = (topologyFileContent.empty() ? true : false);
+    bool readFileContent = (topologyPrefix.empty() ? true : false);
 
 	// open topology file
 	std::ifstream FILE( topFile );
@@ -91,24 +274,22 @@ std::map<std::string, unsigned int> TopologyParserGMX::read_top( const std::stri
 	} else {
         bool directiveMolecules {false};
         bool directiveSystem    {false};
-        while( FILE.good() )
+        std::string line;
+        while( std::getline(FILE, line, '\n') )
         {
-            // get next line
-            std::string line;
-            std::getline(FILE, line, '\n');
-            std::stringstream linestream(line);
-
             // case: [system] --> read and save systemName
             if( directiveSystem )
             {
                 if( line.empty() ) continue;
                 systemName = enhance::trimString(line);
                 directiveSystem = false;
+                if( readFileContent )   topologyPrefix.append( systemName ).push_back('\n');
             }
             // case: [molecules] --> read and save 
             else if( directiveMolecules )
             {
                 if( line.empty() ) continue;
+                std::stringstream linestream(line);
                 std::string moltype {};
                 int nMolecules = 0;
                 linestream >> moltype >> nMolecules;
@@ -135,10 +316,10 @@ std::map<std::string, unsigned int> TopologyParserGMX::read_top( const std::stri
                         directiveMolecules = true;
                     }
                 }
-                // read and save line to topologyFileContent
+                // read and save line to topologyPrefix
                 if( readFileContent )
                 {
-                    topologyFileContent.emplace_back(line);
+                    topologyPrefix.append( line ).push_back('\n');
                 }
             }
         }
@@ -150,7 +331,37 @@ std::map<std::string, unsigned int> TopologyParserGMX::read_top( const std::stri
 
 
 
-void TopologyParserGMX::read_gro( const std::string& groFile, Topology& top )
+//
+// read only coordinates and velocities of a .gro file into a copy of the given snapshot,
+// returns false if the layout of the file differs from the snapshot
+//
+bool TopologyParserGMX::readCoordinates( std::ifstream& FILE, const Topology& snapshot, Topology& top ) const
+{
+    top = snapshot;
+    std::string line;
+    for( auto& mol: top )
+    {
+        for( auto& atom: mol )
+        {
+            if( ! std::getline(FILE, line, '\n') || line.size() < 44 )     return false;
+            if( field(line, 5, 5) != mol.getName() || field(line, 10, 5) != atom.name )     return false;
+            for( std::size_t i=0; i<3; ++i )
+            {
+                if( ! parseReal(line, 20 + 8*i, 8, atom.position(i)) )    return false;
+            }
+            for( std::size_t i=0; i<3; ++i )
+            {
+                if( line.size() < 68 )  atom.velocity(i) = 0;
+                else if( ! parseReal(line, 44 + 8*i, 8, atom.velocity(i)) )     return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+
+void TopologyParserGMX::read_gro( const std::string& groFile, Topology& top, const Topology* snapshot )
 {	
 	int totNrOfAtoms = 0;
 	
@@ -172,8 +383,28 @@ void TopologyParserGMX::read_gro( const std::string& groFile, Topology& top )
         std::stringstream linestream(line);
         linestream >> totNrOfAtoms;
 
+        // same layout as the snapshot: read coordinates only
+        bool coordinatesRead = false;
+        if( snapshot != nullptr && snapshot->getNAtoms() == totNrOfAtoms )
+        {
+            const auto body = FILE.tellg();
+            coordinatesRead = readCoordinates( FILE, *snapshot, top );
+            if( ! coordinatesRead )
+            {
+                rsmdVERBOSE( "... layout of " << groFile << " differs from the last topology, reading the whole file" );
+                top.clear();
+                FILE.clear();
+                FILE.seekg( body );
+            }
+        }
+
         // read atom descriptions
-        int counter = 0;
+        // (ids have five digits and wrap around at 100000 in large systems, see write_gro())
+        int counter = ( coordinatesRead ? totNrOfAtoms : 0 );
+        std::size_t residOffset = 0, atomidOffset = 0;
+        std::size_t lastResid = 0, lastAtomid = 0;
+        // (topology is empty, molecules are looked up by resid instead of searching the topology)
+        std::unordered_map<std::size_t, std::size_t> moleculeIndex {};     // resid -> position in topology
         while( counter < totNrOfAtoms )
         {
             std::getline(FILE, line, '\n');
@@ -185,7 +416,10 @@ void TopologyParserGMX::read_gro( const std::string& groFile, Topology& top )
             }
            
             // molecule related information
-            int resid           = std::stoi( line.substr(0,5) );
+            std::size_t resid   = std::stoul( line.substr(0,5) );
+            if( resid + GRO_ID_WRAP/2 < lastResid ) residOffset += GRO_ID_WRAP;
+            lastResid = resid;
+            resid += residOffset;
             std::string resname = line.substr(5,5);
             resname.erase(std::remove_if( resname.begin(), resname.end(), ::isspace), resname.end());
            
@@ -193,7 +427,10 @@ void TopologyParserGMX::read_gro( const std::string& groFile, Topology& top )
             Atom atom;
             atom.name = line.substr(10,5);
             atom.name.erase(std::remove_if( atom.name.begin(), atom.name.end(), ::isspace), atom.name.end());
-            atom.id = std::stoi( line.substr(15,5) );
+            std::size_t atomid = std::stoul( line.substr(15,5) );
+            if( atomid + GRO_ID_WRAP/2 < lastAtomid ) atomidOffset += GRO_ID_WRAP;
+            lastAtomid = atomid;
+            atom.id = atomid + atomidOffset;
             atom.position(0) = std::stof( line.substr(20,8) );
             atom.position(1) = std::stof( line.substr(28,8) );
             atom.position(2) = std::stof( line.substr(36,8) );
@@ -202,8 +439,13 @@ void TopologyParserGMX::read_gro( const std::string& groFile, Topology& top )
             atom.velocity(2) = std::stof( line.substr(60,8) );
 
             // add atom and all infos to topology:
-            auto& mol = top.getAddMolecule( resid, resname );
-            mol.addAtom(atom);
+            auto index = moleculeIndex.find( resid );
+            if( index == moleculeIndex.end() )
+            {
+                index = moleculeIndex.emplace( resid, top.size() ).first;
+                top.addMolecule( resid, resname );
+            }
+            top[index->second].addAtom(atom);
 
             counter ++;
         }
@@ -230,31 +472,23 @@ void TopologyParserGMX::write_top( const std::string& topFile, Topology& top )
     std::ofstream FILE( topFile );
     if( FILE.bad() ) rsmdCRITICAL("something went wrong with outstream to " << topFile);
     
-    for(auto& line: topologyFileContent)
+    // everything up to (and including) [molecules] + table of molecules
+    // (assumes that topology has been sorted beforehand, i.e. the sequence matches the .gro file)
+    FILE << topologyPrefix;
+    writtenMolecules.clear();
+    for( const auto& moleculetype: top.getMoleculetypeCounts() )
     {
-        // if line contains [system]
-        if( line.find('[') != std::string::npos && line.find("system") != std::string::npos )
-        {
-            FILE << line << '\n';
-            FILE << systemName << '\n';
-        }
-        // if line contains [molecules]
-        else if( line.find('[') != std::string::npos && line.find("molecules") != std::string::npos )
-        {
-            FILE << line << '\n';
-            for(auto& mt: top.getMoleculetypes() )
-            {
-                auto number = top.getMolecules( mt ).size();       
-                FILE << std::setw(5) << std::left << mt << number << '\n';
-            }
-        }  
-        else
-        {
-            FILE << line << '\n';
-        }
+        FILE << std::setw(5) << std::left << moleculetype.first << moleculetype.second << '\n';
+        writtenMolecules.emplace( moleculetype.first, moleculetype.second );
     }
     
     FILE.close();
+
+    std::error_code error {};
+    writtenTopFile = topFile;
+    writtenTopTime = std::filesystem::last_write_time( topFile, error );
+    writtenTopSize = std::filesystem::file_size( topFile, error );
+    if( error )     writtenTopFile.clear();
 }
 
 
@@ -274,10 +508,10 @@ void TopologyParserGMX::write_gro( const std::string& groFile, Topology& top )
     {
         for(const auto& atom: mol)
         {
-            FILE << std::setw(5) << std::right << mol.getID() 
+            FILE << std::setw(5) << std::right << mol.getID() % GRO_ID_WRAP
                  << std::setw(5) << std::left  << mol.getName()
                  << std::setw(5) << std::right << atom.name
-                 << std::setw(5) << std::right << atom.id;
+                 << std::setw(5) << std::right << atom.id % GRO_ID_WRAP;
             for( const auto& p: atom.position )
                 FILE << std::fixed << std::right << std::setprecision(3) << std::setw(8) << p;
             for( const auto& v: atom.velocity )
@@ -318,3 +552,56 @@ void TopologyParserGMX::write_index(const std::string& reactants, const std::str
     REACTANTS.close();
     PRODUCTS.close();
 }
+
+
+
+//
+// index file for the local relaxation (gromacs.relaxationRadius):
+// [ System ], one group per moleculetype and
+// [ relaxed ] (all molecules within the relaxation radius of the products) / [ frozen ] (all other molecules)
+//
+void TopologyParserGMX::write_relaxationIndex(const std::string& filename, Topology& top)
+{
+    std::vector<std::size_t> productAtoms {};
+    productAtoms.reserve( top.getReactionRecordsAtoms().size() );
+    for( const auto& idpair: top.getReactionRecordsAtoms() )    productAtoms.push_back( idpair.second );
+    const auto relaxed = top.getNeighbourhood( productAtoms, relaxationRadius );
+
+    std::map<std::string, std::vector<std::size_t>> groups {};
+    auto& system = groups["System"];
+    auto& relaxedAtoms = groups["relaxed"];
+    auto& frozenAtoms = groups["frozen"];
+    std::size_t i {0};
+    for( const auto& molecule: top )
+    {
+        auto& moleculetype = groups[molecule.getName()];
+        auto& state = ( relaxed[i] ? relaxedAtoms : frozenAtoms );
+        for( const auto& atom: molecule )
+        {
+            system.push_back( atom.id );
+            moleculetype.push_back( atom.id );
+            state.push_back( atom.id );
+        }
+        ++ i;
+    }
+    rsmdVERBOSE( "... relaxing " << relaxedAtoms.size() << " of " << system.size() << " atoms within " << relaxationRadius << " nm of the products" );
+
+    std::ofstream FILE( filename );
+    if( ! FILE ) rsmdCRITICAL("something went wrong with outstream to '" << filename << "'");
+
+    auto writeGroup = [&FILE](const std::string& name, const std::vector<std::size_t>& ids)
+    {
+        FILE << "[ " << name << " ]\n";
+        for( std::size_t j=0; j<ids.size(); ++j )
+        {
+            FILE << std::setw(6) << ids[j] << ( (j+1) % 15 == 0 || j+1 == ids.size() ? "\n" : " " );
+        }
+    };
+    writeGroup( "System", system );
+    for( const auto& group: groups )
+    {
+        if( group.first != "System" && group.first != "relaxed" && group.first != "frozen" )  writeGroup( group.first, group.second );
+    }
+    writeGroup( "relaxed", relaxedAtoms );
+    writeGroup( "frozen", frozenAtoms );
+}
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "parser/topologyParserBase.hpp"
+#include "parser/trajectoryParserGMX.hpp"
 #include "enhance/utility.hpp"
 
 #include <vector>
@@ -28,21 +29,59 @@
 // gromacs (GMX) topologies
 // from .top & .gro files
 //
+// the .top file is kept as a prefix (everything up to the [ molecules ] directive)
+// plus the table of molecules, which is generated from the topology's # molecules per moleculetype,
+// a .top file that was written by this parser (and not changed since) is not read again
+//
+// snapshots of the layout (molecules, atoms, ids) of the last topologies written / read are kept per cycle,
+// a .gro file of a cycle with a snapshot is read by parsing only the coordinates/velocities
+// (falls back to reading the whole file if the layout differs)
+//
+// with gromacs.trr, coordinates/velocities are read in full precision from the last frame of the
+// .trr file of a cycle instead (into the snapshot's layout, or checked against the .gro file if there is none)
+//
+// with gromacs.relaxationRadius, an index file X.relaxation.ndx with the groups relaxed / frozen
+// (molecules within / outside the radius around the products) is written with every topology
+//
 
 class TopologyParserGMX : public TopologyParserBase
 {
   private:
     std::string              systemName {};
-    std::vector<std::string> topologyFileContent {};
+    std::string              topologyPrefix {};
+
+    // last .top file written
+    std::string                         writtenTopFile {};
+    std::filesystem::file_time_type     writtenTopTime {};
+    std::uintmax_t                      writtenTopSize {0};
+    std::map<std::string, unsigned int> writtenMolecules {};
+
+    // layout snapshots per cycle
+    std::map<std::size_t, Topology> snapshots {};
+    void storeSnapshot( const std::size_t&, const Topology& );
+    bool readCoordinates( std::ifstream&, const Topology&, Topology& ) const;
+
+    // coordinates from .trr files
+    bool readTrajectory {false};
+    bool warnedTrajectory {false};
+    void readStructure( const std::string&, const std::string&, Topology&, const Topology* );
+    void applyFrame( const TrajectoryFrame&, Topology& ) const;
+    void checkFrame( const TrajectoryFrame&, const Topology&, const std::string& ) const;
 
     std::map<std::string, unsigned int> read_top( const std::string& );
-    void read_gro( const std::string&, Topology&);
+    void checkConsistency( const std::map<std::string, unsigned int>&, const Topology& ) const;
+    void read_gro( const std::string&, Topology&, const Topology* = nullptr );
     void write_top(const std::string&, Topology&);
     void write_gro(const std::string&, Topology&);
     void write_index(const std::string&, const std::string&, Topology&);
 
+    // local relaxation
+    REAL relaxationRadius {0};
+    void write_relaxationIndex(const std::string&, Topology&);
+
 
   public:
+    void setup( const Parameters& );
     void read( Topology&, const std::size_t&);
     void readRelaxed( Topology&, const std::size_t&);
     void write(Topology&, const std::size_t&);
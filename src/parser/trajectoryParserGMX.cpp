@@ -0,0 +1,573 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "parser/trajectoryParserGMX.hpp"
+
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+
+
+//
+// xtc decompression
+// (follows the reference implementation of the xtc format in gromacs / xdrfile)
+//
+namespace
+{
+    constexpr int XTC_MAGIC = 1995;
+    constexpr int TRR_MAGIC = 1993;
+
+    constexpr int MAGICINTS[] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 10, 12, 16, 20, 25, 32, 40, 50, 64,
+        80, 101, 128, 161, 203, 256, 322, 406, 512, 645, 812, 1024, 1290,
+        1625, 2048, 2580, 3250, 4096, 5060, 6501, 8192, 10321, 13003,
+        16384, 20642, 26007, 32768, 41285, 52015, 65536, 82570, 104031,
+        131072, 165140, 208063, 262144, 330280, 416127, 524287, 660561,
+        832255, 1048576, 1321122, 1664510, 2097152, 2642245, 3329021,
+        4194304, 5284491, 6658042, 8388607, 10568983, 13316085, 16777216
+    };
+    constexpr int FIRSTIDX = 9;
+    constexpr int LASTIDX = sizeof(MAGICINTS) / sizeof(MAGICINTS[0]);
+
+
+    //
+    // header of a .trr frame (sizes of the blocks in bytes)
+    //
+    struct TRRHeader
+    {
+        int irSize {0}, eSize {0}, boxSize {0}, virSize {0}, presSize {0}, topSize {0}, symSize {0};
+        int xSize {0}, vSize {0}, fSize {0};
+        int nAtoms {0}, step {0}, nre {0};
+        bool doublePrecision {false};
+        double time {0}, lambda {0};
+        std::size_t headerSize {0};
+
+        inline std::size_t bodySize() const 
+        { 
+            return static_cast<std::size_t>(irSize) + eSize + boxSize + virSize + presSize + topSize + symSize + xSize + vSize + fSize; 
+        }
+    };
+
+    //
+    // read the header of the .trr frame at the given position of the file
+    // (a header cut off by the end of the file is returned with headerSize 0)
+    //
+    TRRHeader readTRRHeader(std::ifstream& FILE, const std::string& filename, std::size_t position)
+    {
+        // (a header has less than 128 bytes)
+        std::vector<char> block (128);
+        FILE.clear();
+        FILE.seekg( position );
+        FILE.read( block.data(), block.size() );
+        const bool endOfFile = ( static_cast<std::size_t>(FILE.gcount()) < block.size() );
+        block.resize( FILE.gcount() );
+        XdrFile xdr {};
+        xdr.assign( filename, std::move(block) );
+
+        TRRHeader header {};
+        if( endOfFile && xdr.size() < sizeof(TRR_MAGIC) )   return header;
+        if( xdr.readInt() != TRR_MAGIC )   throw std::runtime_error("'" + filename + "' is not a .trr file");
+        try
+        {
+            xdr.readString();
+            for( auto size: {&header.irSize, &header.eSize, &header.boxSize, &header.virSize, &header.presSize, &header.topSize, 
+                             &header.symSize, &header.xSize, &header.vSize, &header.fSize, &header.nAtoms, &header.step, &header.nre} )
+            {
+                *size = xdr.readInt();
+            }
+            // precision from the size of the box or of the coordinates
+            if( header.boxSize > 0 )        header.doublePrecision = ( header.boxSize == 9 * sizeof(double) );
+            else if( header.nAtoms > 0 )    header.doublePrecision = ( std::max({header.xSize, header.vSize, header.fSize}) == 3 * header.nAtoms * static_cast<int>(sizeof(double)) );
+            header.time = xdr.readReal( header.doublePrecision );
+            header.lambda = xdr.readReal( header.doublePrecision );
+        }
+        catch( const std::runtime_error& )
+        {
+            if( ! endOfFile )   throw;
+            return TRRHeader {};
+        }
+        header.headerSize = xdr.tell();
+        return header;
+    }
+
+
+    //
+    // bit reader for the compressed coordinate stream
+    //
+    class BitReader
+    {
+      private:
+        const unsigned char* data {nullptr};
+        std::size_t size {0};
+        std::size_t count {0};
+        unsigned int lastBits {0};
+        unsigned int lastByte {0};
+
+        inline unsigned int nextByte()
+        {
+            if( count >= size ) throw std::runtime_error("corrupt compressed coordinates in .xtc file");
+            return data[count++];
+        }
+
+      public:
+        explicit BitReader(const std::string& buffer)
+            : data(reinterpret_cast<const unsigned char*>(buffer.data())), size(buffer.size()) {}
+
+        inline int receiveBits(int nBits)
+        {
+            const unsigned int mask = ( nBits >= 32 ) ? 0xffffffffu : ( (1u << nBits) - 1 );
+            unsigned int num = 0;
+            while( nBits >= 8 )
+            {
+                lastByte = (lastByte << 8) | nextByte();
+                num |= (lastByte >> lastBits) << (nBits - 8);
+                nBits -= 8;
+            }
+            if( nBits > 0 )
+            {
+                if( static_cast<int>(lastBits) < nBits )
+                {
+                    lastBits += 8;
+                    lastByte = (lastByte << 8) | nextByte();
+                }
+                lastBits -= nBits;
+                num |= (lastByte >> lastBits) & ((1u << nBits) - 1);
+            }
+            return static_cast<int>(num & mask);
+        }
+
+        inline void receiveInts(int nBits, const unsigned int sizes[3], int nums[3])
+        {
+            int bytes[32] = {0};
+            int nBytes = 0;
+            while( nBits > 8 )
+            {
+                bytes[nBytes++] = receiveBits(8);
+                nBits -= 8;
+            }
+            if( nBits > 0 )
+            {
+                bytes[nBytes++] = receiveBits(nBits);
+            }
+            for( int i=2; i>0; --i )
+            {
+                unsigned int num = 0;
+                for( int j=nBytes-1; j>=0; --j )
+                {
+                    num = (num << 8) | static_cast<unsigned int>(bytes[j]);
+                    unsigned int p = num / sizes[i];
+                    bytes[j] = static_cast<int>(p);
+                    num = num - p * sizes[i];
+                }
+                nums[i] = static_cast<int>(num);
+            }
+            nums[0] = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
+        }
+    };
+
+
+    inline int sizeOfInt(unsigned int size)
+    {
+        unsigned long long num = 1;
+        int nBits = 0;
+        while( size >= num && nBits < 32 )
+        {
+            ++ nBits;
+            num <<= 1;
+        }
+        return nBits;
+    }
+
+
+    inline int sizeOfInts(const unsigned int sizes[3])
+    {
+        unsigned int bytes[32] = {0};
+        int nBytes = 1;
+        int nBits = 0;
+        bytes[0] = 1;
+        for( int i=0; i<3; ++i )
+        {
+            unsigned int tmp = 0;
+            int byteCount = 0;
+            for( byteCount=0; byteCount<nBytes; ++byteCount )
+            {
+                tmp = bytes[byteCount] * sizes[i] + tmp;
+                bytes[byteCount] = tmp & 0xff;
+                tmp >>= 8;
+            }
+            while( tmp != 0 )
+            {
+                bytes[byteCount++] = tmp & 0xff;
+                tmp >>= 8;
+            }
+            nBytes = byteCount;
+        }
+        unsigned int num = 1;
+        --nBytes;
+        while( bytes[nBytes] >= num )
+        {
+            ++ nBits;
+            num *= 2;
+        }
+        return nBits + nBytes * 8;
+    }
+
+
+    //
+    // decompress coordinates of one frame
+    //
+    void decompressCoordinates(XdrFile& file, std::vector<float>& x)
+    {
+        const int nAtoms = file.readInt();
+        if( static_cast<std::size_t>(nAtoms) * 3 != x.size() )
+        {
+            throw std::runtime_error("inconsistent number of atoms in .xtc file '" + file.name() + "'");
+        }
+
+        // small systems are stored uncompressed
+        if( nAtoms <= 9 )
+        {
+            for( auto& value: x )   value = file.readFloat();
+            return;
+        }
+
+        const float precision = file.readFloat();
+        const float invPrecision = 1.0f / precision;
+
+        int minInt[3], maxInt[3];
+        for( auto& i: minInt )  i = file.readInt();
+        for( auto& i: maxInt )  i = file.readInt();
+
+        unsigned int sizeInt[3];
+        int bitSizeInt[3] = {0, 0, 0};
+        int bitSize = 0;
+        for( int i=0; i<3; ++i )    sizeInt[i] = static_cast<unsigned int>(maxInt[i] - minInt[i] + 1);
+        if( (sizeInt[0] | sizeInt[1] | sizeInt[2]) > 0xffffff )
+        {
+            for( int i=0; i<3; ++i )    bitSizeInt[i] = sizeOfInt(sizeInt[i]);
+        }
+        else
+        {
+            bitSize = sizeOfInts(sizeInt);
+        }
+
+        int smallIdx = file.readInt();
+        if( smallIdx < FIRSTIDX || smallIdx >= LASTIDX )
+        {
+            throw std::runtime_error("corrupt compressed coordinates in .xtc file '" + file.name() + "'");
+        }
+        int smaller = MAGICINTS[ std::max(FIRSTIDX, smallIdx-1) ] / 2;
+        int smallNum = MAGICINTS[smallIdx] / 2;
+        unsigned int sizeSmall[3];
+        std::fill( sizeSmall, sizeSmall+3, static_cast<unsigned int>(MAGICINTS[smallIdx]) );
+
+        const int nBytes = file.readInt();
+        const std::string compressed = file.readOpaque( static_cast<std::size_t>(nBytes) );
+        BitReader bits( compressed );
+
+        int thisCoord[3], prevCoord[3];
+        int run = 0;
+        int i = 0;
+        float* out = x.data();
+        while( i < nAtoms )
+        {
+            if( bitSize == 0 )
+            {
+                for( int k=0; k<3; ++k )    thisCoord[k] = bits.receiveBits(bitSizeInt[k]);
+            }
+            else
+            {
+                bits.receiveInts(bitSize, sizeInt, thisCoord);
+            }
+            ++i;
+            for( int k=0; k<3; ++k )
+            {
+                thisCoord[k] += minInt[k];
+                prevCoord[k] = thisCoord[k];
+            }
+
+            int isSmaller = 0;
+            if( bits.receiveBits(1) == 1 )
+            {
+                run = bits.receiveBits(5);
+                isSmaller = run % 3;
+                run -= isSmaller;
+                --isSmaller;
+            }
+
+            if( run > 0 )
+            {
+                if( i + run/3 > nAtoms )
+                {
+                    throw std::runtime_error("corrupt compressed coordinates in .xtc file '" + file.name() + "'");
+                }
+                for( int k=0; k<run; k+=3 )
+                {
+                    bits.receiveInts(smallIdx, sizeSmall, thisCoord);
+                    ++i;
+                    for( int l=0; l<3; ++l )    thisCoord[l] += prevCoord[l] - smallNum;
+                    if( k == 0 )
+                    {
+                        // first and second atom are interchanged
+                        // (for better compression of water molecules)
+                        for( int l=0; l<3; ++l )    std::swap( thisCoord[l], prevCoord[l] );
+                        for( int l=0; l<3; ++l )    *out++ = prevCoord[l] * invPrecision;
+                    }
+                    else
+                    {
+                        for( int l=0; l<3; ++l )    prevCoord[l] = thisCoord[l];
+                    }
+                    for( int l=0; l<3; ++l )    *out++ = thisCoord[l] * invPrecision;
+                }
+            }
+            else
+            {
+                for( int l=0; l<3; ++l )    *out++ = thisCoord[l] * invPrecision;
+            }
+
+            smallIdx += isSmaller;
+            if( smallIdx < FIRSTIDX || smallIdx >= LASTIDX )
+            {
+                throw std::runtime_error("corrupt compressed coordinates in .xtc file '" + file.name() + "'");
+            }
+            if( isSmaller < 0 )
+            {
+                smallNum = smaller;
+                smaller = ( smallIdx > FIRSTIDX ) ? MAGICINTS[smallIdx-1] / 2 : 0;
+            }
+            else if( isSmaller > 0 )
+            {
+                smaller = smallNum;
+                smallNum = MAGICINTS[smallIdx] / 2;
+            }
+            std::fill( sizeSmall, sizeSmall+3, static_cast<unsigned int>(MAGICINTS[smallIdx]) );
+        }
+    }
+}
+
+
+
+//
+// read one frame of a .xtc file
+//
+bool TrajectoryParserGMX::readXTCFrame(XdrFile& file, TrajectoryFrame& frame)
+{
+    if( file.eof() )    return false;
+
+    if( file.readInt() != XTC_MAGIC )
+    {
+        throw std::runtime_error("magic number mismatch in .xtc file '" + file.name() + "'");
+    }
+    const int nAtoms = file.readInt();
+    frame.step = file.readInt();
+    frame.time = file.readFloat();
+    for( auto& b: frame.box )   b = file.readFloat();
+    frame.x.resize( 3 * static_cast<std::size_t>(nAtoms) );
+
+    decompressCoordinates(file, frame.x);
+    return true;
+}
+
+
+
+//
+// read all frames of a .xtc file
+//
+std::vector<TrajectoryFrame> TrajectoryParserGMX::readXTC(const std::string& filename)
+{
+    XdrFile file( filename );
+    std::vector<TrajectoryFrame> frames {};
+    TrajectoryFrame frame {};
+    while( readXTCFrame(file, frame) )
+    {
+        frames.push_back( frame );
+    }
+    return frames;
+}
+
+
+
+//
+// read the last frame with coordinates of a .trr file
+// (only the headers of all other frames are read, a truncated frame at the end is ignored)
+//
+bool TrajectoryParserGMX::readLastTRRFrame(const std::string& filename, TrajectoryFrame& frame)
+{
+    std::error_code error {};
+    const auto fileSize = std::filesystem::file_size( filename, error );
+    if( error )     return false;
+    std::ifstream FILE( filename, std::ios::binary );
+    if( ! FILE )    return false;
+
+    // find last complete frame with coordinates
+    std::size_t position {0};
+    std::size_t last {fileSize};
+    TRRHeader header {};
+    while( position < fileSize )
+    {
+        const auto current = readTRRHeader( FILE, filename, position );
+        if( current.headerSize == 0 )   break;
+        const auto end = position + current.headerSize + current.bodySize();
+        if( end > fileSize )    break;
+        if( current.xSize > 0 )
+        {
+            last = position;
+            header = current;
+        }
+        position = end;
+    }
+    if( last == fileSize )  return false;
+
+    // read this frame
+    std::vector<char> body ( header.bodySize() );
+    FILE.clear();
+    FILE.seekg( last + header.headerSize );
+    if( ! FILE.read(body.data(), body.size()) )     throw std::runtime_error("unexpected end of file '" + filename + "'");
+    XdrFile xdr {};
+    xdr.assign( filename, std::move(body) );
+
+    const std::size_t nValues = 3 * static_cast<std::size_t>(header.nAtoms);
+    frame.step = header.step;
+    frame.time = header.time;
+    frame.lambda = header.lambda;
+    xdr.skip( header.irSize + header.eSize );
+    if( header.boxSize > 0 )
+    {
+        for( auto& b: frame.box )   b = xdr.readReal( header.doublePrecision );
+    }
+    xdr.skip( header.virSize + header.presSize + header.topSize + header.symSize );
+    frame.x.resize( nValues );
+    for( auto& value: frame.x )     value = static_cast<float>( xdr.readReal(header.doublePrecision) );
+    frame.v.clear();
+    if( header.vSize > 0 )
+    {
+        frame.v.resize( nValues );
+        for( auto& value: frame.v )     value = static_cast<float>( xdr.readReal(header.doublePrecision) );
+    }
+    return true;
+}
+
+
+
+//
+// write one frame (box + coordinates (+ velocities), single precision) to a .trr buffer
+//
+void TrajectoryParserGMX::writeTRRFrame(XdrWriter& writer, const TrajectoryFrame& frame)
+{
+    const int nAtoms = static_cast<int>(frame.x.size() / 3);
+
+    writer.writeInt( TRR_MAGIC );
+    writer.writeString( "GMX_trn_file" );
+    writer.writeInt( 0 );                       // ir_size
+    writer.writeInt( 0 );                       // e_size
+    writer.writeInt( 9 * sizeof(float) );       // box_size
+    writer.writeInt( 0 );                       // vir_size
+    writer.writeInt( 0 );                       // pres_size
+    writer.writeInt( 0 );                       // top_size
+    writer.writeInt( 0 );                       // sym_size
+    writer.writeInt( 3 * nAtoms * sizeof(float) );  // x_size
+    writer.writeInt( static_cast<int>(frame.v.size() * sizeof(float)) );    // v_size
+    writer.writeInt( 0 );                       // f_size
+    writer.writeInt( nAtoms );
+    writer.writeInt( static_cast<int>(frame.step) );
+    writer.writeInt( 0 );                       // nre
+    writer.writeFloat( static_cast<float>(frame.time) );
+    writer.writeFloat( static_cast<float>(frame.lambda) );
+    for( const auto& b: frame.box )  writer.writeFloat( static_cast<float>(b) );
+    for( const auto& value: frame.x )  writer.writeFloat( value );
+    for( const auto& value: frame.v )  writer.writeFloat( value );
+}
+
+
+
+//
+// write frames to a .trr file
+//
+void TrajectoryParserGMX::writeTRR(const std::string& filename, const std::vector<TrajectoryFrame>& frames)
+{
+    XdrWriter writer {};
+    for( const auto& frame: frames )
+    {
+        writeTRRFrame(writer, frame);
+    }
+    writer.save(filename);
+}
+
+
+
+//
+// write the given atoms of a .gro file to a new .gro file
+//
+void TrajectoryParserGMX::writeSubsetGRO(const std::string& input, const std::string& output, const std::vector<std::size_t>& atoms)
+{
+    std::ifstream IN( input );
+    if( ! IN )  throw std::runtime_error("could not read file '" + input + "'");
+
+    std::string title {}, line {};
+    std::size_t nAtoms = 0;
+    std::getline( IN, title );
+    std::getline( IN, line );
+    nAtoms = std::stoul( line );
+
+    std::vector<std::string> lines (nAtoms);
+    for( auto& atomLine: lines )
+    {
+        if( ! std::getline(IN, atomLine) ) throw std::runtime_error("unexpected end of file '" + input + "'");
+    }
+    std::string box {};
+    std::getline( IN, box );
+
+    std::ofstream OUT( output );
+    if( ! OUT ) throw std::runtime_error("could not write file '" + output + "'");
+    OUT << title << '\n' << atoms.size() << '\n';
+    for( const auto& atom: atoms )
+    {
+        OUT << lines.at(atom) << '\n';
+    }
+    OUT << box << '\n';
+}
+
+
+
+//
+// write the given atoms (0-based indices) of a .gro/.xtc file to a .gro/.trr file
+//
+void TrajectoryParserGMX::writeSubset(const std::string& input, const std::string& output, const std::vector<std::size_t>& atoms)
+{
+    const auto extension = std::filesystem::path(input).extension();
+    if( extension == ".gro" )
+    {
+        writeSubsetGRO( input, output, atoms );
+        return;
+    }
+    if( extension != ".xtc" || std::filesystem::path(output).extension() != ".trr" )
+    {
+        throw std::runtime_error("cannot write subset of '" + input + "' to '" + output + "'");
+    }
+
+    XdrFile file( input );
+    XdrWriter writer {};
+    TrajectoryFrame frame {}, subset {};
+    subset.x.resize( 3 * atoms.size() );
+    while( readXTCFrame(file, frame) )
+    {
+        subset.step = frame.step;
+        subset.time = frame.time;
+        subset.box = frame.box;
+        for( std::size_t i=0; i<atoms.size(); ++i )
+        {
+            if( 3*atoms[i] + 2 >= frame.x.size() )  throw std::runtime_error("atom index out of range in file '" + input + "'");
+            std::copy_n( frame.x.begin() + 3*atoms[i], 3, subset.x.begin() + 3*i );
+        }
+        writeTRRFrame( writer, subset );
+    }
+    writer.save( output );
+}
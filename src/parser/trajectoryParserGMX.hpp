@@ -0,0 +1,71 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+#include "parser/xdrFile.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+//
+// trajectory parser that reads/writes
+// gromacs (GMX) trajectories
+// from/to .xtc, .trr & .gro files
+//
+// note: .xtc files are only read (decompressed), subsets are written
+//       as (uncompressed, single precision) .trr files
+//       of .trr files only the last (complete) frame is read, e.g. the end of a run
+//
+
+struct TrajectoryFrame
+{
+    std::int64_t          step {0};
+    double                time {0};
+    double                lambda {0};
+    std::array<double, 9> box {};
+    std::vector<float>    x {};     // x0 y0 z0 x1 y1 z1 ...
+    std::vector<float>    v {};     // velocities (same layout, empty if not available)
+};
+
+
+class TrajectoryParserGMX
+{
+  private:
+    static bool readXTCFrame(XdrFile&, TrajectoryFrame&);
+    static void writeTRRFrame(XdrWriter&, const TrajectoryFrame&);
+    static void writeSubsetGRO(const std::string&, const std::string&, const std::vector<std::size_t>&);
+
+  public:
+    //
+    // read all frames of a .xtc file
+    //
+    static std::vector<TrajectoryFrame> readXTC(const std::string&);
+
+    //
+    // read the last frame with coordinates of a .trr file (single or double precision),
+    // returns false if the file does not exist or has no such frame
+    //
+    static bool readLastTRRFrame(const std::string&, TrajectoryFrame&);
+
+    //
+    // write frames to a .trr file
+    //
+    static void writeTRR(const std::string&, const std::vector<TrajectoryFrame>&);
+
+    //
+    // write the given atoms (0-based indices) of a .gro/.xtc file to a .gro/.trr file
+    //
+    static void writeSubset(const std::string&, const std::string&, const std::vector<std::size_t>&);
+};
@@ -0,0 +1,66 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "parser/xdrFile.hpp"
+
+#include <fstream>
+#include <utility>
+
+
+//
+// read the whole file into memory
+//
+void XdrFile::open(const std::string& name)
+{
+    filename = name;
+    position = 0;
+    buffer.clear();
+
+    std::ifstream FILE( filename, std::ios::binary | std::ios::ate );
+    if( ! FILE )
+    {
+        throw std::runtime_error("could not open file '" + filename + "'");
+    }
+
+    const auto size = FILE.tellg();
+    buffer.resize( static_cast<std::size_t>(size) );
+    FILE.seekg(0, std::ios::beg);
+    if( ! FILE.read(buffer.data(), size) )
+    {
+        throw std::runtime_error("could not read file '" + filename + "'");
+    }
+}
+
+
+
+//
+// use data that is already in memory
+//
+void XdrFile::assign(const std::string& name, std::vector<char>&& data)
+{
+    filename = name;
+    position = 0;
+    buffer = std::move(data);
+}
+
+
+
+//
+// write buffer to file
+//
+void XdrWriter::save(const std::string& filename) const
+{
+    std::ofstream FILE( filename, std::ios::binary | std::ios::trunc );
+    if( ! FILE || ! FILE.write(buffer.data(), buffer.size()) )
+    {
+        throw std::runtime_error("could not write file '" + filename + "'");
+    }
+}
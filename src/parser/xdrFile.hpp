@@ -0,0 +1,188 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+//
+// a minimal reader/writer for files in XDR format (big endian, 4 byte aligned),
+// as used by gromacs for binary files (.edr, .xtc, .trr)
+//
+// the whole file is read into memory at once, 
+// respectively written from memory at once
+//
+
+class XdrFile
+{
+  private:
+    std::string       filename {};
+    std::vector<char> buffer {};
+    std::size_t       position {0};
+
+    inline void require(std::size_t n) const
+    {
+        if( position + n > buffer.size() )
+            throw std::runtime_error("unexpected end of file '" + filename + "'");
+    }
+
+    inline std::uint32_t readUInt32()
+    {
+        require(4);
+        const auto* bytes = reinterpret_cast<const unsigned char*>(buffer.data() + position);
+        position += 4;
+        return (std::uint32_t(bytes[0]) << 24) | (std::uint32_t(bytes[1]) << 16) | (std::uint32_t(bytes[2]) << 8) | std::uint32_t(bytes[3]);
+    }
+
+  public:
+    XdrFile() = default;
+    explicit XdrFile(const std::string& name) { open(name); }
+
+    //
+    // read the whole file into memory
+    //
+    void open(const std::string&);
+
+    //
+    // use data that is already in memory
+    //
+    void assign(const std::string&, std::vector<char>&&);
+
+    inline bool eof() const { return position >= buffer.size(); }
+    inline std::size_t tell() const { return position; }
+    inline std::size_t size() const { return buffer.size(); }
+    inline void seek(std::size_t pos) { position = pos; }
+    inline void skip(std::size_t n) { require(n); position += n; }
+    inline const std::string& name() const { return filename; }
+
+    inline int readInt() { return static_cast<std::int32_t>(readUInt32()); }
+    inline unsigned int readUInt() { return readUInt32(); }
+
+    inline std::int64_t readInt64()
+    {
+        // xdr hyper: high word first
+        std::uint64_t high = readUInt32();
+        std::uint64_t low = readUInt32();
+        return static_cast<std::int64_t>( (high << 32) | low );
+    }
+
+    inline float readFloat()
+    {
+        std::uint32_t raw = readUInt32();
+        float value;
+        std::memcpy(&value, &raw, sizeof(float));
+        return value;
+    }
+
+    inline double readDouble()
+    {
+        std::uint64_t high = readUInt32();
+        std::uint64_t low = readUInt32();
+        std::uint64_t raw = (high << 32) | low;
+        double value;
+        std::memcpy(&value, &raw, sizeof(double));
+        return value;
+    }
+
+    // gromacs 'real': float or double depending on precision of the file
+    inline double readReal(bool doublePrecision) { return doublePrecision ? readDouble() : readFloat(); }
+
+    //
+    // xdr opaque data: n bytes, padded to multiple of 4
+    //
+    inline std::string readOpaque(std::size_t n)
+    {
+        std::size_t padded = (n + 3) & ~std::size_t(3);
+        require(padded);
+        std::string value( buffer.data() + position, n );
+        position += padded;
+        return value;
+    }
+
+    //
+    // gromacs string: int (length incl. '\0') followed by an xdr string
+    //
+    inline std::string readString()
+    {
+        readInt();
+        std::size_t n = readUInt();
+        return readOpaque(n);
+    }
+};
+
+
+
+class XdrWriter
+{
+  private:
+    std::vector<char> buffer {};
+
+    inline void writeUInt32(std::uint32_t value)
+    {
+        buffer.push_back( static_cast<char>((value >> 24) & 0xff) );
+        buffer.push_back( static_cast<char>((value >> 16) & 0xff) );
+        buffer.push_back( static_cast<char>((value >> 8) & 0xff) );
+        buffer.push_back( static_cast<char>(value & 0xff) );
+    }
+
+  public:
+    //
+    // write buffer to file
+    //
+    void save(const std::string&) const;
+
+    inline const std::vector<char>& data() const { return buffer; }
+    inline void clear() { buffer.clear(); }
+    inline void reserve(std::size_t n) { buffer.reserve(n); }
+    inline std::size_t size() const { return buffer.size(); }
+
+    inline void writeInt(int value) { writeUInt32( static_cast<std::uint32_t>(value) ); }
+    inline void writeUInt(unsigned int value) { writeUInt32( value ); }
+
+    inline void writeInt64(std::int64_t value)
+    {
+        const auto raw = static_cast<std::uint64_t>(value);
+        writeUInt32( static_cast<std::uint32_t>(raw >> 32) );
+        writeUInt32( static_cast<std::uint32_t>(raw & 0xffffffff) );
+    }
+
+    inline void writeFloat(float value)
+    {
+        std::uint32_t raw;
+        std::memcpy(&raw, &value, sizeof(float));
+        writeUInt32(raw);
+    }
+
+    inline void writeDouble(double value)
+    {
+        std::uint64_t raw;
+        std::memcpy(&raw, &value, sizeof(double));
+        writeUInt32( static_cast<std::uint32_t>(raw >> 32) );
+        writeUInt32( static_cast<std::uint32_t>(raw & 0xffffffff) );
+    }
+
+    //
+    // gromacs string: int (length incl. '\0') followed by an xdr string
+    //
+    inline void writeString(const std::string& value)
+    {
+        writeInt( static_cast<int>(value.size()) + 1 );
+        writeUInt( static_cast<unsigned int>(value.size()) );
+        buffer.insert( buffer.end(), value.begin(), value.end() );
+        buffer.resize( (buffer.size() + 3) & ~std::size_t(3), 0 );
+    }
+};
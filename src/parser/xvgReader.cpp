@@ -0,0 +1,223 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "parser/xvgReader.hpp"
+
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
+#include <map>
+#include <cctype>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace
+{
+    //
+    // read-only memory mapping of a whole file
+    //
+    class MappedFile
+    {
+      private:
+        int         fd {-1};
+        const char* data {nullptr};
+        std::size_t size {0};
+
+      public:
+        explicit MappedFile(const std::string& filename)
+        {
+            fd = ::open( filename.c_str(), O_RDONLY );
+            if( fd < 0 )    throw std::runtime_error("could not open file '" + filename + "'");
+
+            struct stat info {};
+            if( ::fstat(fd, &info) < 0 )
+            {
+                ::close(fd);
+                throw std::runtime_error("could not stat file '" + filename + "'");
+            }
+            size = static_cast<std::size_t>(info.st_size);
+            if( size == 0 ) return;
+
+            void* address = ::mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if( address == MAP_FAILED )
+            {
+                ::close(fd);
+                throw std::runtime_error("could not map file '" + filename + "'");
+            }
+            data = static_cast<const char*>(address);
+        }
+
+        ~MappedFile()
+        {
+            if( data )      ::munmap( const_cast<char*>(data), size );
+            if( fd >= 0 )   ::close(fd);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        inline std::string_view view() const { return std::string_view(data, size); }
+    };
+
+
+    inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    inline std::string_view trimFront(std::string_view line)
+    {
+        std::size_t i = 0;
+        while( i < line.size() && isSpace(line[i]) ) ++i;
+        return line.substr(i);
+    }
+}
+
+
+
+//
+// read legends from the header, i.e. lines like '@ s0 legend "Potential"',
+// and set dataStart to the position of the first data line
+//
+std::vector<std::string> XvgReader::readLegends(std::string_view content, std::size_t& dataStart)
+{
+    std::map<std::size_t, std::string> legends {};
+    std::size_t pos = 0;
+    dataStart = content.size();
+
+    while( pos < content.size() )
+    {
+        std::size_t end = content.find('\n', pos);
+        if( end == std::string_view::npos ) end = content.size();
+        auto line = trimFront( content.substr(pos, end-pos) );
+
+        if( ! line.empty() && line[0] != '#' && line[0] != '@' && line[0] != '&' )
+        {
+            dataStart = pos;
+            break;
+        }
+
+        if( ! line.empty() && line[0] == '@' )
+        {
+            line = trimFront( line.substr(1) );
+            if( line.size() > 1 && line[0] == 's' && std::isdigit(static_cast<unsigned char>(line[1])) )
+            {
+                std::size_t set = 0;
+                auto [ptr, error] = std::from_chars( line.data()+1, line.data()+line.size(), set );
+                line = trimFront( line.substr(ptr - line.data()) );
+                if( error == std::errc() && line.substr(0, 6) == "legend" )
+                {
+                    auto first = line.find('"');
+                    auto last = line.rfind('"');
+                    if( first != std::string_view::npos && last > first )
+                    {
+                        legends[set] = std::string( line.substr(first+1, last-first-1) );
+                    }
+                }
+            }
+        }
+        pos = end + 1;
+    }
+
+    std::vector<std::string> names {};
+    for( const auto& [set, name]: legends )
+    {
+        if( names.size() <= set )   names.resize(set+1);
+        names[set] = name;
+    }
+    return names;
+}
+
+
+
+//
+// read values of the given columns from file,
+// averaged over all frames with time >= (last time - window) (0: only last frame)
+//
+std::vector<double> XvgReader::read(const std::string& filename, const std::vector<std::string>& columnNames, double window)
+{
+    MappedFile file( filename );
+    const auto content = file.view();
+
+    // header: map column names to column indices (0 is time)
+    std::size_t dataStart = 0;
+    const auto legends = readLegends( content, dataStart );
+
+    std::vector<std::size_t> columns {};
+    for( std::size_t i=0; i<columnNames.size(); ++i )
+    {
+        if( legends.empty() )
+        {
+            columns.push_back( i+1 );
+            continue;
+        }
+        auto it = std::find( legends.begin(), legends.end(), columnNames[i] );
+        if( it == legends.end() )
+        {
+            throw std::runtime_error("no legend '" + columnNames[i] + "' in file '" + filename + "'");
+        }
+        columns.push_back( std::distance(legends.begin(), it) + 1 );
+    }
+    const std::size_t nColumns = columns.empty() ? 1 : *std::max_element(columns.begin(), columns.end()) + 1;
+
+    // data: backwards from the end of the file
+    std::vector<double> sums (columns.size(), 0);
+    std::vector<double> row (nColumns, 0);
+    double timeMargin = 0;
+    nFrames = 0;
+
+    std::size_t end = content.size();
+    while( end > dataStart )
+    {
+        std::size_t begin = content.rfind('\n', end-1);
+        begin = ( begin == std::string_view::npos || begin < dataStart ) ? dataStart : begin+1;
+        auto line = trimFront( content.substr(begin, end-begin) );
+        end = ( begin > dataStart ) ? begin-1 : dataStart;
+
+        if( line.empty() || line[0] == '#' || line[0] == '@' || line[0] == '&' )   continue;
+
+        // parse first nColumns values of this line
+        const char* ptr = line.data();
+        const char* last = line.data() + line.size();
+        for( std::size_t c=0; c<nColumns; ++c )
+        {
+            while( ptr < last && isSpace(*ptr) ) ++ptr;
+            auto result = std::from_chars( ptr, last, row[c] );
+            if( result.ec != std::errc() )
+            {
+                throw std::runtime_error("could not parse line '" + std::string(line) + "' in file '" + filename + "'");
+            }
+            ptr = result.ptr;
+        }
+
+        if( nFrames == 0 )
+        {
+            lastTime = row[0];
+            timeMargin = std::max( 0.0, lastTime - window );
+        }
+        else if( row[0] < timeMargin )
+        {
+            break;
+        }
+
+        for( std::size_t i=0; i<columns.size(); ++i )   sums[i] += row[columns[i]];
+        ++ nFrames;
+
+        if( window == 0 )   break;
+    }
+
+    if( nFrames == 0 )
+    {
+        throw std::runtime_error("no data in file '" + filename + "'");
+    }
+    for( auto& sum: sums )  sum /= nFrames;
+    return sums;
+}
@@ -0,0 +1,50 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// reader for .xvg files (as written by gromacs)
+//
+// columns are selected by the names given in the '@ sN legend "..."' header lines
+// (or by position if the file has no legends, i.e. column i+1 for the i-th name),
+// the file is memory mapped, the header is read forward and the data backward
+// from the end of the file, such that only the last frame or the frames within
+// the trailing averaging window are parsed
+//
+
+class XvgReader
+{
+  private:
+    double      lastTime {0};
+    std::size_t nFrames {0};
+
+    static std::vector<std::string> readLegends(std::string_view, std::size_t&);
+
+  public:
+    //
+    // read values of the given columns from file,
+    // averaged over all frames with time >= (last time - window) (0: only last frame)
+    //
+    std::vector<double> read(const std::string&, const std::vector<std::string>&, double);
+
+    //
+    // some getters (refer to the last read)
+    //
+    inline auto getLastTime() const { return lastTime; }
+    inline auto getNFrames()  const { return nFrames; }
+};
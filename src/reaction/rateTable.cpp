@@ -0,0 +1,59 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "reaction/rateTable.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+//
+// resample the table (sorted by distance) onto a uniform grid
+//
+RateTable::RateTable(const std::vector<std::pair<REAL, REAL>>& table)
+{
+    if( table.empty() )     return;
+
+    first = table.front().first;
+    const REAL range = table.back().first - first;
+    if( table.size() == 1 || !(range > 0) )
+    {
+        values.push_back( table.back().second );
+        return;
+    }
+
+    // resolve the smallest distance step of the table by a few grid points
+    REAL smallestStep = range;
+    for( std::size_t i=1; i<table.size(); ++i )
+    {
+        const REAL step = table[i].first - table[i-1].first;
+        if( step > 0 )  smallestStep = std::min( smallestStep, step );
+    }
+    // (round-off of the distances is ignored, so that e.g. a table with equidistant points keeps them on the grid)
+    const REAL ratio = range / smallestStep * pointsPerStep;
+    const auto nIntervals = static_cast<std::size_t>( std::clamp<REAL>( std::ceil(ratio * (1 - 1e-4)), 1, maxGridPoints - 1 ) );
+    const REAL spacing = range / nIntervals;
+    inverseSpacing = 1 / spacing;
+
+    // piecewise linear interpolation of the table at the grid points
+    // (for duplicate distances, the last entry is used from there on)
+    values.resize( nIntervals + 1 );
+    std::size_t upper = 0;
+    for( std::size_t i=0; i<values.size(); ++i )
+    {
+        const REAL distance = ( i + 1 == values.size() ? table.back().first : first + i * spacing );
+        while( upper + 1 < table.size() && table[upper].first <= distance )     ++ upper;
+        const auto& [d0, r0] = table[upper - 1];
+        const auto& [d1, r1] = table[upper];
+        if( distance >= d1 )        values[i] = r1;
+        else if( !(d1 > d0) )       values[i] = r1;
+        else                        values[i] = r0 + (distance - d0) / (d1 - d0) * (r1 - r0);
+    }
+}
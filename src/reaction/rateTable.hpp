@@ -0,0 +1,67 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include "definitions.hpp"
+
+#include <vector>
+#include <utility>
+
+//
+// a distance-dependent reaction rate
+//
+// the (sorted) [rate] table of (distance, rate) pairs is resampled once
+// onto a uniform grid (piecewise linear between the given points,
+// constant outside of the given distance range),
+// so that the rate of a candidate is an O(1) indexed linear interpolation
+//
+
+class RateTable
+{
+  private:
+    REAL first {0};                 // distance of the first grid point
+    REAL inverseSpacing {0};        // 1 / grid spacing
+    std::vector<REAL> values {};    // rates at the grid points
+
+    // upper bound of grid points, the grid spacing is coarsened to stay below
+    static constexpr std::size_t maxGridPoints {4096};
+
+    // grid spacing relative to the smallest distance step in the table
+    static constexpr std::size_t pointsPerStep {8};
+
+  public:
+    RateTable() = default;
+    explicit RateTable(const std::vector<std::pair<REAL, REAL>>&);
+
+    //
+    // rate at the given distance
+    //
+    inline REAL operator()(const REAL& distance) const
+    {
+        if( values.size() == 1 )    return values.front();
+        const REAL position = (distance - first) * inverseSpacing;
+        if( !(position > 0) )   return values.front();
+        const auto i = static_cast<std::size_t>( position );
+        if( i + 1 >= values.size() )    return values.back();
+        const REAL fraction = position - i;
+        return values[i] + fraction * (values[i+1] - values[i]);
+    }
+
+    //
+    // true if the rate depends on the distance at all
+    //
+    inline bool distanceDependent() const { return values.size() > 1; }
+
+    inline auto size() const { return values.size(); }
+    inline const auto& getFirst() const { return first; }
+    inline REAL getSpacing() const { return ( inverseSpacing > 0 ? 1 / inverseSpacing : 0 ); }
+};
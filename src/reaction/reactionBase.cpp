@@ -26,6 +26,9 @@ ReactionBase::ReactionBase(const ReactionBase& other)
     , reactionEnergy(other.reactionEnergy)
     , activationEnergy(other.activationEnergy)
     , reactionRate(other.reactionRate)
+    , criterionReactant(other.criterionReactant)
+    , rateTable(other.rateTable)
+    , rateCriterion(other.rateCriterion)
 {
     for( auto& c: other.criterions )
     {
@@ -112,6 +115,10 @@ void ReactionBase::addCriterion(const std::vector<std::pair<std::size_t, std::si
 
     for(auto ix: ixList) it->get()->addAtomIndices(ix);
     it->get()->setThresholds(thresholds );
+
+    // intramolecular criterion?
+    const bool singleReactant = std::all_of( ixList.begin(), ixList.end(), [&ixList](const auto& ix){ return ix.first == ixList.front().first; });
+    criterionReactant.push_back( singleReactant ? static_cast<int>(ixList.front().first) : -1 );
 }
 
 
@@ -122,6 +129,25 @@ void ReactionBase::addTranslation(const std::vector<std::pair<std::size_t, std::
 }
 
 
+
+//
+// resample the rate table onto a uniform grid and
+// find the first distance criterion, the rate is evaluated at
+//
+void ReactionBase::setupRate()
+{
+    if( reactionRate.empty() )  return;
+    rateTable = std::make_shared<const RateTable>( reactionRate );
+
+    auto distance = std::find_if( criterions.begin(), criterions.end(), [](const auto& c){ return c->getType() == "distance"; });
+    rateCriterion = std::distance( criterions.begin(), distance );
+    if( rateTable->distanceDependent() && ! hasRateCriterion() )
+    {
+        rsmdWARNING( "    distance-dependent rate, but no distance criterion: using the rate at the smallest distance" );
+    }
+}
+
+
 //
 // consistency check:
 // - check that at least one reactant molecule is listed
@@ -14,11 +14,14 @@
 #include "definitions.hpp"
 #include "container/molecule.hpp"
 #include "reaction/criterionDerived.hpp"
+#include "reaction/rateTable.hpp"
 
 #include <string>
 #include <vector>
 #include <algorithm>
 #include <iterator>
+#include <limits>
+#include <memory>
 
 struct TransitionTable
 {
@@ -75,6 +78,15 @@ class ReactionBase
     std::vector<std::pair<REAL, REAL>> reactionRate {};
     std::vector<std::unique_ptr<CriterionBase>> criterions {};
 
+    // reactant each criterion is restricted to (all of its atoms within one reactant),
+    // -1 for criterions between reactants
+    std::vector<int>         criterionReactant {};
+
+    // resampled reactionRate and the (distance) criterion it depends on,
+    // shared between a template and all of its candidates
+    std::shared_ptr<const RateTable> rateTable {};
+    std::size_t              rateCriterion {std::numeric_limits<std::size_t>::max()};
+
     //
     // write info to a string
     // needs to be virtual because it is overwritten in derived class (ReactionCandidate)
@@ -109,6 +121,14 @@ class ReactionBase
     inline void         setRate( const std::vector<std::pair<REAL, REAL>> r ) { reactionRate = r; }
     inline const auto&  getRate()                                       const { return reactionRate; }
 
+    //
+    // resample the rate table and find the first distance criterion
+    // (to be called once for a template, after all input has been read)
+    //
+    void setupRate();
+    inline const auto&  getRateTable()       const { return rateTable; }
+    inline bool         hasRateCriterion()   const { return rateCriterion < criterions.size(); }
+
     const auto          getReactant(const std::size_t&) const;
     const auto&         getReactants()      const { return reactants; }
     auto&               getReactants()            { return reactants; }
@@ -116,6 +136,12 @@ class ReactionBase
     const auto&         getCriterions()      const { return criterions; }
     auto&               getCriterions()            { return criterions; }
 
+    inline bool         isMoleculeCriterion(const std::size_t& c)   const { return criterionReactant[c] >= 0; }
+    inline bool         hasMoleculeCriterions(const std::size_t& reactantix) const
+    {
+        return std::find( criterionReactant.begin(), criterionReactant.end(), static_cast<int>(reactantix) ) != criterionReactant.end();
+    }
+
     const auto          getProduct(const std::size_t&) const;
     const auto&         getProducts()       const { return products; }
     auto&               getProducts()             { return products; }
@@ -22,23 +22,13 @@ ReactionCandidate::ReactionCandidate(const ReactionBase& other)
 
 //
 // get current reaction rate value
+// (interpolated from the resampled rate table at the latest value of the first distance criterion)
 //
 REAL ReactionCandidate::getCurrentReactionRateValue() const
 {
-    // assumes that the first criterion is the correct distance criterion
-    // the fact that it is a "distance" criterion is never checked, 
-    // but how to assure that it is the 'correct' one?
-    // --> add notes for users ...
-    //REAL currentDistanceValue = criterions[0]->getLatest(); 
-    //REAL currentRateValue = reactionRate[0].second;    
-    //for( const auto& pair: reactionRate )
-    //{
-    //    if( pair.first > currentDistanceValue )    break;
-    //    currentRateValue = pair.second;
-    //}
-    
-    REAL currentRateValue = reactionRate[0].second;
-    return currentRateValue;
+    if( ! rateTable )   return reactionRate.empty() ? 0 : reactionRate[0].second;
+    if( ! hasRateCriterion() )  return (*rateTable)( rateTable->getFirst() );
+    return (*rateTable)( criterions[rateCriterion]->getLatest() );
 }
 
 
@@ -46,10 +36,10 @@ REAL ReactionCandidate::getCurrentReactionRateValue() const
 // get current distance value
 // (for first distance criterion)
 //
-//REAL ReactionCandidate::getCurrentDistanceValue() const
-//{
-//    return criterions[0]->getLatest();
-//}
+REAL ReactionCandidate::getCurrentDistanceValue() const
+{
+    return hasRateCriterion() ? criterions[rateCriterion]->getLatest() : 0;
+}
 
 
 // 
@@ -110,7 +100,7 @@ void ReactionCandidate::applyTranslations()
 {
     for(const auto& tt: translationTables)
     {
-        rsmdLOG("... performing translation for product atom: " 
+        rsmdVERBOSE("... performing translation for product atom: " 
                 << products[tt.indices1.first](tt.indices1.second).name
                 << " towards/away from "
                 << products[tt.indices2.first](tt.indices2.second).name );
@@ -120,14 +110,14 @@ void ReactionCandidate::applyTranslations()
 		REAL distance = vector.norm();
         vector /= vector.norm();
         rsmdDEBUG( "    position before: " << products[tt.indices1.first](tt.indices1.second).position );
-        rsmdLOG( "    distance before: " << distance );
+        rsmdVERBOSE( "    distance before: " << distance );
 		// second: translate atom along the connection vector
         products[tt.indices1.first](tt.indices1.second).position += tt.value * vector;
         vector = products[tt.indices2.first](tt.indices2.second).position
 			   - products[tt.indices1.first](tt.indices1.second).position;
 		distance = vector.norm();
 		rsmdDEBUG( "    position after: " << products[tt.indices1.first](tt.indices1.second).position );
-		rsmdLOG( "    distance after: " << distance );
+		rsmdVERBOSE( "    distance after: " << distance );
     }
 }
 
@@ -143,8 +133,11 @@ bool ReactionCandidate::valid(const REALVEC& boxDimensions, int criterion_step)
         candidate_ids.push_back ( {i, criterion_step} );
         candidate_ids.push_back ( {criterion_step, i} );
     }
-    for( const auto& criterion: criterions )
+    bool rateCriterionEvaluated = false;
+    for( std::size_t c=0; c<criterions.size(); ++c )
     {
+        auto& criterion = criterions[c];
+        if( isMoleculeCriterion(c) )    continue;
         reactmolids = {};
         for(const auto& ixPair: *criterion)
         {
@@ -164,15 +157,42 @@ bool ReactionCandidate::valid(const REALVEC& boxDimensions, int criterion_step)
                     return false;
                 } 
                         rsmdDEBUG( "... VALID: " << criterion->getLatest() << " is in [" << criterion->getMin() << ", " << criterion->getMax() << "]" )
+                if( c == rateCriterion )    rateCriterionEvaluated = true;
             }
         }
     }
+    // a complete candidate is (re)built from the template, so the distance the rate depends on
+    // is only cached if it was checked in this step: evaluate it once more if required
+    if( criterion_step + 1 == static_cast<int>(reactants.size()) && ! rateCriterionEvaluated
+        && rateTable && rateTable->distanceDependent() && hasRateCriterion() )
+    {
+        criterions[rateCriterion]->valid(reactants, boxDimensions);
+    }
     rsmdDEBUG( "... all criterions are valid!" );
     rsmdDEBUG(" ");
     return true;
 }
 
 
+//
+// check validity of all criterions within the given reactant
+//
+bool ReactionCandidate::validMolecule(const REALVEC& boxDimensions, std::size_t reactantix)
+{
+    for( std::size_t c=0; c<criterions.size(); ++c )
+    {
+        if( criterionReactant[c] != static_cast<int>(reactantix) )  continue;
+        if( ! criterions[c]->valid(reactants, boxDimensions) )
+        {
+            rsmdDEBUG( "... INVALID (reactant " << reactantix + 1 << "): " << criterions[c]->getLatest() << " not in [" << criterions[c]->getMin() << ", " << criterions[c]->getMax() << "]" );
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
 //
 // write to string - short version
 //
@@ -74,10 +74,16 @@ class ReactionCandidate
     void applyTranslations();
 
     //
-    // check validity of all criterions
+    // check validity of all criterions between the reactant of the given step and the ones before
+    // (criterions within a single reactant are left to validMolecule())
     //
     bool valid(const REALVEC&, int criterion_number);
 
+    //
+    // check validity of all criterions within the given reactant
+    //
+    bool validMolecule(const REALVEC&, std::size_t);
+
     //
     // write to stream - short version
     //
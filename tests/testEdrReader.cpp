@@ -0,0 +1,104 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "testing.hpp"
+#include "parser/edrReader.hpp"
+#include "engine/engineMock.hpp"
+
+#include <random>
+
+//
+// fixtures: .edr files of the mock md engine,
+// i.e. 11 frames at t = 0 ... 10 ps with Potential = -10 kJ/mol per atom (+ a little noise)
+//
+
+namespace
+{
+    constexpr std::size_t nAtoms {100};
+    constexpr std::size_t nFrames {11};
+
+    // bytes per frame: frame header (72) + 3 single precision energy terms
+    constexpr std::size_t frameSize {72 + 3 * 4};
+
+    std::string writeEnergies(const testing::TemporaryDirectory& directory)
+    {
+        std::mt19937_64 rng {42};
+        const auto filename = directory / "ener.edr";
+        EngineMock::writeEnergies( filename, nAtoms, 0.01, rng );
+        return filename;
+    }
+}
+
+
+rsmdTEST(edrReadsAllFrames)
+{
+    testing::TemporaryDirectory directory {};
+    const auto filename = writeEnergies( directory );
+
+    EdrReader reader {};
+    reader.read( filename, {"LJ-SR:xxx-rest", "Potential"} );
+    rsmdCHECK( reader.getNFrames() == nFrames );
+    rsmdCHECK_CLOSE( reader.getTimes().front(), 0.0, 1e-12 );
+    rsmdCHECK_CLOSE( reader.getTimes().back(), 10.0, 1e-12 );
+    rsmdCHECK_CLOSE( reader.getValues(0).back(), -1.0 * nAtoms, 0.1 );
+    rsmdCHECK_CLOSE( reader.getValues(1).back(), -10.0 * nAtoms, 0.1 );
+}
+
+
+rsmdTEST(edrMissingTerm)
+{
+    testing::TemporaryDirectory directory {};
+    const auto filename = writeEnergies( directory );
+
+    EdrReader reader {};
+    rsmdCHECK_THROWS( reader.read( filename, {"Kinetic En."} ) );
+}
+
+
+rsmdTEST(edrTruncatedFrame)
+{
+    testing::TemporaryDirectory directory {};
+    const auto filename = writeEnergies( directory );
+    const auto truncated = directory / "truncated.edr";
+
+    const auto size = testing::fileSize( filename );
+    const auto headerSize = size - nFrames * frameSize;
+    EdrReader reader {};
+
+    // cut at a frame boundary: the remaining frames are read
+    testing::truncateCopy( filename, truncated, headerSize + 4 * frameSize );
+    reader.read( truncated, {"Potential"} );
+    rsmdCHECK( reader.getNFrames() == 4 );
+    rsmdCHECK_CLOSE( reader.getTimes().back(), 3.0, 1e-12 );
+
+    // cut within the last frame / within the header: error instead of garbage values
+    testing::truncateCopy( filename, truncated, size - 2 );
+    rsmdCHECK_THROWS( reader.read( truncated, {"Potential"} ) );
+    testing::truncateCopy( filename, truncated, headerSize / 2 );
+    rsmdCHECK_THROWS( reader.read( truncated, {"Potential"} ) );
+}
+
+
+rsmdTEST(edrUnsupportedVersion)
+{
+    testing::TemporaryDirectory directory {};
+    const auto filename = writeEnergies( directory );
+
+    // version 1 (second int of the header) has a different frame layout: error instead of misread values
+    std::fstream FILE( filename, std::ios::in | std::ios::out | std::ios::binary );
+    FILE.seekp( 4 );
+    const char version[4] = {0, 0, 0, 1};
+    FILE.write( version, 4 );
+    FILE.close();
+
+    EdrReader reader {};
+    rsmdCHECK_THROWS( reader.read( filename, {"Potential"} ) );
+}
@@ -0,0 +1,124 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "testing.hpp"
+#include "enhance/fenwickTree.hpp"
+
+#include <random>
+#include <cmath>
+
+
+rsmdTEST(fenwickPrefixAndUpdate)
+{
+    enhance::FenwickTree tree ( {1, 0, 2, 3, 0.5} );
+    rsmdCHECK( tree.size() == 5 );
+    rsmdCHECK_CLOSE( tree.prefix(0), 0.0, 1e-12 );
+    rsmdCHECK_CLOSE( tree.prefix(3), 3.0, 1e-12 );
+    rsmdCHECK_CLOSE( tree.total(), 6.5, 1e-12 );
+
+    tree.update( 3, 0 );
+    tree.update( 1, 4 );
+    rsmdCHECK_CLOSE( tree.prefix(4), 7.0, 1e-12 );
+    rsmdCHECK_CLOSE( tree.total(), 7.5, 1e-12 );
+    rsmdCHECK_CLOSE( tree.weight(1), 4.0, 1e-12 );
+}
+
+
+rsmdTEST(fenwickFindMatchesLinearSearch)
+{
+    std::mt19937_64 rng {42};
+    std::uniform_real_distribution<double> distribution (0, 1);
+    std::vector<double> weights (37);
+    for( auto& w: weights )     w = ( distribution(rng) < 0.3 ? 0 : distribution(rng) );
+    enhance::FenwickTree tree ( weights );
+
+    for( std::size_t n=0; n<1000; ++n )
+    {
+        const double value = distribution(rng) * tree.total();
+        std::size_t expected {0};
+        double sum {weights[0]};
+        while( sum <= value )   sum += weights[++expected];
+        rsmdCHECK( tree.find(value) == expected );
+    }
+}
+
+
+rsmdTEST(fenwickFindSkipsZeroWeights)
+{
+    enhance::FenwickTree tree ( {0, 0, 2, 0, 3, 0, 0} );
+    rsmdCHECK( tree.find(0) == 2 );
+    rsmdCHECK( tree.find(1.999) == 2 );
+    rsmdCHECK( tree.find(2) == 4 );
+}
+
+
+rsmdTEST(fenwickFindAfterRemovals)
+{
+    // removing weights 0 and 1 leaves a residue of ~3e-17 in a partial sum,
+    // a draw in the former range of weight 0 must not select it (e.g. in the kinetic Monte Carlo loop)
+    enhance::FenwickTree tree ( {0.1, 0.2, 0.1} );
+    tree.update( 0, 0 );
+    tree.update( 1, 0 );
+    rsmdCHECK( tree.find(0) == 2 );
+    rsmdCHECK( tree.find(1e-17) == 2 );
+    rsmdCHECK( tree.find(0.5 * tree.total()) == 2 );
+
+    // whatever is removed, draws over the whole range only select positive weights
+    std::mt19937_64 rng {42};
+    std::uniform_real_distribution<double> distribution (0, 1);
+    for( std::size_t n=0; n<100; ++n )
+    {
+        std::vector<double> weights (13);
+        for( auto& w: weights )     w = 0.1 * static_cast<int>( 1 + 10 * distribution(rng) );
+        tree.assign( weights );
+        for( std::size_t i=0; i<weights.size(); ++i )
+        {
+            if( distribution(rng) < 0.7 )   tree.update( i, 0 );
+        }
+        if( tree.total() == 0 )     continue;
+        for( std::size_t k=0; k<=100; ++k )
+        {
+            rsmdCHECK( tree.weight( tree.find(0.01 * k * tree.total()) ) > 0 );
+        }
+    }
+}
+
+
+rsmdTEST(fenwickFindAtUpperBound)
+{
+    // a value equal to (or by round-off above) the total maps to the last element with a positive weight
+    enhance::FenwickTree tree ( {0.1, 0.2, 0.7, 0, 0} );
+    const double total = tree.total();
+    rsmdCHECK( tree.find(total) == 2 );
+    rsmdCHECK( tree.find(std::nextafter(total, 2.0)) == 2 );
+    rsmdCHECK( tree.find(std::nextafter(total, 0.0)) == 2 );
+
+    tree.update( 2, 0 );
+    rsmdCHECK( tree.find(tree.total()) == 1 );
+}
+
+
+rsmdTEST(fenwickAllWeightsZero)
+{
+    // the total is exactly 0 once all weights are removed, despite round-off in the partial sums
+    enhance::FenwickTree tree ( {0.1, 0.2, 0.7} );
+    for( std::size_t i=0; i<tree.size(); ++i )  tree.update( i, 0 );
+    rsmdCHECK( tree.total() == 0 );
+    rsmdCHECK( tree.find(0) == 0 );
+
+    tree.assign( std::vector<double>(4, 0) );
+    rsmdCHECK( tree.total() == 0 );
+    rsmdCHECK( tree.find(0) == 0 );
+
+    enhance::FenwickTree empty {};
+    rsmdCHECK( empty.size() == 0 );
+    rsmdCHECK( empty.total() == 0 );
+}
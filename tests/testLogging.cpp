@@ -0,0 +1,89 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "testing.hpp"
+#include "enhance/logging.hpp"
+
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <streambuf>
+
+namespace
+{
+    //
+    // stream buffer that only counts the lines written to it (from any thread)
+    //
+    class LineCounter : public std::streambuf
+    {
+      private:
+        std::mutex  mutex {};
+        std::size_t lines {0};
+
+      protected:
+        int_type overflow(int_type c) override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if( c == '\n' )     ++ lines;
+            return c;
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            lines += std::count( s, s + n, '\n' );
+            return n;
+        }
+
+      public:
+        std::size_t count()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return lines;
+        }
+    };
+}
+
+
+rsmdTEST(loggingStopAsyncWhileLogging)
+{
+    // messages submitted while the writer thread is stopped are neither lost nor stuck
+    constexpr std::size_t nThreads {4};
+    constexpr std::size_t nMessages {2000};
+
+    LineCounter counter {};
+    auto* previous = std::cout.rdbuf( &counter );
+    for( std::size_t repetition=0; repetition<20; ++repetition )
+    {
+        const auto before = counter.count();
+        enhance::Logger logger {};
+        logger.startAsync( 64 );
+
+        std::vector<std::thread> threads {};
+        for( std::size_t t=0; t<nThreads; ++t )
+        {
+            threads.emplace_back( [&logger](){
+                for( std::size_t i=0; i<nMessages; ++i )
+                {
+                    enhance::Logger::formatter() << "message " << i << '\n';
+                    logger.submit( enhance::LOGLEVEL::LOG );
+                }
+            });
+        }
+        std::this_thread::sleep_for( std::chrono::microseconds(100 * repetition) );
+        logger.stopAsync();
+        for( auto& thread: threads )    thread.join();
+        logger.flush();
+
+        rsmdCHECK( counter.count() - before == nThreads * nMessages );
+    }
+    std::cout.rdbuf( previous );
+}
@@ -0,0 +1,43 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "testing.hpp"
+
+#include <algorithm>
+
+//
+// run all registered tests (or only those given by name on the command line)
+//
+int main(int argc, char* argv[])
+{
+    const std::vector<std::string> selection ( argv + 1, argv + argc );
+
+    std::size_t nRun {0};
+    for( const auto& test: testing::tests() )
+    {
+        if( ! selection.empty() && std::find(selection.begin(), selection.end(), test.name) == selection.end() )    continue;
+
+        const auto before = testing::failures();
+        try
+        {
+            test.function();
+        }
+        catch( const std::exception& e )
+        {
+            testing::fail( __FILE__, __LINE__, test.name + " threw: " + e.what() );
+        }
+        std::cout << ( testing::failures() == before ? "[  OK  ] " : "[FAILED] " ) << test.name << '\n';
+        ++ nRun;
+    }
+
+    std::cout << nRun << " tests, " << testing::failures() << " failed checks\n";
+    return ( testing::failures() == 0 && nRun > 0 ) ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "testing.hpp"
+#include "reaction/rateTable.hpp"
+
+
+rsmdTEST(rateConstant)
+{
+    const RateTable single ( {{0.3, 2.5}} );
+    rsmdCHECK( ! single.distanceDependent() );
+    rsmdCHECK_CLOSE( single(0), 2.5, 1e-6 );
+    rsmdCHECK_CLOSE( single(0.3), 2.5, 1e-6 );
+    rsmdCHECK_CLOSE( single(10), 2.5, 1e-6 );
+
+    // all entries at the same distance: the last one is used
+    const RateTable duplicate ( {{0.3, 1}, {0.3, 4}} );
+    rsmdCHECK( ! duplicate.distanceDependent() );
+    rsmdCHECK_CLOSE( duplicate(0.3), 4.0, 1e-6 );
+}
+
+
+rsmdTEST(rateInterpolation)
+{
+    const RateTable table ( {{0.2, 0}, {0.25, 10}, {0.6, 0}} );
+    rsmdCHECK( table.distanceDependent() );
+    rsmdCHECK_CLOSE( table.getFirst(), 0.2, 1e-6 );
+    rsmdCHECK_CLOSE( table(0.225), 5.0, 1e-3 );
+    rsmdCHECK_CLOSE( table(0.25), 10.0, 1e-3 );
+    rsmdCHECK_CLOSE( table(0.425), 5.0, 1e-3 );
+    rsmdCHECK_CLOSE( table(0.59), 10.0 / 35, 1e-3 );
+}
+
+
+rsmdTEST(rateGridEnds)
+{
+    // at and beyond the ends of the table the first / last rate is used
+    const RateTable table ( {{0.3, 1}, {0.5, 3}} );
+    rsmdCHECK_CLOSE( table(0.3), 1.0, 1e-5 );
+    rsmdCHECK_CLOSE( table(0.5), 3.0, 1e-5 );
+    rsmdCHECK_CLOSE( table(0.5 - 1e-7), 3.0, 1e-5 );
+    rsmdCHECK_CLOSE( table(0.3 + 1e-7), 1.0, 1e-5 );
+    rsmdCHECK_CLOSE( table(0), 1.0, 1e-6 );
+    rsmdCHECK_CLOSE( table(-1), 1.0, 1e-6 );
+    rsmdCHECK_CLOSE( table(0.5001), 3.0, 1e-6 );
+    rsmdCHECK_CLOSE( table(1e6), 3.0, 1e-6 );
+    rsmdCHECK_CLOSE( table(0.3f + table.getSpacing() * (table.size() - 1)), 3.0, 1e-5 );
+}
+
+
+rsmdTEST(rateStep)
+{
+    // duplicate distances: a step, the last entry is used from there on
+    const RateTable table ( {{0.1, 1}, {0.2, 1}, {0.2, 5}, {0.3, 5}} );
+    rsmdCHECK_CLOSE( table(0.15), 1.0, 1e-5 );
+    rsmdCHECK_CLOSE( table(0.25), 5.0, 1e-5 );
+    rsmdCHECK_CLOSE( table(0.3), 5.0, 1e-5 );
+}
+
+
+rsmdTEST(rateGridSize)
+{
+    // the smallest step is resolved by several grid points, up to an upper bound of grid points
+    const RateTable coarse ( {{0, 0}, {0.1, 1}, {0.2, 0}} );
+    rsmdCHECK( coarse.size() == 17 );
+    rsmdCHECK_CLOSE( coarse.getSpacing(), 0.2 / 16, 1e-6 );
+
+    const RateTable fine ( {{0, 0}, {1e-6, 1}, {1, 0}} );
+    rsmdCHECK( fine.size() == 4096 );
+    rsmdCHECK_CLOSE( fine(1), 0.0, 1e-6 );
+    rsmdCHECK_CLOSE( fine(0.5), 0.5, 1e-3 );
+}
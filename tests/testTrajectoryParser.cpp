@@ -0,0 +1,186 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "testing.hpp"
+#include "parser/trajectoryParserGMX.hpp"
+#include "engine/engineMock.hpp"
+
+#include <random>
+
+//
+// fixtures: a small .gro file moved by the mock md engine (which also writes the .trr file of the run)
+// and .trr/.xtc files with known frames
+// (the mock engine writes no .xtc files, so small systems are written here, which .xtc stores uncompressed)
+//
+
+namespace
+{
+    TrajectoryFrame makeFrame(std::int64_t step, std::size_t nAtoms, bool velocities)
+    {
+        TrajectoryFrame frame {};
+        frame.step = step;
+        frame.time = 0.5 * step;
+        frame.box = {3, 0, 0, 0, 4, 0, 0, 0, 5};
+        for( std::size_t i=0; i<3*nAtoms; ++i )
+        {
+            frame.x.push_back( 0.01f * step + 0.1f * i );
+            if( velocities )    frame.v.push_back( -0.2f * i );
+        }
+        return frame;
+    }
+
+    void writeXTC(const std::string& filename, const std::vector<TrajectoryFrame>& frames)
+    {
+        XdrWriter file {};
+        for( const auto& frame: frames )
+        {
+            const int nAtoms = static_cast<int>(frame.x.size() / 3);
+            file.writeInt( 1995 );
+            file.writeInt( nAtoms );
+            file.writeInt( static_cast<int>(frame.step) );
+            file.writeFloat( static_cast<float>(frame.time) );
+            for( const auto& b: frame.box )     file.writeFloat( static_cast<float>(b) );
+            file.writeInt( nAtoms );
+            for( const auto& x: frame.x )       file.writeFloat( x );
+        }
+        file.save( filename );
+    }
+}
+
+
+rsmdTEST(trrWrittenByMockEngine)
+{
+    testing::TemporaryDirectory directory {};
+    const auto input = directory / "in.gro";
+    const auto output = directory / "out.gro";
+    const auto trajectory = directory / "traj.trr";
+    std::ofstream( input ) << "mock system\n"
+                           << "    2\n"
+                           << "    1SOL     OW    1   1.000   1.000   1.000  0.1000  0.2000  0.3000\n"
+                           << "    1SOL    HW1    2   1.100   1.000   1.000 -0.1000 -0.2000 -0.3000\n"
+                           << "   2.00000   2.00000   2.00000\n";
+
+    std::mt19937_64 rng {42};
+    rsmdCHECK( EngineMock::writeCoordinates( input, output, 0.01, rng, trajectory ) == 2 );
+
+    TrajectoryFrame frame {};
+    rsmdCHECK( TrajectoryParserGMX::readLastTRRFrame( trajectory, frame ) );
+    rsmdCHECK( frame.x.size() == 6 && frame.v.size() == 6 );
+    rsmdCHECK_CLOSE( frame.box[0], 2.0, 1e-6 );
+    rsmdCHECK_CLOSE( frame.box[8], 2.0, 1e-6 );
+    rsmdCHECK_CLOSE( frame.x[3], 1.1, 0.011 );
+    rsmdCHECK_CLOSE( frame.v[5], -0.3, 1e-6 );
+}
+
+
+rsmdTEST(trrLastFrame)
+{
+    testing::TemporaryDirectory directory {};
+    const auto filename = directory / "traj.trr";
+    TrajectoryParserGMX::writeTRR( filename, {makeFrame(10, 4, true), makeFrame(20, 4, false)} );
+
+    TrajectoryFrame frame {};
+    rsmdCHECK( TrajectoryParserGMX::readLastTRRFrame( filename, frame ) );
+    rsmdCHECK( frame.step == 20 );
+    rsmdCHECK_CLOSE( frame.time, 10.0, 1e-6 );
+    rsmdCHECK_CLOSE( frame.box[4], 4.0, 1e-6 );
+    rsmdCHECK( frame.x.size() == 12 );
+    rsmdCHECK_CLOSE( frame.x[11], 0.2 + 1.1, 1e-5 );
+    rsmdCHECK( frame.v.empty() );
+
+    rsmdCHECK( ! TrajectoryParserGMX::readLastTRRFrame( directory / "missing.trr", frame ) );
+}
+
+
+rsmdTEST(trrTruncatedFrame)
+{
+    testing::TemporaryDirectory directory {};
+    const auto filename = directory / "traj.trr";
+    const auto truncated = directory / "truncated.trr";
+    TrajectoryParserGMX::writeTRR( filename, {makeFrame(10, 4, true), makeFrame(20, 4, true)} );
+    const auto frameSize = testing::fileSize( filename ) / 2;
+
+    // cut within the coordinates / within the header of the last frame: the frame before is read
+    for( const auto size: {2 * frameSize - 10, frameSize + 40, frameSize + 2} )
+    {
+        testing::truncateCopy( filename, truncated, size );
+        TrajectoryFrame frame {};
+        rsmdCHECK( TrajectoryParserGMX::readLastTRRFrame( truncated, frame ) );
+        rsmdCHECK( frame.step == 10 );
+        rsmdCHECK( frame.v.size() == 12 );
+        rsmdCHECK_CLOSE( frame.v[11], -2.2, 1e-5 );
+    }
+
+    // no complete frame at all
+    testing::truncateCopy( filename, truncated, frameSize - 1 );
+    TrajectoryFrame frame {};
+    rsmdCHECK( ! TrajectoryParserGMX::readLastTRRFrame( truncated, frame ) );
+    testing::truncateCopy( filename, truncated, 0 );
+    rsmdCHECK( ! TrajectoryParserGMX::readLastTRRFrame( truncated, frame ) );
+}
+
+
+rsmdTEST(xtcAllFrames)
+{
+    testing::TemporaryDirectory directory {};
+    const auto filename = directory / "traj.xtc";
+    writeXTC( filename, {makeFrame(0, 5, false), makeFrame(10, 5, false), makeFrame(20, 5, false)} );
+
+    const auto frames = TrajectoryParserGMX::readXTC( filename );
+    rsmdCHECK( frames.size() == 3 );
+    rsmdCHECK( frames.back().step == 20 );
+    rsmdCHECK_CLOSE( frames.back().time, 10.0, 1e-6 );
+    rsmdCHECK_CLOSE( frames.back().box[8], 5.0, 1e-6 );
+    rsmdCHECK( frames.back().x.size() == 15 );
+    rsmdCHECK_CLOSE( frames.back().x[14], 0.2 + 1.4, 1e-5 );
+}
+
+
+rsmdTEST(xtcTruncatedFrame)
+{
+    testing::TemporaryDirectory directory {};
+    const auto filename = directory / "traj.xtc";
+    const auto truncated = directory / "truncated.xtc";
+    writeXTC( filename, {makeFrame(0, 5, false), makeFrame(10, 5, false), makeFrame(20, 5, false)} );
+    const auto frameSize = testing::fileSize( filename ) / 3;
+
+    // cut at a frame boundary: the remaining frames are read
+    testing::truncateCopy( filename, truncated, 2 * frameSize );
+    const auto frames = TrajectoryParserGMX::readXTC( truncated );
+    rsmdCHECK( frames.size() == 2 );
+    rsmdCHECK( ! frames.empty() && frames.back().step == 10 );
+
+    // cut within the coordinates / within the header of a frame: error instead of garbage coordinates
+    for( const auto size: {3 * frameSize - 4, 2 * frameSize + 10, std::size_t{2}} )
+    {
+        testing::truncateCopy( filename, truncated, size );
+        rsmdCHECK_THROWS( TrajectoryParserGMX::readXTC( truncated ) );
+    }
+}
+
+
+rsmdTEST(xtcSubset)
+{
+    testing::TemporaryDirectory directory {};
+    const auto input = directory / "traj.xtc";
+    const auto output = directory / "subset.trr";
+    writeXTC( input, {makeFrame(0, 5, false), makeFrame(10, 5, false)} );
+
+    TrajectoryParserGMX::writeSubset( input, output, {4, 1} );
+    TrajectoryFrame frame {};
+    rsmdCHECK( TrajectoryParserGMX::readLastTRRFrame( output, frame ) );
+    rsmdCHECK( frame.step == 10 );
+    rsmdCHECK( frame.x.size() == 6 );
+    rsmdCHECK_CLOSE( frame.x[0], 0.1 + 1.2, 1e-5 );
+    rsmdCHECK_CLOSE( frame.x[5], 0.1 + 0.5, 1e-5 );
+
+    rsmdCHECK_THROWS( TrajectoryParserGMX::writeSubset( input, output, {5} ) );
+}
@@ -0,0 +1,104 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#include "testing.hpp"
+#include "parser/xvgReader.hpp"
+#include "parser/edrReader.hpp"
+#include "engine/engineMock.hpp"
+
+#include <random>
+#include <numeric>
+
+//
+// fixtures: .xvg files converted from .edr files of the mock md engine (11 frames at t = 0 ... 10 ps),
+// the averages are compared to those of the .edr values
+//
+
+namespace
+{
+    const std::vector<std::string> terms {"Potential", "Coul-SR:xxx-rest"};
+
+    std::string writeXvg(const testing::TemporaryDirectory& directory, EdrReader& reader)
+    {
+        std::mt19937_64 rng {42};
+        const auto edr = directory / "ener.edr";
+        const auto xvg = directory / "ener.xvg";
+        EngineMock::writeEnergies( edr, 100, 5, rng );
+        EngineMock::writeXvg( edr, xvg, terms );
+        reader.read( edr, terms );
+        return xvg;
+    }
+
+    double average(const std::vector<double>& values, std::size_t nLast)
+    {
+        return std::accumulate( values.end() - nLast, values.end(), 0.0 ) / nLast;
+    }
+}
+
+
+rsmdTEST(xvgLastFrame)
+{
+    testing::TemporaryDirectory directory {};
+    EdrReader edr {};
+    const auto filename = writeXvg( directory, edr );
+
+    XvgReader reader {};
+    const auto values = reader.read( filename, {"Coul-SR:xxx-rest"}, 0 );
+    rsmdCHECK( values.size() == 1 );
+    rsmdCHECK( reader.getNFrames() == 1 );
+    rsmdCHECK_CLOSE( reader.getLastTime(), 10.0, 1e-9 );
+    rsmdCHECK_CLOSE( values[0], edr.getValues(1).back(), 1e-3 );
+}
+
+
+rsmdTEST(xvgWindowedAverage)
+{
+    testing::TemporaryDirectory directory {};
+    EdrReader edr {};
+    const auto filename = writeXvg( directory, edr );
+
+    // t >= 7 ps: the last 4 frames
+    XvgReader reader {};
+    const auto values = reader.read( filename, {"Coul-SR:xxx-rest", "Potential"}, 3 );
+    rsmdCHECK( reader.getNFrames() == 4 );
+    rsmdCHECK_CLOSE( values[0], average(edr.getValues(1), 4), 1e-3 );
+    rsmdCHECK_CLOSE( values[1], average(edr.getValues(0), 4), 1e-3 );
+}
+
+
+rsmdTEST(xvgWindowLongerThanTrajectory)
+{
+    testing::TemporaryDirectory directory {};
+    EdrReader edr {};
+    const auto filename = writeXvg( directory, edr );
+
+    // all frames, the time of the first frame is not crossed
+    XvgReader reader {};
+    const auto values = reader.read( filename, {"Potential"}, 1000 );
+    rsmdCHECK( reader.getNFrames() == edr.getNFrames() );
+    rsmdCHECK_CLOSE( reader.getLastTime(), 10.0, 1e-9 );
+    rsmdCHECK_CLOSE( values[0], average(edr.getValues(0), edr.getNFrames()), 1e-3 );
+}
+
+
+rsmdTEST(xvgMissingDataOrLegend)
+{
+    testing::TemporaryDirectory directory {};
+    EdrReader edr {};
+    const auto filename = writeXvg( directory, edr );
+    XvgReader reader {};
+    rsmdCHECK_THROWS( reader.read( filename, {"LJ-SR:xxx-rest"}, 0 ) );
+
+    // header only, e.g. the md run crashed before writing the first frame
+    const auto empty = directory / "empty.xvg";
+    std::ofstream( empty ) << "# no frames\n@ s0 legend \"Potential\"\n";
+    rsmdCHECK_THROWS( reader.read( empty, {"Potential"}, 1000 ) );
+}
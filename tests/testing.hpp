@@ -0,0 +1,130 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <filesystem>
+#include <stdexcept>
+#include <cmath>
+#include <unistd.h>
+
+//
+// minimal unit test support for rsmd-tests:
+// - rsmdTEST(name) { ... } defines and registers a test
+// - rsmdCHECK / rsmdCHECK_CLOSE / rsmdCHECK_THROWS count failed checks,
+//   the test executable returns non-zero if any check failed
+//
+
+namespace testing
+{
+    struct Test
+    {
+        std::string name;
+        void (*function)();
+    };
+
+    inline std::vector<Test>& tests()
+    {
+        static std::vector<Test> registered {};
+        return registered;
+    }
+
+    inline std::size_t& failures()
+    {
+        static std::size_t nFailures {0};
+        return nFailures;
+    }
+
+    inline void fail(const char* file, int line, const std::string& message)
+    {
+        ++ failures();
+        std::cerr << "  " << file << ":" << line << ": check failed: " << message << '\n';
+    }
+
+    struct Registration
+    {
+        Registration(const char* name, void (*function)()) { tests().push_back( {name, function} ); }
+    };
+
+
+    //
+    // temporary directory for the fixtures of a test, removed again at the end of the test
+    //
+    class TemporaryDirectory
+    {
+      private:
+        std::filesystem::path path {};
+
+      public:
+        TemporaryDirectory()
+            : path( std::filesystem::temp_directory_path() / ("rsmd-tests-" + std::to_string(::getpid())) )
+        {
+            std::filesystem::remove_all( path );
+            std::filesystem::create_directories( path );
+        }
+
+        ~TemporaryDirectory()
+        {
+            std::error_code error {};
+            std::filesystem::remove_all( path, error );
+        }
+
+        TemporaryDirectory(const TemporaryDirectory&) = delete;
+        TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+        inline std::string operator/(const std::string& filename) const { return (path / filename).string(); }
+    };
+
+
+    //
+    // copy the first nBytes of a file, e.g. to mimic a file that is still being written
+    //
+    inline void truncateCopy(const std::string& input, const std::string& output, std::size_t nBytes)
+    {
+        std::ifstream IN( input, std::ios::binary );
+        if( ! IN )  throw std::runtime_error("could not open file '" + input + "'");
+        std::vector<char> content( (std::istreambuf_iterator<char>(IN)), std::istreambuf_iterator<char>() );
+        if( nBytes > content.size() )   throw std::runtime_error("file '" + input + "' is too short to be truncated");
+
+        std::ofstream OUT( output, std::ios::binary );
+        OUT.write( content.data(), static_cast<std::streamsize>(nBytes) );
+    }
+
+    inline std::size_t fileSize(const std::string& filename) { return std::filesystem::file_size( filename ); }
+}
+
+
+#define rsmdTEST(name) \
+    static void name(); \
+    static const testing::Registration name##Registration ( #name, name ); \
+    static void name()
+
+#define rsmdCHECK(condition) \
+    if( ! (condition) ) { testing::fail( __FILE__, __LINE__, #condition ); }
+
+#define rsmdCHECK_CLOSE(value, expected, tolerance) \
+    if( ! (std::abs( (value) - (expected) ) <= (tolerance)) ) \
+    { \
+        testing::fail( __FILE__, __LINE__, #value " == " #expected " (" + std::to_string(value) + " vs. " + std::to_string(expected) + ")" ); \
+    }
+
+#define rsmdCHECK_THROWS(expression) \
+    { \
+        bool thrown {false}; \
+        try { expression; } \
+        catch( const std::exception& ) { thrown = true; } \
+        if( ! thrown ) { testing::fail( __FILE__, __LINE__, #expression " throws" ); } \
+    }
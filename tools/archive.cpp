@@ -0,0 +1,86 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+//
+// rsmd-archive: list / extract files of an archive of per-cycle files (simulation.archive)
+//
+// usage: rsmd-archive <archive> [list]
+//        rsmd-archive <archive> extract <name> [<name> ...]    (to the current directory)
+//        rsmd-archive <archive> cat <name>                     (to stdout)
+//        rsmd-archive <archive> extract-all [<directory>]
+//
+
+#include "control/archive.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+
+namespace
+{
+    void extractTo(ArchiveReader& reader, const std::string& name, const std::filesystem::path& directory)
+    {
+        const auto content = reader.extract( name );
+        std::ofstream FILE( directory / name, std::ios::binary | std::ios::trunc );
+        FILE.write( content.data(), content.size() );
+        if( ! FILE )    throw std::runtime_error("could not write file '" + (directory / name).string() + "'");
+    }
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if( argc < 2 )
+    {
+        std::cerr << "usage: " << argv[0] << " <archive> [list | extract <name>... | cat <name> | extract-all [<directory>]]\n";
+        return EXIT_FAILURE;
+    }
+    const std::string command = ( argc > 2 ? argv[2] : "list" );
+
+    try
+    {
+        ArchiveReader reader (argv[1]);
+
+        if( command == "list" )
+        {
+            for( const auto& name: reader.getNames() )  std::cout << name << '\n';
+        }
+        else if( command == "extract" )
+        {
+            for( int i=3; i<argc; ++i )     extractTo( reader, argv[i], std::filesystem::current_path() );
+        }
+        else if( command == "cat" && argc == 4 )
+        {
+            const auto content = reader.extract( argv[3] );
+            std::cout.write( content.data(), content.size() );
+        }
+        else if( command == "extract-all" )
+        {
+            const std::filesystem::path directory = ( argc > 3 ? argv[3] : "." );
+            std::filesystem::create_directories( directory );
+            for( const auto& name: reader.getNames() )  extractTo( reader, name, directory );
+        }
+        else
+        {
+            std::cerr << "rsmd-archive: unknown command '" << command << "'\n";
+            return EXIT_FAILURE;
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "rsmd-archive: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,296 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+//
+// rsmd-benchmark: end-to-end benchmark of the reactive step machinery of rs@md
+// (Metropolis MC acceptance) with the mock md engine on synthetic boxes
+//
+// usage: rsmd-benchmark [--atoms 1000,10000,100000] [--cycles 10] [--latency 0]
+//                       [--directory <dir>] [--seed 42] [--edr] [--keep] [--verbose]
+//
+// every system size is a complete rs@md run (Controller, simulation.engine = mock, simulation.timing = on),
+// the time spent per cycle is taken from the enhance::Timings phases in the (binary) statistics file
+// and reported as (the initial md sequence of cycle 0 is not included):
+//   parse    reading topologies, relaxed structures and energies (update, readRelaxed, energyParsing)
+//   search   searching for reaction candidates (search)
+//   react    performing the reaction (react)
+//   write    writing the new topology, .top, .gro, .ndx (write)
+//   engine   all calls to the (mock) md engine (md, relaxation, prescreening, energyComputation)
+//   cleanup  cleaning up after rejected reactive steps (cleanup)
+//
+
+#include "control/controller.hpp"
+#include "control/statistics.hpp"
+#include "engine/engineMock.hpp"
+#include "enhance/utility.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+
+
+namespace
+{
+    enum PHASE { PARSE, SEARCH, REACT, WRITE, ENGINE, CLEANUP, N_PHASES };
+    const std::array<std::string, N_PHASES> PHASE_NAMES {"parse", "search", "react", "write", "engine", "cleanup"};
+
+    // timed phases of rs@md (see SimulatorBase::timedPhases) -> reported phase
+    const std::map<std::string, PHASE> PHASE_OF_TIMING { {"update", PARSE}, {"readRelaxed", PARSE}, {"energyParsing", PARSE},
+                                                         {"search", SEARCH}, {"react", REACT}, {"write", WRITE},
+                                                         {"md", ENGINE}, {"relaxation", ENGINE}, {"prescreening", ENGINE}, {"energyComputation", ENGINE},
+                                                         {"cleanup", CLEANUP} };
+
+    struct Settings
+    {
+        std::vector<std::size_t> atoms {1000, 10000, 100000};
+        std::size_t cycles {10};
+        double      latency {0};
+        std::size_t seed {42};
+        std::filesystem::path directory { std::filesystem::temp_directory_path()/"rsmd-benchmark" };
+        bool edr {false};
+        bool keep {false};
+        bool verbose {false};
+    };
+
+    struct Result
+    {
+        std::size_t nAtoms {0};
+        std::size_t nCycles {0};
+        std::size_t nCandidates {0};
+        std::size_t nAccepted {0};
+        std::array<double, N_PHASES> time {};     // seconds
+    };
+
+
+    //
+    // synthetic system: 4-atom molecules (MOL) on a jittered cubic lattice at a
+    // density of ~100 atoms/nm^3 that react pairwise to NEW if their central atoms are close
+    //
+    void writeSystem(std::size_t nAtoms, std::size_t seed)
+    {
+        constexpr std::size_t atomsPerMolecule = 4;
+        constexpr double      density = 100;
+        constexpr double      bond = 0.1;
+        constexpr double      jitter = 0.08;
+
+        const std::size_t nMolecules = std::max<std::size_t>( nAtoms / atomsPerMolecule, 2 );
+        const std::size_t nSites = static_cast<std::size_t>( std::ceil(std::cbrt(static_cast<double>(nMolecules))) );
+        const double spacing = std::cbrt( atomsPerMolecule / density );
+        const double box = nSites * spacing;
+
+        std::mt19937_64 engine {seed};
+        std::uniform_real_distribution<double> distribution (-jitter, jitter);
+        auto wrap = [&](double x){ return x - std::floor(x / box) * box; };
+
+        std::ofstream GRO ("benchmark.gro");
+        GRO << "benchmark\n" << std::setw(6) << nMolecules * atomsPerMolecule << '\n';
+        const std::array<std::string, atomsPerMolecule> names {"CM", "HM", "HM", "HM"};
+        char buffer[64];
+        std::size_t atomID = 0;
+        for( std::size_t m=0; m<nMolecules; ++m )
+        {
+            std::array<double, 3> center { (m % nSites + 0.5) * spacing + distribution(engine),
+                                           ((m / nSites) % nSites + 0.5) * spacing + distribution(engine),
+                                           (m / (nSites*nSites) + 0.5) * spacing + distribution(engine) };
+            for( std::size_t a=0; a<atomsPerMolecule; ++a )
+            {
+                auto position = center;
+                if( a > 0 ) position[a-1] += bond;
+                ++ atomID;
+                std::snprintf( buffer, sizeof(buffer), "%5zu%-5s%5s%5zu%8.3f%8.3f%8.3f\n",
+                               (m+1) % 100000, "MOL", names[a].c_str(), atomID % 100000, wrap(position[0]), wrap(position[1]), wrap(position[2]) );
+                GRO << buffer;
+            }
+        }
+        GRO << std::fixed << std::setprecision(5) << std::setw(10) << box << std::setw(10) << box << std::setw(10) << box << '\n';
+
+        std::ofstream TOP ("benchmark.top");
+        TOP << "; synthetic benchmark system\n"
+            << "[ system ]\n"
+            << "benchmark\n"
+            << "\n"
+            << "[ molecules ]\n"
+            << "MOL  " << nMolecules << '\n';
+
+        std::ofstream REACTION ("benchmark.rsmd");
+        REACTION << "[name]\nbenchmark\n\n[reactants]\n";
+        for( std::size_t m=1; m<=2; ++m )
+            for( std::size_t a=0; a<atomsPerMolecule; ++a )
+                REACTION << m << " MOL " << names[a] << ' ' << a+1 << '\n';
+        REACTION << "\n[products]\n";
+        for( std::size_t m=1; m<=2; ++m )
+            for( std::size_t a=0; a<atomsPerMolecule; ++a )
+                REACTION << "1 NEW " << (a == 0 ? "CE" : "HE") << ' ' << (m-1)*atomsPerMolecule + a+1 << ' ' << m << ' ' << a+1 << '\n';
+        REACTION << "\n[criteria]\ndist 1 1 2 1 0.0 0.3\n"
+                 << "\n[energy]\n-5.0\n"
+                 << "\n[activation]\n10.0\n";
+    }
+
+
+    void writeConfig(const Settings& settings)
+    {
+        std::ofstream CONFIG ("benchmark.config");
+        CONFIG << "rseed = " << settings.seed << '\n'
+               << "output = RESTART\n"
+               << "statistics = statistics.data\n"
+               << "statisticsFormat = binary\n"
+               << "\n[simulation]\n"
+               << "engine = mock\n"
+               << "cycles = " << settings.cycles << '\n'
+               << "timing = on\n"
+               << "\n[reaction]\n"
+               << "file = benchmark.rsmd\n"
+               << "mc = on\n"
+               << "temperature = 300\n"
+               << "\n[gromacs]\n"
+               << "topology = benchmark.top\n"
+               << "coordinates = benchmark.gro\n"
+               << "edr = " << (settings.edr ? "on" : "off") << '\n'
+               << "\n[mock]\n"
+               << "latency = " << settings.latency << '\n';
+    }
+
+
+    //
+    // run the benchmark for one system size in the current working directory
+    //
+    Result run(std::size_t nAtoms, const Settings& settings)
+    {
+        writeSystem(nAtoms, settings.seed);
+        writeConfig(settings);
+
+        std::vector<std::string> arguments {"rsmd-benchmark", "-i", "benchmark.config"};
+        std::vector<char*> argv {};
+        for( auto& argument: arguments )    argv.push_back( argument.data() );
+
+        Controller controller {};
+        controller.setup( static_cast<int>(argv.size()), argv.data() );
+        controller.start();
+        controller.stop();
+
+        // evaluate the statistics file of the run
+        Result result {};
+        result.nAtoms = EngineMock::countAtoms("benchmark.gro");
+        StatisticsReader statistics ("statistics.data");
+        std::vector<PHASE> phases {};
+        for( const auto& name: statistics.getPhases() )
+        {
+            const auto it = PHASE_OF_TIMING.find(name);
+            if( it == PHASE_OF_TIMING.end() )   rsmdEXIT( "timed phase '" << name << "' is not assigned to any reported phase" );
+            phases.push_back( it->second );
+        }
+        StatisticsRecord record {};
+        while( statistics.next(record) )
+        {
+            ++ result.nCycles;
+            result.nCandidates += record.nCandidates;
+            if( record.outcome == STATISTICS_OUTCOME::ACCEPTED )    ++ result.nAccepted;
+            for( std::size_t i=0; i<phases.size() && i<record.timings.size(); ++i )     result.time[phases[i]] += record.timings[i] / 1000;
+        }
+        return result;
+    }
+
+
+    void report(const Result& result)
+    {
+        double total = 0;
+        for( auto t: result.time )  total += t;
+
+        std::cout << std::setw(10) << result.nAtoms
+                  << std::setw(8) << result.nCycles
+                  << std::setw(12) << std::fixed << std::setprecision(1) << static_cast<double>(result.nCandidates) / std::max<std::size_t>(result.nCycles, 1)
+                  << std::setw(10) << result.nAccepted;
+        for( auto t: result.time )
+        {
+            std::cout << std::setw(10) << std::setprecision(2) << 1000 * t / std::max<std::size_t>(result.nCycles, 1)
+                      << std::setw(5) << std::setprecision(0) << (total > 0 ? 100 * t / total : 0) << '%';
+        }
+        std::cout << std::setw(12) << std::setprecision(2) << 1000 * total / std::max<std::size_t>(result.nCycles, 1) << '\n' << std::flush;
+    }
+
+
+    Settings parseArguments(int argc, char* argv[])
+    {
+        Settings settings {};
+        for( int i=1; i<argc; ++i )
+        {
+            const std::string argument = argv[i];
+            auto value = [&]() -> std::string {
+                if( i+1 >= argc )   rsmdEXIT( "missing value for " << argument );
+                return argv[++i];
+            };
+            if( argument == "--atoms" )
+            {
+                settings.atoms.clear();
+                for( const auto& n: enhance::splitString(value(), ',') )  settings.atoms.push_back( static_cast<std::size_t>(std::stod(n)) );
+            }
+            else if( argument == "--cycles" )       settings.cycles = std::stoul( value() );
+            else if( argument == "--latency" )      settings.latency = std::stod( value() );
+            else if( argument == "--seed" )         settings.seed = std::stoul( value() );
+            else if( argument == "--directory" )    settings.directory = value();
+            else if( argument == "--edr" )          settings.edr = true;
+            else if( argument == "--keep" )         settings.keep = true;
+            else if( argument == "--verbose" )      settings.verbose = true;
+            else
+            {
+                rsmdEXIT( "usage: " << argv[0] << " [--atoms 1000,10000,100000] [--cycles 10] [--latency 0] [--directory <dir>] [--seed 42] [--edr] [--keep] [--verbose]" );
+            }
+        }
+        return settings;
+    }
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    const auto settings = parseArguments(argc, argv);
+    const auto startDirectory = std::filesystem::current_path();
+
+    std::cout << "# rs@md benchmark with mock md engine: " << settings.cycles << " cycles, latency " << settings.latency << " ms per engine call\n"
+              << "# times in ms per cycle (share of total)\n"
+              << '#' << std::setw(9) << "atoms" << std::setw(8) << "cycles" << std::setw(12) << "candidates" << std::setw(10) << "accepted";
+    for( const auto& name: PHASE_NAMES )    std::cout << std::setw(16) << name;
+    std::cout << std::setw(12) << "total" << '\n' << std::flush;
+
+    for( auto nAtoms: settings.atoms )
+    {
+        const auto directory = settings.directory / std::to_string(nAtoms);
+        std::filesystem::remove_all( directory );
+        std::filesystem::create_directories( directory );
+        std::filesystem::current_path( directory );
+
+        // silence the simulation output
+        auto* out = std::cout.rdbuf();
+        auto* log = std::clog.rdbuf();
+        if( ! settings.verbose )
+        {
+            std::cout.rdbuf( nullptr );
+            std::clog.rdbuf( nullptr );
+        }
+        auto result = run(nAtoms, settings);
+        std::cout.rdbuf( out );
+        std::clog.rdbuf( log );
+        std::cout << std::setfill(' ');     // (left at '0' by Controller::stop)
+
+        report(result);
+
+        std::filesystem::current_path( startDirectory );
+        if( ! settings.keep )   std::filesystem::remove_all( directory );
+    }
+    return EXIT_SUCCESS;
+}
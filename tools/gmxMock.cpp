@@ -0,0 +1,177 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+//
+// gmx-mock: a fake gmx executable that can be used as simulation.engine
+// in order to run rs@md (incl. EngineGMX) without gromacs
+//
+// supports the subcommands used by EngineGMX and produces plausible output files:
+//   grompp        -c gro -o tpr -po mdp      (the .tpr file is a copy of the .gro file)
+//   convert-tpr   -s tpr -o tpr
+//   trjconv       -f trj -o trj              (copy)
+//   mdrun         -s tpr -deffnm fnm [-rerun trj] [-e edr] [-g log] [-cpi cpt]
+//                 writes fnm.gro (randomly displaced coordinates), fnm.trr (last frame), fnm.edr, fnm.log, fnm.cpt
+//   energy        -f edr -o xvg              (energy terms are read from stdin)
+//
+// the environment variable GMX_MOCK_LATENCY sets the time (ms) every call takes
+//
+// note: no .xtc trajectories are written, i.e. averaging potential energies
+//       over trajectories (reaction.averagePotentialEnergy) is not supported
+//
+
+#include "engine/engineMock.hpp"
+#include "enhance/utility.hpp"
+
+#include <map>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstdlib>
+
+
+namespace
+{
+    using Options = std::map<std::string, std::string>;
+
+    //
+    // options (-name value) and flags (-name)
+    //
+    Options parseOptions(int argc, char* argv[])
+    {
+        Options options {};
+        for( int i=2; i<argc; ++i )
+        {
+            std::string name = argv[i];
+            if( name.empty() || name[0] != '-' )    continue;
+            if( i+1 < argc && argv[i+1][0] != '-' )
+            {
+                options[name] = argv[i+1];
+                ++i;
+            }
+            else
+            {
+                options[name] = "";
+            }
+        }
+        return options;
+    }
+
+    const std::string& require(const Options& options, const std::string& name)
+    {
+        auto it = options.find(name);
+        if( it == options.end() )   throw std::runtime_error("missing option " + name);
+        return it->second;
+    }
+
+    std::string optional(const Options& options, const std::string& name, const std::string& fallback)
+    {
+        auto it = options.find(name);
+        return ( it == options.end() ? fallback : it->second );
+    }
+
+    void copy(const std::string& from, const std::string& to)
+    {
+        if( std::filesystem::exists(to) && std::filesystem::equivalent(from, to) ) return;
+        std::filesystem::copy_file( from, to, std::filesystem::copy_options::overwrite_existing );
+    }
+
+    void touch(const std::string& filename, const std::string& content)
+    {
+        std::ofstream FILE( filename );
+        FILE << content;
+    }
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if( argc < 2 )
+    {
+        std::cerr << "usage: " << argv[0] << " <subcommand> [options]\n";
+        return EXIT_FAILURE;
+    }
+
+    if( const char* latency = std::getenv("GMX_MOCK_LATENCY") )
+    {
+        std::this_thread::sleep_for( std::chrono::duration<double, std::milli>(std::atof(latency)) );
+    }
+
+    std::mt19937_64 engine { std::random_device{}() };
+    const std::string command = argv[1];
+    const auto options = parseOptions(argc, argv);
+
+    try
+    {
+        if( command == "-version" || command == "--version" )
+        {
+            std::cout << "mock gromacs (gmx-mock)\n";
+        }
+        else if( command == "grompp" )
+        {
+            const auto& tpr = require(options, "-o");
+            if( ! std::filesystem::exists(require(options, "-p")) ) throw std::runtime_error("missing topology file");
+            if( ! std::filesystem::exists(require(options, "-f")) ) throw std::runtime_error("missing mdp file");
+            copy( require(options, "-c"), tpr );
+            touch( optional(options, "-po", "mdout.mdp"), "; written by gmx-mock\n" );
+        }
+        else if( command == "convert-tpr" )
+        {
+            copy( require(options, "-s"), require(options, "-o") );
+        }
+        else if( command == "trjconv" )
+        {
+            copy( require(options, "-f"), require(options, "-o") );
+        }
+        else if( command == "mdrun" )
+        {
+            const auto& tpr = require(options, "-s");
+            const auto fnm = optional(options, "-deffnm", "topol");
+            std::size_t nAtoms {0};
+            if( options.count("-rerun") )
+            {
+                const auto& trajectory = require(options, "-rerun");
+                nAtoms = ( std::filesystem::path(trajectory).extension() == ".gro" ? EngineMock::countAtoms(trajectory) : EngineMock::countAtoms(tpr) );
+            }
+            else
+            {
+                nAtoms = EngineMock::writeCoordinates( tpr, optional(options, "-c", fnm + ".gro"), 0.01, engine, optional(options, "-o", fnm + ".trr") );
+                touch( optional(options, "-cpo", fnm + ".cpt"), "" );
+            }
+            EngineMock::writeEnergies( optional(options, "-e", fnm + ".edr"), nAtoms, 1, engine );
+            touch( optional(options, "-g", fnm + ".log"), "written by gmx-mock\n" );
+        }
+        else if( command == "energy" )
+        {
+            std::vector<std::string> terms {};
+            std::string line {};
+            while( std::getline(std::cin, line) )
+            {
+                line.erase( std::remove(line.begin(), line.end(), '\0'), line.end() );
+                line = enhance::trimString(line);
+                if( ! line.empty() )    terms.push_back(line);
+            }
+            EngineMock::writeXvg( require(options, "-f"), optional(options, "-o", "energy.xvg"), terms );
+        }
+        else
+        {
+            throw std::runtime_error("unsupported subcommand '" + command + "'");
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "gmx-mock " << command << ": " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
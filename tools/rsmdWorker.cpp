@@ -0,0 +1,291 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+//
+// rsmdWorker: a long-lived helper process that executes md engine commands
+// submitted by rs@md via a UNIX socket (see src/engine/engineWorker.hpp for the protocol)
+//
+// usage: rsmdWorker [--mock] <socket>
+//
+//   --mock   do not execute anything, instead pretend to be an md engine:
+//            create (empty) output files for all common output options
+//            (-o, -po, -e, -g, -c, -x, -cpo, -deffnm) and exit with status 0
+//
+
+#include "engine/engineWorker.hpp"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+
+namespace
+{
+    bool                    mock {false};
+    int                     listenFD {-1};
+    std::atomic<bool>       quit {false};
+    std::mutex              mutex {};
+    std::condition_variable condition {};
+    std::size_t             nActive {0};
+
+    struct Request
+    {
+        std::string              cwd {};
+        std::vector<std::string> arguments {};
+        std::string              input {};
+    };
+
+
+    //
+    // read an EXEC request (after the EXEC line)
+    //
+    bool readRequest(int fd, Request& request)
+    {
+        std::string line {};
+        while( worker::readLine(fd, line) )
+        {
+            if( line == "END" ) return ! request.arguments.empty();
+            else if( line.rfind("CWD ", 0) == 0 )   request.cwd = line.substr(4);
+            else if( line.rfind("ARG ", 0) == 0 )   request.arguments.push_back( line.substr(4) );
+            else if( line.rfind("IN ", 0) == 0 )
+            {
+                // (a malformed length is a malformed request, the handler thread must not throw)
+                std::size_t nBytes {0};
+                const char* last = line.data() + line.size();
+                const auto [ptr, error] = std::from_chars( line.data() + 3, last, nBytes );
+                if( error != std::errc() || ptr != last )   return false;
+                if( ! worker::readBytes(fd, nBytes, request.input) )    return false;
+            }
+            else return false;
+        }
+        return false;
+    }
+
+
+    //
+    // pretend to be an md engine
+    //
+    int runMock(const Request& request, std::string& output)
+    {
+        const std::vector<std::string> outputOptions {"-o", "-po", "-e", "-g", "-c", "-x", "-cpo"};
+        const std::filesystem::path cwd (request.cwd);
+
+        output = "mock:";
+        for( const auto& argument: request.arguments )  output += " " + argument;
+        output += '\n';
+
+        for( std::size_t i=1; i+1<request.arguments.size(); ++i )
+        {
+            const auto& option = request.arguments[i];
+            const auto& value = request.arguments[i+1];
+            if( std::find(outputOptions.begin(), outputOptions.end(), option) != outputOptions.end() )
+            {
+                std::ofstream( cwd / value, std::ios::app );
+            }
+            else if( option == "-deffnm" )
+            {
+                std::ofstream( cwd / (value + ".log"), std::ios::app );
+            }
+        }
+        return 0;
+    }
+
+
+    //
+    // execute the requested command in a child process
+    //
+    int runCommand(const Request& request, std::string& output)
+    {
+        // prepare everything before forking (only async-signal-safe calls in the child)
+        std::vector<char*> argv {};
+        for( const auto& argument: request.arguments )  argv.push_back( const_cast<char*>(argument.c_str()) );
+        argv.push_back( nullptr );
+
+        int childIn[2], childOut[2];
+        if( pipe2(childIn, O_CLOEXEC) < 0 ) return -1;
+        if( pipe2(childOut, O_CLOEXEC) < 0 )
+        {
+            close(childIn[0]); close(childIn[1]);
+            return -1;
+        }
+
+        pid_t pid = fork();
+        if( pid == 0 )
+        {
+            // child: restore default signal handling, redirect i/o and execute
+            signal( SIGINT, SIG_DFL );
+            signal( SIGHUP, SIG_DFL );
+            signal( SIGQUIT, SIG_DFL );
+            signal( SIGPIPE, SIG_DFL );
+            signal( SIGUSR1, SIG_DFL );
+            if( chdir(request.cwd.c_str()) < 0 )   _exit(EXIT_FAILURE);
+            dup2( childIn[0], STDIN_FILENO );
+            dup2( childOut[1], STDOUT_FILENO );
+            dup2( childOut[1], STDERR_FILENO );
+            execvp( argv[0], argv.data() );
+            _exit(EXIT_FAILURE);
+        }
+
+        close( childIn[0] );
+        close( childOut[1] );
+        if( pid < 0 )
+        {
+            close( childIn[1] );
+            close( childOut[0] );
+            return -1;
+        }
+
+        worker::writeAll( childIn[1], request.input );
+        close( childIn[1] );
+
+        char buffer[4096];
+        ssize_t n;
+        while( (n = read(childOut[0], buffer, sizeof(buffer))) != 0 )
+        {
+            if( n < 0 )
+            {
+                if( errno == EINTR )    continue;
+                break;
+            }
+            output.append( buffer, static_cast<std::size_t>(n) );
+        }
+        close( childOut[0] );
+
+        int status = 0;
+        while( waitpid(pid, &status, 0) < 0 && errno == EINTR ) {}
+        return status;
+    }
+
+
+    //
+    // handle one connection
+    //
+    void handle(int fd)
+    {
+        std::string line {};
+        if( worker::readLine(fd, line) )
+        {
+            if( line == "QUIT" )
+            {
+                quit.store(true);
+                shutdown( listenFD, SHUT_RDWR );
+            }
+            else if( line == "EXEC" )
+            {
+                Request request {};
+                std::string output {};
+                int status = -1;
+                bool valid {false};
+                try
+                {
+                    valid = readRequest(fd, request);
+                }
+                catch( const std::exception& )
+                {
+                    // e.g. no memory for the announced input
+                }
+                if( valid )
+                {
+                    status = mock ? runMock(request, output) : runCommand(request, output);
+                    if( status < 0 )    output = "rsmdWorker: could not execute " + request.arguments[0] + '\n';
+                }
+                else
+                {
+                    output = "rsmdWorker: malformed request\n";
+                }
+                // report failures to start a command as exit status 1
+                if( status < 0 )    status = (1 << 8);
+
+                std::stringstream response {};
+                response << "STATUS " << status << ' ' << output.size() << '\n' << output;
+                worker::writeAll( fd, response.str() );
+            }
+        }
+        close(fd);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        -- nActive;
+        condition.notify_all();
+    }
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    std::string socketPath {};
+    for( int i=1; i<argc; ++i )
+    {
+        if( std::strcmp(argv[i], "--mock") == 0 )   mock = true;
+        else socketPath = argv[i];
+    }
+    if( socketPath.empty() )
+    {
+        std::cerr << "usage: " << argv[0] << " [--mock] <socket>\n";
+        return EXIT_FAILURE;
+    }
+
+    // interrupts are handled by rs@md, which shuts down the worker itself
+    signal( SIGINT, SIG_IGN );
+    signal( SIGHUP, SIG_IGN );
+    signal( SIGQUIT, SIG_IGN );
+    signal( SIGPIPE, SIG_IGN );
+    signal( SIGUSR1, SIG_IGN );
+
+    listenFD = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    std::strncpy( address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1 );
+    unlink( socketPath.c_str() );
+    if( listenFD < 0
+     || bind(listenFD, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+     || listen(listenFD, 64) < 0 )
+    {
+        std::cerr << "rsmdWorker: could not listen on " << socketPath << ": " << std::strerror(errno) << '\n';
+        return EXIT_FAILURE;
+    }
+
+    while( ! quit.load() )
+    {
+        int fd = accept4( listenFD, nullptr, nullptr, SOCK_CLOEXEC );
+        if( fd < 0 )
+        {
+            if( errno == EINTR || errno == ECONNABORTED )   continue;
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++ nActive;
+        }
+        std::thread( handle, fd ).detach();
+    }
+
+    // wait for running commands to finish
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait( lock, [](){ return nActive == 0; } );
+    }
+    close( listenFD );
+    unlink( socketPath.c_str() );
+    return EXIT_SUCCESS;
+}
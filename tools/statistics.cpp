@@ -0,0 +1,170 @@
+/************************************************
+ *                                              *
+ *                rs@md                         *
+ *    (reactive steps @ molecular dynamics )    *
+ *                                              *
+ ************************************************/
+/*
+ Copyright 2020 Myra Biedermann
+ Licensed under the Apache License, Version 2.0
+*/
+
+//
+// rsmd-statistics: read a binary statistics file (statisticsFormat = binary)
+//
+// usage: rsmd-statistics <file> [--csv]
+//
+// prints a summary (# cycles, candidates / acceptance per reaction template, outcomes,
+// mean time per phase, distribution of adapted relaxation lengths), or with --csv one line per cycle and one column per quantity
+//
+
+#include "control/statistics.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+
+namespace
+{
+    void writeCsvHeader(const StatisticsReader& reader)
+    {
+        std::cout << "cycle,candidates";
+        for( const auto& reaction: reader.getReactions() )  std::cout << ",candidates:" << reaction << ",attempted:" << reaction << ",accepted:" << reaction;
+        std::cout << ",outcome,chosen,criterion,energyDifference";
+        for( const auto& phase: reader.getPhases() )    std::cout << ",t_" << phase << "/ms";
+        if( reader.getVersion() >= 2 )  std::cout << ",relaxation/ps";
+        std::cout << '\n';
+    }
+
+    void writeCsvLine(const StatisticsReader& reader, const StatisticsRecord& record)
+    {
+        static const char* outcomes[] {"none", "acc", "rej", "rej_relax", "rej_pre"};
+        std::cout << record.cycle << ',' << record.nCandidates;
+        for( std::size_t i=0; i<reader.getReactions().size(); ++i )
+        {
+            std::cout << ',' << record.candidates[i] << ',' << record.attempted[i] << ',' << record.accepted[i];
+        }
+        std::cout << ',' << outcomes[ static_cast<int>(record.outcome) ];
+        // chosen candidate (Metropolis), respectively the last accepted candidate (rate)
+        if( ! record.entries.empty() )
+        {
+            const auto& entry = record.entries.back();
+            std::cout << ',' << reader.getReactions()[entry.reaction] << ',' << entry.criterion << ',' << entry.energyDifference;
+        }
+        else
+        {
+            std::cout << ",,,";
+        }
+        for( const auto& timing: record.timings )   std::cout << ',' << timing;
+        if( reader.getVersion() >= 2 )
+        {
+            std::cout << ',';
+            if( ! std::isnan(record.relaxationLength) )     std::cout << record.relaxationLength;
+        }
+        std::cout << '\n';
+    }
+}
+
+
+
+int main(int argc, char* argv[])
+{
+    if( argc < 2 )
+    {
+        std::cerr << "usage: " << argv[0] << " <file> [--csv]\n";
+        return EXIT_FAILURE;
+    }
+    const bool csv = ( argc > 2 && std::string(argv[2]) == "--csv" );
+
+    try
+    {
+        StatisticsReader reader (argv[1]);
+        StatisticsRecord record {};
+        const auto nReactions = reader.getReactions().size();
+        const auto nPhases = reader.getPhases().size();
+
+        if( csv )
+        {
+            writeCsvHeader(reader);
+            while( reader.next(record) )    writeCsvLine(reader, record);
+            return EXIT_SUCCESS;
+        }
+
+        std::size_t nCycles {0};
+        std::int64_t firstCycle {0}, lastCycle {0};
+        std::vector<std::size_t> outcomes (5, 0);
+        std::vector<double> candidates (nReactions, 0), attempted (nReactions, 0), accepted (nReactions, 0);
+        std::vector<double> timings (nPhases, 0);
+        std::map<double, std::size_t> relaxationLengths {};
+        while( reader.next(record) )
+        {
+            if( nCycles == 0 )  firstCycle = record.cycle;
+            lastCycle = record.cycle;
+            ++ nCycles;
+            ++ outcomes[ static_cast<int>(record.outcome) ];
+            for( std::size_t i=0; i<nReactions; ++i )
+            {
+                candidates[i] += record.candidates[i];
+                attempted[i] += record.attempted[i];
+                accepted[i] += record.accepted[i];
+            }
+            for( std::size_t i=0; i<nPhases; ++i )  timings[i] += record.timings[i];
+            if( ! std::isnan(record.relaxationLength) )     ++ relaxationLengths[record.relaxationLength];
+        }
+
+        std::cout << nCycles << " cycles (" << firstCycle << " - " << lastCycle << ")\n";
+        std::cout << "   " << outcomes[static_cast<int>(STATISTICS_OUTCOME::ACCEPTED)] << " accepted, "
+                           << outcomes[static_cast<int>(STATISTICS_OUTCOME::REJECTED)] << " rejected, "
+                           << outcomes[static_cast<int>(STATISTICS_OUTCOME::REJECTED_RELAXATION)] << " rejected due to a failed relaxation, ";
+        if( outcomes[static_cast<int>(STATISTICS_OUTCOME::REJECTED_PRESCREENING)] > 0 )
+        {
+            std::cout << outcomes[static_cast<int>(STATISTICS_OUTCOME::REJECTED_PRESCREENING)] << " rejected in the pre-screening, ";
+        }
+        std::cout << outcomes[static_cast<int>(STATISTICS_OUTCOME::NONE)] << " without candidates\n\n";
+        if( nCycles == 0 )  return EXIT_SUCCESS;
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << std::setw(30) << std::left << "reaction" << std::right
+                  << std::setw(16) << "candidates/cyc"
+                  << std::setw(16) << "attempted"
+                  << std::setw(16) << "accepted"
+                  << std::setw(16) << "acc. ratio" << '\n';
+        for( std::size_t i=0; i<nReactions; ++i )
+        {
+            std::cout << std::setw(30) << std::left << reader.getReactions()[i] << std::right
+                      << std::setw(16) << candidates[i] / nCycles
+                      << std::setw(16) << static_cast<std::size_t>(attempted[i])
+                      << std::setw(16) << static_cast<std::size_t>(accepted[i])
+                      << std::setw(16) << ( attempted[i] > 0 ? accepted[i] / attempted[i] : NAN ) << '\n';
+        }
+
+        if( nPhases > 0 )
+        {
+            std::cout << '\n' << std::setw(30) << std::left << "phase" << std::right << std::setw(16) << "mean/ms" << std::setw(16) << "total/s" << '\n';
+            for( std::size_t i=0; i<nPhases; ++i )
+            {
+                std::cout << std::setw(30) << std::left << reader.getPhases()[i] << std::right
+                          << std::setw(16) << timings[i] / nCycles
+                          << std::setw(16) << timings[i] / 1000 << '\n';
+            }
+        }
+
+        if( ! relaxationLengths.empty() )
+        {
+            std::cout << '\n' << std::setw(30) << std::left << "relaxation length/ps" << std::right << std::setw(16) << "relaxations" << '\n';
+            for( const auto& [length, count]: relaxationLengths )
+            {
+                std::cout << std::setw(30) << std::left << length << std::right << std::setw(16) << count << '\n';
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "rsmd-statistics: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}